@@ -0,0 +1,237 @@
+#include "common.h"
+#include "registry.h"
+#include "parse_cache.h"
+#include "harness.h"
+#include "baseline.h"
+#include "thread_pool.h"
+
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <vector>
+
+using namespace aoc;
+
+static char const* const USAGE =
+	"usage: aoc_bench [options] INPUT_DIR\n"
+	"  Benchmarks parse, part 1 and part 2 of every day on INPUT_DIR/dayNN.txt\n"
+	"options:\n"
+	"  --warmup N     untimed runs before measuring (default 2)\n"
+	"  --reps N       timed runs per phase (default 10)\n"
+	"  --days LIST    only these days, e.g. 1,5,17\n"
+	"  --threads LIST run everything once per thread count, e.g. 1,2,4,8\n"
+	"                 (default: one run with $AOC_THREADS or every core)\n"
+	"  --counters     also count cycles, instructions, cache and branch misses of\n"
+	"                 the thread running each phase (Linux perf_event_open)\n"
+	"  --json FILE    also write the results as JSON to FILE\n"
+	"  --save-baseline FILE\n"
+	"                 write the timings to FILE, for --baseline\n"
+	"  --baseline FILE\n"
+	"                 compare with the timings in FILE, fails if any phase got slower\n"
+	"  --threshold PCT\n"
+	"                 slowdown (in percent) that counts as a regression (default 10)\n";
+
+struct Arguments {
+	bench::Options options;
+	std::set<int> days;
+	std::vector<size_t> threads;
+	std::string json_path;
+	std::string save_baseline_path;
+	std::string baseline_path;
+	double threshold = 0.1;
+	std::string input_dir;
+};
+
+// Comma separated thread counts, in the given order
+static std::vector<size_t> parse_thread_list(StringView list) {
+	std::vector<size_t> threads;
+	Scanner sc(list);
+	int n;
+	while (sc.next_int(n)) {
+		if (n <= 0) {
+			throw std::runtime_error("thread counts must be positive\n");
+		}
+		threads.push_back(size_t(n));
+	}
+	return threads;
+}
+
+static Arguments parse_arguments(int argc, char** argv) {
+	Arguments args;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (arg == "--warmup" && has_value) {
+			args.options.warmup = std::stoul(argv[++i]);
+		} else if (arg == "--reps" && has_value) {
+			args.options.repetitions = std::max(1ul, std::stoul(argv[++i]));
+		} else if (arg == "--days" && has_value) {
+			args.days = parse_day_list(argv[++i]);
+		} else if (arg == "--threads" && has_value) {
+			args.threads = parse_thread_list(argv[++i]);
+		} else if (arg == "--counters") {
+			args.options.counters = true;
+		} else if (arg == "--json" && has_value) {
+			args.json_path = argv[++i];
+		} else if (arg == "--save-baseline" && has_value) {
+			args.save_baseline_path = argv[++i];
+		} else if (arg == "--baseline" && has_value) {
+			args.baseline_path = argv[++i];
+		} else if (arg == "--threshold" && has_value) {
+			args.threshold = std::stod(argv[++i]) / 100;
+		} else if (arg[0] != '-' && args.input_dir.empty()) {
+			args.input_dir = arg;
+		} else {
+			throw std::runtime_error(std::string("bad argument \"") + arg + "\"\n" + USAGE);
+		}
+	}
+	if (args.input_dir.empty()) {
+		throw std::runtime_error(USAGE);
+	}
+	if (args.threads.empty()) {
+		args.threads.push_back(ThreadPool::default_thread_count());
+	}
+	return args;
+}
+
+// Benchmark every phase of a single day
+static void bench_solution(Solution const& solution, Input const& input,
+						   bench::Options const& options, std::vector<bench::Result>& results) {
+	auto make_result = [&](char const* phase, bench::Samples const& samples, std::string const& answer) {
+		return bench::Result {
+			solution.day, solution.name, phase, input.size(), bench::summarize(samples.ns), samples.allocations,
+			ThreadPool::global().size(), answer, samples.counters
+		};
+	};
+
+	Solution::parsed_t parsed;
+	auto samples = bench::sample(options, [&]() {
+		parsed = solution.parse(input.view());
+	});
+	results.push_back(make_result("parse", samples, ""));
+
+	// what a parse cache hit costs instead, without the disk
+	if (solution.cache_version != 0) {
+		BinaryWriter writer;
+		solution.save(parsed.get(), writer);
+		Solution::parsed_t loaded;
+		samples = bench::sample(options, [&]() {
+			BinaryReader reader(writer.bytes);
+			loaded = solution.load(reader);
+		});
+		results.push_back(make_result("load", samples, ""));
+	}
+
+	std::string answer;
+	samples = bench::sample(options, [&]() {
+		answer = solution.part1(parsed.get());
+	});
+	results.push_back(make_result("part1", samples, answer));
+
+	if (solution.part2) {
+		samples = bench::sample(options, [&]() {
+			answer = solution.part2(parsed.get());
+		});
+		results.push_back(make_result("part2", samples, answer));
+	}
+}
+
+// Every selected day on the current global pool
+static void bench_days(Arguments const& args, std::vector<bench::Result>& results) {
+	for (auto const& solution : solutions()) {
+		if (!args.days.empty() && args.days.count(solution.day) == 0) {
+			continue;
+		}
+
+		std::string path = input_path(args.input_dir, solution.day);
+		Input input;
+		try {
+			input = Input::from_file(path);
+		} catch (std::exception const& e) {
+			std::cerr << "skipping day " << solution.day << ": " << e.what() << '\n';
+			continue;
+		}
+
+		try {
+			bench_solution(solution, input, args.options, results);
+		} catch (std::exception const& e) {
+			std::cerr << "day " << solution.day << " failed: " << e.what() << '\n';
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	Arguments args;
+	try {
+		args = parse_arguments(argc, argv);
+	} catch (std::exception const& e) {
+		std::cerr << e.what();
+		return EXIT_FAILURE;
+	}
+
+	if (!bench::is_optimized_build()) {
+		std::cerr << "warning: aoc_bench is not built optimized and/or is sanitized, "
+			"configure with -DCMAKE_BUILD_TYPE=Release (or run `make bench`)\n";
+	}
+
+	if (args.options.counters) {
+		bench::Counters probe;
+		if (!probe.available()) {
+			std::cerr << "warning: no hardware counters, timing only (" << probe.error() << ")\n";
+			args.options.counters = false;
+		}
+	}
+
+	// read it first, a typo in the path shouldn't cost a whole run
+	std::vector<bench::Result> baseline;
+	if (!args.baseline_path.empty()) {
+		std::ifstream file(args.baseline_path);
+		try {
+			if (!file) {
+				throw std::runtime_error("can't open it");
+			}
+			baseline = bench::read_baseline(file);
+		} catch (std::exception const& e) {
+			std::cerr << "Bad baseline \"" << args.baseline_path << "\": " << e.what() << '\n';
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::vector<bench::Result> results;
+	for (size_t threads : args.threads) {
+		ThreadPool::set_global_threads(threads);
+		bench_days(args, results);
+	}
+
+	bench::print_table(std::cout, results);
+
+	if (!args.json_path.empty()) {
+		std::ofstream json(args.json_path);
+		if (!json) {
+			std::cerr << "Can't open \"" << args.json_path << "\"\n";
+			return EXIT_FAILURE;
+		}
+		bench::write_json(json, results, args.options);
+	}
+
+	if (!args.save_baseline_path.empty()) {
+		std::ofstream file(args.save_baseline_path);
+		if (!file) {
+			std::cerr << "Can't open \"" << args.save_baseline_path << "\"\n";
+			return EXIT_FAILURE;
+		}
+		bench::write_baseline(file, results);
+	}
+
+	if (!args.baseline_path.empty()) {
+		auto comparisons = bench::compare(baseline, results, args.threshold);
+		std::cout << "\ncompared with " << args.baseline_path << ":\n";
+		bench::print_comparison(std::cout, comparisons);
+		if (bench::has_regression(comparisons)) {
+			std::cerr << "regression: at least one phase is more than " << args.threshold * 100
+				<< "% slower than the baseline\n";
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
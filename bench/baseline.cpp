@@ -0,0 +1,143 @@
+#include "baseline.h"
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace aoc {
+namespace bench {
+
+static char const* const BASELINE_HEADER = "# aoc_bench baseline v1";
+
+void write_baseline(std::ostream& out, std::vector<Result> const& results) {
+	out << BASELINE_HEADER << '\n'
+		<< "# day name phase threads samples median_ns ci_low_ns ci_high_ns\n"
+		<< std::fixed << std::setprecision(1);
+	for (auto const& r : results) {
+		out << r.day << ' ' << r.name << ' ' << r.phase << ' ' << r.threads << ' '
+			<< r.stats.samples << ' ' << r.stats.median_ns << ' '
+			<< r.stats.ci_low_ns << ' ' << r.stats.ci_high_ns << '\n';
+	}
+}
+
+std::vector<Result> read_baseline(std::istream& in) {
+	std::string line;
+	if (!std::getline(in, line) || line != BASELINE_HEADER) {
+		throw std::runtime_error("not an aoc_bench baseline (v1)");
+	}
+
+	std::vector<Result> results;
+	size_t line_number = 1;
+	while (std::getline(in, line)) {
+		++line_number;
+		if (line.empty() || line[0] == '#') {
+			continue ;
+		}
+
+		std::istringstream ss(line);
+		Result r {};
+		if (!(ss >> r.day >> r.name >> r.phase >> r.threads >> r.stats.samples
+			  >> r.stats.median_ns >> r.stats.ci_low_ns >> r.stats.ci_high_ns)) {
+			throw std::runtime_error("bad baseline line " + std::to_string(line_number) + ": \"" + line + '"');
+		}
+		r.stats.min_ns = r.stats.p99_ns = r.stats.mean_ns = r.stats.median_ns;
+		results.push_back(r);
+	}
+	return results;
+}
+
+static bool same_case(Result const& a, Result const& b) {
+	return a.day == b.day && a.phase == b.phase && a.threads == b.threads;
+}
+
+static Comparison::Verdict judge(Stats const& base, Stats const& current, double threshold) {
+	double ratio = current.median_ns / base.median_ns;
+	if (ratio > 1 + threshold && current.ci_low_ns > base.ci_high_ns) {
+		return Comparison::SLOWER;
+	}
+	if (ratio < 1 - threshold && current.ci_high_ns < base.ci_low_ns) {
+		return Comparison::FASTER;
+	}
+	return Comparison::UNCHANGED;
+}
+
+std::vector<Comparison> compare(std::vector<Result> const& baseline, std::vector<Result> const& current,
+								double threshold) {
+	std::vector<Comparison> comparisons;
+	std::vector<bool> matched(baseline.size(), false);
+
+	// a handful of cases, quadratic is fine
+	for (auto const& r : current) {
+		Comparison c {r, Stats(), 0, Comparison::NEW};
+		for (size_t i = 0; i < baseline.size(); ++i) {
+			if (!matched[i] && same_case(baseline[i], r)) {
+				matched[i] = true;
+				c.baseline = baseline[i].stats;
+				c.ratio = baseline[i].stats.median_ns > 0 ? r.stats.median_ns / baseline[i].stats.median_ns : 0;
+				c.verdict = c.ratio > 0 ? judge(c.baseline, r.stats, threshold) : Comparison::UNCHANGED;
+				break ;
+			}
+		}
+		comparisons.push_back(c);
+	}
+	for (size_t i = 0; i < baseline.size(); ++i) {
+		if (!matched[i]) {
+			comparisons.push_back({baseline[i], baseline[i].stats, 0, Comparison::MISSING});
+		}
+	}
+	return comparisons;
+}
+
+bool has_regression(std::vector<Comparison> const& comparisons) {
+	for (auto const& c : comparisons) {
+		if (c.verdict == Comparison::SLOWER) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static char const* verdict_name(Comparison::Verdict verdict) {
+	switch (verdict) {
+		case Comparison::UNCHANGED: return "";
+		case Comparison::FASTER: return "faster";
+		case Comparison::SLOWER: return "SLOWER";
+		case Comparison::NEW: return "new";
+		case Comparison::MISSING: return "missing";
+	}
+	return "";
+}
+
+static std::string format_ratio(double ratio) {
+	if (ratio <= 0) {
+		return "-";
+	}
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(2) << ratio << 'x';
+	return ss.str();
+}
+
+void print_comparison(std::ostream& out, std::vector<Comparison> const& comparisons) {
+	out << std::left
+		<< std::setw(6) << "day" << std::setw(14) << "name" << std::setw(8) << "phase"
+		<< std::right
+		<< std::setw(8) << "threads"
+		<< std::setw(12) << "baseline" << std::setw(12) << "current" << std::setw(10) << "ratio"
+		<< "  verdict" << '\n';
+	for (auto const& c : comparisons) {
+		bool has_baseline = (c.verdict != Comparison::NEW);
+		bool has_current = (c.verdict != Comparison::MISSING);
+		out << std::left
+			<< std::setw(6) << c.result.day << std::setw(14) << c.result.name << std::setw(8) << c.result.phase
+			<< std::right
+			<< std::setw(8) << c.result.threads
+			<< std::setw(12) << (has_baseline ? format_ns(c.baseline.median_ns) : "-")
+			<< std::setw(12) << (has_current ? format_ns(c.result.stats.median_ns) : "-")
+			<< std::setw(10) << format_ratio(c.ratio)
+			<< "  " << verdict_name(c.verdict) << '\n';
+	}
+}
+
+} // namespace bench
+} // namespace aoc
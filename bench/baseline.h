@@ -0,0 +1,58 @@
+#ifndef BASELINE_H
+# define BASELINE_H
+
+# include <istream>
+# include <ostream>
+# include <vector>
+
+# include "harness.h"
+
+namespace aoc {
+namespace bench {
+
+/* -------------------------------------------------------------------------- */
+/*                                  Baselines                                 */
+/* -------------------------------------------------------------------------- */
+// Results saved by one run (`aoc_bench --save-baseline FILE`) that later runs
+// are compared with (`aoc_bench --baseline FILE`), one line per day, phase and
+// thread count:
+//
+//     # aoc_bench baseline v1
+//     # day name phase threads samples median_ns ci_low_ns ci_high_ns
+//     16 beams part2 1 10 428950000.0 422430000.0 435470000.0
+//
+// Only the timings are kept, a baseline is for the inputs it was made with.
+
+void write_baseline(std::ostream& out, std::vector<Result> const& results);
+// throws std::runtime_error if it isn't a baseline (of this version)
+std::vector<Result> read_baseline(std::istream& in);
+
+struct Comparison {
+	enum Verdict {
+		UNCHANGED, // within the threshold or within the noise
+		FASTER,
+		SLOWER,    // a regression
+		NEW,       // not in the baseline
+		MISSING    // only in the baseline
+	};
+
+	Result result; // the current one, the baseline one for MISSING
+	Stats baseline;
+	double ratio;  // current median / baseline median
+	Verdict verdict;
+};
+
+// A case only counts as slower (or faster) when its median moved by more than
+// threshold (0.1 is 10%) and the confidence intervals of both medians don't
+// overlap, so that a noisy run can't fail the comparison on its own.
+std::vector<Comparison> compare(std::vector<Result> const& baseline, std::vector<Result> const& current,
+								double threshold);
+
+bool has_regression(std::vector<Comparison> const& comparisons);
+
+void print_comparison(std::ostream& out, std::vector<Comparison> const& comparisons);
+
+} // namespace bench
+} // namespace aoc
+
+#endif // BASELINE_H
@@ -0,0 +1,415 @@
+#include "common.h"
+#include "harness.h"
+#include "range.h"
+#include "scanner.h"
+#include "vec2.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The primitives of common.h (and the headers every day includes) against the
+// raw alternatives doing the same work, on growing inputs: reading lines,
+// extracting numbers, aggregating over member functions, hashing positions
+// and intersecting ranges. Every variant of a primitive has to come to the
+// same checksum, so they're known to do the same work.
+
+using namespace aoc;
+
+static char const* const USAGE =
+	"usage: common_bench [--warmup N] [--reps N] [--max N]\n";
+
+struct Row {
+	std::string primitive;
+	std::string variant;
+	size_t n;     // items: lines, numbers, elements, ...
+	size_t bytes; // of the text, 0 if there's none
+	bench::Stats stats;
+	double allocations;
+};
+
+// The variants of one primitive on one input. run() times fn, which returns a
+// checksum of its work, and throws when it doesn't match the first variant's
+// (unless the variants compute different things, like hashes).
+struct Comparison {
+	Comparison(std::string primitive, size_t n, size_t bytes, bench::Options const& options,
+			   std::vector<Row>& rows, bool agree = true)
+		: primitive(std::move(primitive)), n(n), bytes(bytes), options(options), rows(rows),
+		  agree(agree), checked(false), expected(0) {}
+
+	template <typename F>
+	void run(char const* variant, F&& fn) {
+		int64_t checksum = 0;
+		auto samples = bench::sample(options, [&]() {
+			checksum = fn();
+		});
+		if (agree && checked && checksum != expected) {
+			throw std::runtime_error(primitive + " " + variant + " came to " + std::to_string(checksum) +
+				" instead of " + std::to_string(expected));
+		}
+		checked = true;
+		expected = checksum;
+		rows.push_back({primitive, variant, n, bytes, bench::summarize(samples.ns), samples.allocations});
+	}
+
+	private:
+	std::string primitive;
+	size_t n;
+	size_t bytes;
+	bench::Options const& options;
+	std::vector<Row>& rows;
+	bool agree;
+	bool checked;
+	int64_t expected;
+};
+
+// Back to the start of a stream that was read to the end
+static void rewind(std::istream& in) {
+	in.clear();
+	in.seekg(0);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    Lines                                   */
+/* -------------------------------------------------------------------------- */
+// n lines of up to 80 characters, the checksum is the count and total length
+
+static std::string make_lines(size_t n, std::mt19937_64& rng) {
+	static char const CHARS[] = "abcdefghijklmnopqrstuvwxyz0123456789 .#";
+	std::string text;
+	for (size_t i = 0; i < n; ++i) {
+		size_t length = rng() % 81;
+		for (size_t j = 0; j < length; ++j) {
+			text += CHARS[rng() % (sizeof(CHARS) - 1)];
+		}
+		text += '\n';
+	}
+	return text;
+}
+
+static void bench_lines(size_t n, std::mt19937_64& rng, bench::Options const& options, std::vector<Row>& rows) {
+	std::string const text = make_lines(n, rng);
+	std::istringstream in(text);
+	Comparison lines("lines", n, text.size(), options, rows);
+
+	lines.run("LineIterator", [&]() {
+		rewind(in);
+		int64_t sum = 0;
+		for (auto const& line : Lines(in)) {
+			sum += 1 + line.size();
+		}
+		return sum;
+	});
+
+	lines.run("std::getline", [&]() {
+		rewind(in);
+		int64_t sum = 0;
+		std::string line;
+		while (std::getline(in, line)) {
+			sum += 1 + line.size();
+		}
+		return sum;
+	});
+
+	// the whole stream into one buffer, then split it in place
+	std::string buffer;
+	lines.run("bulk read+memchr", [&]() {
+		rewind(in);
+		buffer.resize(text.size());
+		in.read(&buffer[0], buffer.size());
+		int64_t sum = 0;
+		char const* cur = buffer.data();
+		char const* last = cur + in.gcount();
+		while (cur < last) {
+			char const* nl = static_cast<char const*>(std::memchr(cur, '\n', last - cur));
+			char const* end = nl ? nl : last;
+			sum += 1 + (end - cur);
+			cur = end + 1;
+		}
+		return sum;
+	});
+
+	// what the days do on their mapped input (aoc::map_input), no copy at all
+	lines.run("Scanner::next_line", [&]() {
+		Scanner scan(text);
+		int64_t sum = 0;
+		while (!scan.done()) {
+			sum += 1 + scan.next_line().size();
+		}
+		return sum;
+	});
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Numbers                                  */
+/* -------------------------------------------------------------------------- */
+// n numbers, ten to a line and separated by commas ("12, -345, 6\n"), the
+// checksum is their sum
+
+static std::string make_numbers(size_t n, std::mt19937_64& rng) {
+	std::string text;
+	for (size_t i = 0; i < n; ++i) {
+		text += std::to_string(int64_t(rng() % 2000001) - 1000000);
+		text += (i % 10 == 9 || i + 1 == n) ? "\n" : ", ";
+	}
+	return text;
+}
+
+static void bench_numbers(size_t n, std::mt19937_64& rng, bench::Options const& options, std::vector<Row>& rows) {
+	std::string const text = make_numbers(n, rng);
+	Comparison numbers("numbers", n, text.size(), options, rows);
+
+	std::istringstream in(text);
+	numbers.run(">> next_digit >> n", [&]() {
+		rewind(in);
+		int64_t sum = 0;
+		int64_t value;
+		while (in >> next_digit >> value) {
+			sum += value;
+		}
+		return sum;
+	});
+
+	// commas are whitespace to the stream, so >> alone reads every number
+	std::istringstream delimited(text);
+	delimited.imbue(create_delimitor_locale<','>());
+	numbers.run("DelimitorFacet >> n", [&]() {
+		rewind(delimited);
+		int64_t sum = 0;
+		int64_t value;
+		while (delimited >> value) {
+			sum += value;
+		}
+		return sum;
+	});
+
+	numbers.run("std::strtoll", [&]() {
+		int64_t sum = 0;
+		char const* cur = text.c_str();
+		while (*cur) {
+			if (!(*cur == '-' || detail::is_digit(*cur))) {
+				++cur;
+				continue ;
+			}
+			char* end;
+			sum += std::strtoll(cur, &end, 10);
+			cur = end;
+		}
+		return sum;
+	});
+
+	numbers.run("Scanner::next_int", [&]() {
+		Scanner scan(text);
+		int64_t sum = 0;
+		int64_t value;
+		while (scan.next_int(value)) {
+			sum += value;
+		}
+		return sum;
+	});
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Aggregates                                 */
+/* -------------------------------------------------------------------------- */
+// aoc::sum/product over a member function, as the days call them on their
+// parsed structs, against the plain loops
+
+struct Item {
+	int64_t v;
+
+	int64_t value(void) const { return v; }
+};
+
+static void bench_aggregates(size_t n, std::mt19937_64& rng, bench::Options const& options, std::vector<Row>& rows) {
+	std::vector<Item> items(n);
+	for (auto& item : items) {
+		item.v = int64_t(rng() % 1000) * 2 + 1;
+	}
+
+	Comparison sums("sum", n, 0, options, rows);
+	sums.run("loop", [&]() {
+		int64_t sum = 0;
+		for (auto const& item : items) {
+			sum += item.value();
+		}
+		return sum;
+	});
+	sums.run("aoc::sum(&Item::value)", [&]() {
+		return aoc::sum(items, &Item::value);
+	});
+	sums.run("aoc::sum(lambda)", [&]() {
+		return aoc::sum(items, [](Item const& item) { return item.value(); });
+	});
+	sums.run("std::accumulate", [&]() {
+		return std::accumulate(items.begin(), items.end(), int64_t(0),
+			[](int64_t sum, Item const& item) { return sum + item.value(); });
+	});
+
+	// unsigned, the products wrap around
+	Comparison products("product", n, 0, options, rows);
+	products.run("loop", [&]() {
+		uint64_t product = 1;
+		for (auto const& item : items) {
+			product *= uint64_t(item.value());
+		}
+		return int64_t(product);
+	});
+	products.run("aoc::product(&Item::value)", [&]() {
+		return int64_t(aoc::product<uint64_t>(items, &Item::value));
+	});
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Vec2 hashing                                */
+/* -------------------------------------------------------------------------- */
+// Hashing the positions of a 1000x1000 grid, every variant computes its own
+// hashes so the checksums (their xor) don't agree
+
+static void bench_vec2_hash(size_t n, std::mt19937_64& rng, bench::Options const& options, std::vector<Row>& rows) {
+	std::vector<Vec2> positions(n);
+	for (auto& p : positions) {
+		p = Vec2(int64_t(rng() % 1000), int64_t(rng() % 1000));
+	}
+
+	Comparison hashes("Vec2 hash", n, 0, options, rows, false);
+	hashes.run("std::hash<Vec2>", [&]() {
+		std::hash<Vec2> hash;
+		size_t h = 0;
+		for (auto const& p : positions) {
+			h ^= hash(p);
+		}
+		return int64_t(h);
+	});
+	hashes.run("hash_values(x, y)", [&]() {
+		size_t h = 0;
+		for (auto const& p : positions) {
+			h ^= hash_values(p.x, p.y);
+		}
+		return int64_t(h);
+	});
+	// the identity std::hash of the packed key, what std::unordered_map gets
+	// without aoc::mix64
+	hashes.run("std::hash<uint64_t>(pack())", [&]() {
+		std::hash<uint64_t> hash;
+		size_t h = 0;
+		for (auto const& p : positions) {
+			h ^= hash(p.pack());
+		}
+		return int64_t(h);
+	});
+	hashes.run("std::hash(to_string())", [&]() {
+		std::hash<std::string> hash;
+		size_t h = 0;
+		for (auto const& p : positions) {
+			h ^= hash(p.to_string());
+		}
+		return int64_t(h);
+	});
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Ranges                                   */
+/* -------------------------------------------------------------------------- */
+// n pairs of ranges of up to 1000 values below 10000 (some overlap, some
+// don't), the checksum is the total length of their intersections
+
+static void bench_ranges(size_t n, std::mt19937_64& rng, bench::Options const& options, std::vector<Row>& rows) {
+	std::vector<std::pair<Range, Range>> pairs(n);
+	auto random_range = [&]() {
+		uint64_t begin = rng() % 10000;
+		return Range(begin, begin + rng() % 1000);
+	};
+	for (auto& p : pairs) {
+		p = {random_range(), random_range()};
+	}
+
+	Comparison intersections("Range::intersect", n, 0, options, rows);
+	intersections.run("Range::intersect", [&]() {
+		int64_t sum = 0;
+		for (auto const& p : pairs) {
+			sum += p.first.intersect(p.second).length();
+		}
+		return sum;
+	});
+	intersections.run("branches", [&]() {
+		int64_t sum = 0;
+		for (auto const& p : pairs) {
+			if (p.first.begin < p.second.end && p.second.begin < p.first.end) {
+				sum += std::min(p.first.end, p.second.end) - std::max(p.first.begin, p.second.begin);
+			}
+		}
+		return sum;
+	});
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    Main                                    */
+/* -------------------------------------------------------------------------- */
+
+static void print_rows(std::ostream& out, std::vector<Row> const& rows) {
+	out << std::left
+		<< std::setw(18) << "primitive" << std::setw(30) << "variant"
+		<< std::right
+		<< std::setw(10) << "n" << std::setw(12) << "median" << std::setw(12) << "per item"
+		<< std::setw(14) << "throughput" << std::setw(10) << "allocs" << '\n';
+	for (auto const& r : rows) {
+		double seconds = r.stats.median_ns * 1e-9;
+		std::ostringstream throughput;
+		if (r.bytes > 0 && seconds > 0) {
+			throughput << std::fixed << std::setprecision(1) << r.bytes / seconds / 1e6 << " MB/s";
+		} else {
+			throughput << "-";
+		}
+		out << std::left
+			<< std::setw(18) << r.primitive << std::setw(30) << r.variant
+			<< std::right
+			<< std::setw(10) << r.n
+			<< std::setw(12) << bench::format_ns(r.stats.median_ns)
+			<< std::setw(12) << bench::format_ns(r.stats.median_ns / r.n)
+			<< std::setw(14) << throughput.str()
+			<< std::setw(10) << bench::format_count(r.allocations) << '\n';
+	}
+}
+
+int main(int argc, char** argv) {
+	bench::Options options;
+	size_t max_n = 1000000;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--warmup" && i + 1 < argc) {
+			options.warmup = std::stoul(argv[++i]);
+		} else if (arg == "--reps" && i + 1 < argc) {
+			options.repetitions = std::max(1ul, std::stoul(argv[++i]));
+		} else if (arg == "--max" && i + 1 < argc) {
+			max_n = std::stoul(argv[++i]);
+		} else {
+			std::cerr << USAGE;
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!bench::is_optimized_build()) {
+		std::cerr << "warning: common_bench is not built optimized and/or is sanitized\n";
+	}
+
+	std::mt19937_64 rng(2023);
+	std::vector<Row> rows;
+	// from about a day's input up to far more than any of them
+	for (size_t n = 1000; n <= max_n; n *= 10) {
+		bench_lines(n, rng, options, rows);
+		bench_numbers(n, rng, options, rows);
+		bench_aggregates(n, rng, options, rows);
+		bench_vec2_hash(n, rng, options, rows);
+		bench_ranges(n, rng, options, rows);
+	}
+
+	print_rows(std::cout, rows);
+	return EXIT_SUCCESS;
+}
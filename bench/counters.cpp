@@ -0,0 +1,180 @@
+#include "counters.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+namespace aoc {
+namespace bench {
+
+CounterValues::CounterValues() {
+	for (double& v : values) {
+		v = -1;
+	}
+}
+
+bool CounterValues::any(void) const {
+	for (double v : values) {
+		if (v >= 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+double CounterValues::ipc(void) const {
+	if (!has(CYCLES) || !has(INSTRUCTIONS) || values[CYCLES] == 0) {
+		return -1;
+	}
+	return values[INSTRUCTIONS] / values[CYCLES];
+}
+
+double CounterValues::per_byte(CounterEvent event, size_t bytes) const {
+	if (!has(event) || bytes == 0) {
+		return -1;
+	}
+	return values[event] / bytes;
+}
+
+#ifdef __linux__
+
+namespace {
+
+struct EventConfig {
+	uint32_t type;
+	uint64_t config;
+};
+
+// in the order of CounterEvent
+EventConfig const EVENTS[EVENT_COUNT] = {
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	{PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+		| (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int open_event(EventConfig const& event) {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = event.type;
+	attr.config = event.config;
+	attr.disabled = 1;
+	// user space only, what perf_event_paranoid 2 still allows
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	// the PMU may have fewer counters than events, values are scaled then
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return int(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+} // namespace
+
+Counters::Counters() {
+	int first_errno = 0;
+	for (int i = 0; i < EVENT_COUNT; ++i) {
+		totals[i] = 0;
+		fds[i] = open_event(EVENTS[i]);
+		if (fds[i] < 0 && first_errno == 0) {
+			first_errno = errno;
+		}
+	}
+	if (!available()) {
+		why = std::string("perf_event_open: ") + std::strerror(first_errno);
+		if (first_errno == EACCES || first_errno == EPERM) {
+			why += " (see /proc/sys/kernel/perf_event_paranoid)";
+		}
+	}
+}
+
+Counters::~Counters() {
+	for (int fd : fds) {
+		if (fd >= 0) {
+			::close(fd);
+		}
+	}
+}
+
+bool Counters::available(void) const {
+	for (int fd : fds) {
+		if (fd >= 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void Counters::start(void) {
+	for (int fd : fds) {
+		if (fd >= 0) {
+			::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+}
+
+void Counters::stop(void) {
+	for (int fd : fds) {
+		if (fd >= 0) {
+			::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+	for (int i = 0; i < EVENT_COUNT; ++i) {
+		// value, time enabled, time running
+		uint64_t data[3];
+		if (fds[i] < 0 || ::read(fds[i], data, sizeof(data)) != ssize_t(sizeof(data))) {
+			continue ;
+		}
+		double value = double(data[0]);
+		if (data[2] != 0 && data[2] < data[1]) {
+			value *= double(data[1]) / double(data[2]);
+		}
+		totals[i] += value;
+	}
+}
+
+CounterValues Counters::average(size_t runs) const {
+	CounterValues average;
+	for (int i = 0; i < EVENT_COUNT; ++i) {
+		if (fds[i] >= 0 && runs != 0) {
+			average.values[i] = totals[i] / runs;
+		}
+	}
+	return average;
+}
+
+#else
+
+Counters::Counters() : why("hardware counters need Linux (perf_event_open)") {
+	for (int i = 0; i < EVENT_COUNT; ++i) {
+		fds[i] = -1;
+		totals[i] = 0;
+	}
+}
+
+Counters::~Counters() {}
+
+bool Counters::available(void) const {
+	return false;
+}
+
+void Counters::start(void) {}
+
+void Counters::stop(void) {}
+
+CounterValues Counters::average(size_t) const {
+	return CounterValues();
+}
+
+#endif // __linux__
+
+} // namespace bench
+} // namespace aoc
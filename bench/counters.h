@@ -0,0 +1,79 @@
+#ifndef COUNTERS_H
+# define COUNTERS_H
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+
+namespace aoc {
+namespace bench {
+
+/* -------------------------------------------------------------------------- */
+/*                          Hardware event counters                           */
+/* -------------------------------------------------------------------------- */
+// Linux perf_event_open counters of the calling thread (user space only), to
+// tell a cache bound phase from a branch bound one. Threads of the pool other
+// than the calling one aren't counted, so a phase with parallel parts reads
+// low unless it's run with --threads 1.
+//
+// Any of them can be missing: no perf_event_open at all (other OS, seccomp in
+// containers, perf_event_paranoid), or a single event the CPU or the
+// hypervisor doesn't expose. Those read as -1 instead of failing the run.
+
+enum CounterEvent {
+	CYCLES,
+	INSTRUCTIONS,
+	L1D_MISSES,
+	LLC_MISSES,
+	BRANCH_MISSES,
+	EVENT_COUNT
+};
+
+// Per run, -1 for a counter that isn't available
+struct CounterValues {
+	// none of them
+	CounterValues();
+
+	double values[EVENT_COUNT];
+
+	double operator[](CounterEvent event) const { return values[event]; }
+	bool has(CounterEvent event) const { return values[event] >= 0; }
+	bool any(void) const;
+
+	// instructions per cycle, -1 if either is missing
+	double ipc(void) const;
+	// event per byte of input, -1 if it's missing
+	double per_byte(CounterEvent event, size_t bytes) const;
+};
+
+struct Counters {
+	// opens every event (disabled), the ones that fail stay closed
+	Counters();
+	~Counters();
+
+	Counters(Counters const&) = delete;
+	Counters& operator=(Counters const&) = delete;
+
+	// whether at least one event could be opened
+	bool available(void) const;
+	// why nothing could be opened (empty if something could)
+	std::string const& error(void) const { return why; }
+
+	// reset and start counting
+	void start(void);
+	// stop counting and add what was counted since start()
+	void stop(void);
+
+	// what was added up so far, divided by runs
+	CounterValues average(size_t runs) const;
+
+	private:
+	int fds[EVENT_COUNT];
+	double totals[EVENT_COUNT];
+	std::string why;
+};
+
+} // namespace bench
+} // namespace aoc
+
+#endif // COUNTERS_H
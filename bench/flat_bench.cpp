@@ -0,0 +1,212 @@
+#include "flat_map.h"
+#include "harness.h"
+#include "vec2.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// aoc::FlatMap/FlatSet against std::unordered_map/set on the key types (and
+// hashes) of the days that use them, with about as many keys as their inputs.
+
+using namespace aoc;
+
+static char const* const USAGE =
+	"usage: flat_bench [--warmup N] [--reps N]\n";
+
+/* -------------------------------------------------------------------------- */
+/*                                  Key types                                 */
+/* -------------------------------------------------------------------------- */
+// Copies of the keys in the days, which keep theirs in their own namespace
+
+// day 16 energized
+struct Beam {
+	Vec2 p, d;
+
+	bool operator==(Beam const& rhs) const {
+		return (p == rhs.p && d == rhs.d);
+	}
+};
+
+struct BeamHash {
+	size_t operator()(Beam const& b) const {
+		return hash_values(b.p, b.d);
+	}
+};
+
+// What day 16 hashed with before, formatting both vectors on every probe
+struct BeamStringHash {
+	size_t operator()(Beam const& b) const {
+		return std::hash<std::string>()(b.p.to_string() + b.d.to_string());
+	}
+};
+
+// day 17 distances
+struct Permutation {
+	Vec2 pos;
+	Vec2 dir;
+	int64_t count;
+
+	bool operator==(Permutation const& rhs) const {
+		return (pos == rhs.pos && dir == rhs.dir && count == rhs.count);
+	}
+};
+
+struct PermutationHash {
+	size_t operator()(Permutation const& d) const {
+		return hash_values(d.pos, d.dir, d.count);
+	}
+};
+
+static Vec2 const DIRS[] = {Vec2::right(), Vec2::up(), Vec2::left(), Vec2::down()};
+
+/* -------------------------------------------------------------------------- */
+/*                                  Workloads                                 */
+/* -------------------------------------------------------------------------- */
+
+struct Row {
+	std::string key;
+	std::string container;
+	std::string op;
+	size_t n;
+	bench::Stats stats;
+	double allocations;
+};
+
+// Keys to insert and the keys to look up afterwards (about half of them hits)
+template <typename K>
+struct Workload {
+	std::string name;
+	std::vector<K> keys;
+	std::vector<K> probes;
+};
+
+template <typename K, typename MakeKey>
+Workload<K> make_workload(char const* name, size_t n, MakeKey make_key) {
+	Workload<K> w {name, {}, {}};
+	for (size_t i = 0; i < n; ++i) {
+		w.keys.push_back(make_key());
+	}
+	for (size_t i = 0; i < n; ++i) {
+		w.probes.push_back((i % 2) ? w.keys[i] : make_key());
+	}
+	return w;
+}
+
+// Insert every key into a cleared container, then look up every probe.
+// insert has to turn a key into the value_type of the container.
+template <typename Container, typename K, typename Insert>
+void bench_container(char const* container_name, Workload<K> const& w, Insert insert,
+					 bench::Options const& options, std::vector<Row>& rows) {
+	Container c;
+	auto samples = bench::sample(options, [&]() {
+		c.clear();
+		for (auto const& k : w.keys) {
+			insert(c, k);
+		}
+	});
+	rows.push_back({w.name, container_name, "insert", w.keys.size(), bench::summarize(samples.ns), samples.allocations});
+
+	size_t found = 0;
+	samples = bench::sample(options, [&]() {
+		for (auto const& k : w.probes) {
+			found += c.count(k);
+		}
+	});
+	rows.push_back({w.name, container_name, "find", w.probes.size(), bench::summarize(samples.ns), samples.allocations});
+
+	// keeps the lookups from being optimized out
+	if (found == size_t(-1)) {
+		std::cout << found;
+	}
+}
+
+template <typename K, typename Hash>
+void bench_maps(Workload<K> const& w, bench::Options const& options, std::vector<Row>& rows) {
+	bench_container<std::unordered_map<K, uint64_t, Hash>>("unordered_map", w,
+		[](std::unordered_map<K, uint64_t, Hash>& c, K const& k) { c.insert({k, 1}); }, options, rows);
+	bench_container<FlatMap<K, uint64_t, Hash>>("FlatMap", w,
+		[](FlatMap<K, uint64_t, Hash>& c, K const& k) { c.insert({k, 1}); }, options, rows);
+}
+
+template <typename K, typename Hash>
+void bench_sets(Workload<K> const& w, bench::Options const& options, std::vector<Row>& rows) {
+	bench_container<std::unordered_set<K, Hash>>("unordered_set", w,
+		[](std::unordered_set<K, Hash>& c, K const& k) { c.insert(k); }, options, rows);
+	bench_container<FlatSet<K, Hash>>("FlatSet", w,
+		[](FlatSet<K, Hash>& c, K const& k) { c.insert(k); }, options, rows);
+}
+
+static void print_rows(std::ostream& out, std::vector<Row> const& rows) {
+	out << std::left
+		<< std::setw(20) << "keys" << std::setw(16) << "container" << std::setw(8) << "op"
+		<< std::right
+		<< std::setw(12) << "median" << std::setw(12) << "per key" << std::setw(10) << "allocs" << '\n';
+	for (auto const& r : rows) {
+		out << std::left
+			<< std::setw(20) << r.key << std::setw(16) << r.container << std::setw(8) << r.op
+			<< std::right
+			<< std::setw(12) << bench::format_ns(r.stats.median_ns)
+			<< std::setw(12) << bench::format_ns(r.stats.median_ns / r.n)
+			<< std::setw(10) << bench::format_count(r.allocations) << '\n';
+	}
+}
+
+int main(int argc, char** argv) {
+	bench::Options options;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--warmup" && i + 1 < argc) {
+			options.warmup = std::stoul(argv[++i]);
+		} else if (arg == "--reps" && i + 1 < argc) {
+			options.repetitions = std::max(1ul, std::stoul(argv[++i]));
+		} else {
+			std::cerr << USAGE;
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!bench::is_optimized_build()) {
+		std::cerr << "warning: flat_bench is not built optimized and/or is sanitized\n";
+	}
+
+	std::mt19937_64 rng(2023);
+	auto below = [&](uint64_t n) { return int64_t(rng() % n); };
+
+	std::vector<Row> rows;
+
+	// day 14: the whole 100x100 grid of rocks, one per cycle until it repeats
+	bench_maps<std::string, std::hash<std::string>>(make_workload<std::string>("day14 grid", 200, [&]() {
+		static char const TILES[] = ".#O";
+		std::string grid(100 * 100, '.');
+		for (auto& c : grid) {
+			c = TILES[below(3)];
+		}
+		return grid;
+	}), options, rows);
+
+	// day 16: position and direction of a beam on a 110x110 grid
+	auto beams = make_workload<Beam>("day16 Beam", 20000, [&]() {
+		return Beam{Vec2(below(110), below(110)), DIRS[below(4)]};
+	});
+	bench_sets<Beam, BeamHash>(beams, options, rows);
+	beams.name = "day16 Beam str";
+	bench_sets<Beam, BeamStringHash>(beams, options, rows);
+
+	// day 17: state of a crucible on a 141x141 grid
+	bench_maps<Permutation, PermutationHash>(make_workload<Permutation>("day17 Permutation", 200000, [&]() {
+		return Permutation{Vec2(below(141), below(141)), DIRS[below(4)], 1 + below(10)};
+	}), options, rows);
+
+	// day 20: the inputs of a conjunction, a handful of module ids
+	bench_maps<uint32_t, std::hash<uint32_t>>(make_workload<uint32_t>("day20 id", 12, [&]() {
+		return uint32_t(below(60));
+	}), options, rows);
+
+	print_rows(std::cout, rows);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+#include "grid.h"
+#include "harness.h"
+#include "transpose.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Scanning every column of a char grid in place (a stride apart) against
+// transposing it first and scanning the rows of the copy, on square grids of
+// growing size. Small grids fit in L1 and walk their columns for free, from
+// some size on the transpose pays for itself: the crossover.
+
+using namespace aoc;
+
+static char const* const USAGE =
+	"usage: grid_bench [--warmup N] [--reps N] [--max SIZE]\n";
+
+struct Row {
+	int64_t size;
+	double columns_ns;   // column walks
+	double transpose_ns; // transpose alone
+	double rows_ns;      // transpose and row scans
+	int64_t checksum;
+};
+
+// What the days do per column: count the cells of a kind
+template <typename Column>
+int64_t count_rocks(Column const& column) {
+	return std::count(column.begin(), column.end(), '#');
+}
+
+static Row bench_size(int64_t size, bench::Options const& options, std::mt19937_64& rng) {
+	Grid<char> grid(size, size, '.');
+	for (int64_t y = 0; y < size; ++y) {
+		for (auto& c : grid.row(y)) {
+			c = (rng() % 4 == 0) ? '#' : '.';
+		}
+	}
+
+	int64_t by_columns = 0;
+	auto columns = bench::sample(options, [&]() {
+		by_columns = 0;
+		for (int64_t x = 0; x < size; ++x) {
+			by_columns += count_rocks(grid.column(x)) * x;
+		}
+	});
+
+	Grid<char> transposed;
+	auto transpose_only = bench::sample(options, [&]() {
+		transpose(grid, transposed);
+	});
+
+	int64_t by_rows = 0;
+	auto rows = bench::sample(options, [&]() {
+		transpose(grid, transposed);
+		by_rows = 0;
+		for (int64_t x = 0; x < size; ++x) {
+			by_rows += count_rocks(transposed.row(x)) * x;
+		}
+	});
+
+	if (by_rows != by_columns) {
+		throw std::runtime_error("transposed scan counted " + std::to_string(by_rows) +
+			" instead of " + std::to_string(by_columns));
+	}
+	return Row {
+		size,
+		bench::summarize(columns.ns).median_ns,
+		bench::summarize(transpose_only.ns).median_ns,
+		bench::summarize(rows.ns).median_ns,
+		by_rows
+	};
+}
+
+int main(int argc, char** argv) {
+	bench::Options options;
+	int64_t max_size = 4096;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--warmup" && i + 1 < argc) {
+			options.warmup = std::stoul(argv[++i]);
+		} else if (arg == "--reps" && i + 1 < argc) {
+			options.repetitions = std::max(1ul, std::stoul(argv[++i]));
+		} else if (arg == "--max" && i + 1 < argc) {
+			max_size = std::stol(argv[++i]);
+		} else {
+			std::cerr << USAGE;
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!bench::is_optimized_build()) {
+		std::cerr << "warning: grid_bench is not built optimized and/or is sanitized\n";
+	}
+
+	std::mt19937_64 rng(2023);
+	std::vector<Row> rows;
+	for (int64_t size = 8; size <= max_size; size *= 2) {
+		rows.push_back(bench_size(size, options, rng));
+	}
+
+	std::cout << std::right << std::setw(8) << "size" << std::setw(14) << "columns"
+		<< std::setw(14) << "transpose" << std::setw(14) << "transp+rows" << std::setw(10) << "speedup" << '\n';
+	int64_t crossover = 0;
+	for (auto const& r : rows) {
+		double speedup = r.rows_ns > 0 ? r.columns_ns / r.rows_ns : 0;
+		std::cout << std::setw(8) << r.size
+			<< std::setw(14) << bench::format_ns(r.columns_ns)
+			<< std::setw(14) << bench::format_ns(r.transpose_ns)
+			<< std::setw(14) << bench::format_ns(r.rows_ns)
+			<< std::setw(9) << std::fixed << std::setprecision(2) << speedup << "x" << '\n';
+		if (speedup > 1 && crossover == 0) {
+			crossover = r.size;
+		} else if (speedup <= 1) {
+			crossover = 0;
+		}
+	}
+	if (crossover != 0) {
+		std::cout << "\ntransposing pays off from " << crossover << "x" << crossover << " on\n";
+	} else {
+		std::cout << "\ntransposing didn't pay off up to " << max_size << "x" << max_size << '\n';
+	}
+	return EXIT_SUCCESS;
+}
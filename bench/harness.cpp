@@ -0,0 +1,193 @@
+#include "harness.h"
+#include "memory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+namespace aoc {
+namespace bench {
+
+Stats summarize(std::vector<double> samples_ns) {
+	Stats stats {samples_ns.size(), 0, 0, 0, 0, 0, 0};
+	if (samples_ns.empty()) {
+		return stats;
+	}
+	std::sort(samples_ns.begin(), samples_ns.end());
+
+	size_t n = samples_ns.size();
+	stats.min_ns = samples_ns.front();
+	stats.median_ns = (n % 2) ? samples_ns[n / 2] : (samples_ns[n / 2 - 1] + samples_ns[n / 2]) / 2;
+	// nearest-rank percentile
+	stats.p99_ns = samples_ns[size_t(std::ceil(0.99 * n)) - 1];
+	stats.mean_ns = std::accumulate(samples_ns.begin(), samples_ns.end(), 0.0) / n;
+	// ranks n/2 -+ 1.96 * sqrt(n) / 2
+	double spread = 0.98 * std::sqrt(double(n));
+	stats.ci_low_ns = samples_ns[size_t(std::max(0.0, std::floor(n / 2.0 - spread)))];
+	stats.ci_high_ns = samples_ns[std::min(n - 1, size_t(std::ceil(n / 2.0 + spread)))];
+	return stats;
+}
+
+uint64_t allocation_count(void) {
+	return memory::totals().allocations;
+}
+
+bool is_optimized_build(void) {
+#if defined(__SANITIZE_ADDRESS__) || !defined(__OPTIMIZE__)
+	return false;
+#else
+	return true;
+#endif
+}
+
+std::string format_ns(double ns) {
+	static char const* const UNITS[] = {"ns", "us", "ms", "s"};
+	size_t unit = 0;
+	while (ns >= 1000.0 && unit < 3) {
+		ns /= 1000.0;
+		++unit;
+	}
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(2) << ns << ' ' << UNITS[unit];
+	return ss.str();
+}
+
+static std::string format_throughput(double bytes_per_second) {
+	static char const* const UNITS[] = {"B/s", "KB/s", "MB/s", "GB/s"};
+	size_t unit = 0;
+	while (bytes_per_second >= 1000.0 && unit < 3) {
+		bytes_per_second /= 1000.0;
+		++unit;
+	}
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(2) << bytes_per_second << ' ' << UNITS[unit];
+	return ss.str();
+}
+
+std::string format_count(double count) {
+	std::ostringstream ss;
+	if (count < 0) {
+		ss << '-';
+	} else if (count == std::floor(count)) {
+		ss << std::fixed << std::setprecision(0) << count;
+	} else {
+		ss << std::fixed << std::setprecision(1) << count;
+	}
+	return ss.str();
+}
+
+// Counter columns of print_table(), "-" for the missing ones
+static std::string format_ratio(double value) {
+	if (value < 0) {
+		return "-";
+	}
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(value < 10 ? 3 : 1) << value;
+	return ss.str();
+}
+
+static bool any_counters(std::vector<Result> const& results) {
+	for (auto const& r : results) {
+		if (r.counters.any()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void print_table(std::ostream& out, std::vector<Result> const& results) {
+	bool counters = any_counters(results);
+	out << std::left
+		<< std::setw(6) << "day" << std::setw(14) << "name" << std::setw(8) << "phase"
+		<< std::right
+		<< std::setw(8) << "threads"
+		<< std::setw(12) << "min" << std::setw(12) << "median" << std::setw(12) << "p99"
+		<< std::setw(14) << "throughput" << std::setw(10) << "allocs";
+	if (counters) {
+		out << std::setw(7) << "IPC" << std::setw(11) << "L1 miss/B" << std::setw(11) << "LLC miss/B"
+			<< std::setw(11) << "br miss/B";
+	}
+	out << "  answer" << '\n';
+	for (auto const& r : results) {
+		out << std::left
+			<< std::setw(6) << r.day << std::setw(14) << r.name << std::setw(8) << r.phase
+			<< std::right
+			<< std::setw(8) << r.threads
+			<< std::setw(12) << format_ns(r.stats.min_ns)
+			<< std::setw(12) << format_ns(r.stats.median_ns)
+			<< std::setw(12) << format_ns(r.stats.p99_ns)
+			<< std::setw(14) << format_throughput(r.bytes_per_second())
+			<< std::setw(10) << format_count(r.allocations);
+		if (counters) {
+			out << std::setw(7) << format_ratio(r.counters.ipc())
+				<< std::setw(11) << format_ratio(r.counters.per_byte(L1D_MISSES, r.bytes))
+				<< std::setw(11) << format_ratio(r.counters.per_byte(LLC_MISSES, r.bytes))
+				<< std::setw(11) << format_ratio(r.counters.per_byte(BRANCH_MISSES, r.bytes));
+		}
+		out << "  " << r.answer << '\n';
+	}
+}
+
+static std::string json_string(std::string const& str) {
+	std::string escaped = "\"";
+	for (char c : str) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+	return escaped + '"';
+}
+
+void write_json(std::ostream& out, std::vector<Result> const& results, Options const& options) {
+	out << "{\n"
+		<< "  \"optimized\": " << (is_optimized_build() ? "true" : "false") << ",\n"
+		<< "  \"warmup\": " << options.warmup << ",\n"
+		<< "  \"repetitions\": " << options.repetitions << ",\n"
+		<< "  \"results\": [";
+	for (size_t i = 0; i < results.size(); ++i) {
+		auto const& r = results[i];
+		out << (i ? ",\n" : "\n")
+			<< "    {\"day\": " << r.day
+			<< ", \"name\": " << json_string(r.name)
+			<< ", \"phase\": " << json_string(r.phase)
+			<< ", \"bytes\": " << r.bytes
+			<< ", \"threads\": " << r.threads
+			<< ", \"samples\": " << r.stats.samples
+			<< std::fixed << std::setprecision(1)
+			<< ", \"min_ns\": " << r.stats.min_ns
+			<< ", \"median_ns\": " << r.stats.median_ns
+			<< ", \"p99_ns\": " << r.stats.p99_ns
+			<< ", \"mean_ns\": " << r.stats.mean_ns
+			<< ", \"ci_low_ns\": " << r.stats.ci_low_ns
+			<< ", \"ci_high_ns\": " << r.stats.ci_high_ns
+			<< ", \"bytes_per_sec\": " << r.bytes_per_second()
+			<< ", \"allocations\": ";
+		if (r.allocations < 0) {
+			out << "null";
+		} else {
+			out << r.allocations;
+		}
+		if (r.counters.any()) {
+			// per run, null if the event couldn't be counted
+			static char const* const NAMES[EVENT_COUNT] = {
+				"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+			};
+			for (int e = 0; e < EVENT_COUNT; ++e) {
+				out << ", \"" << NAMES[e] << "\": ";
+				if (r.counters.has(CounterEvent(e))) {
+					out << r.counters[CounterEvent(e)];
+				} else {
+					out << "null";
+				}
+			}
+		}
+		out << ", \"answer\": " << json_string(r.answer) << '}';
+	}
+	out << "\n  ]\n}\n";
+}
+
+} // namespace bench
+} // namespace aoc
@@ -0,0 +1,113 @@
+#ifndef HARNESS_H
+# define HARNESS_H
+
+# include <chrono>
+# include <cstdint>
+# include <memory>
+# include <ostream>
+# include <string>
+# include <vector>
+
+# include "counters.h"
+# include "memory.h"
+
+namespace aoc {
+namespace bench {
+
+struct Options {
+	size_t warmup = 2;
+	size_t repetitions = 10;
+	bool counters = false; // count hardware events of the timed runs (counters.h)
+};
+
+// Summary of the wall times (in nanoseconds) of all repetitions of one case
+struct Stats {
+	size_t samples;
+	double min_ns;
+	double median_ns;
+	double p99_ns;
+	double mean_ns;
+	// ~95% confidence interval of the median (order statistics, normal
+	// approximation of the binomial), what baselines are compared with
+	double ci_low_ns;
+	double ci_high_ns;
+};
+
+Stats summarize(std::vector<double> samples_ns);
+
+// Calls to operator new so far, by any thread. Only counted when built with
+// AOC_MEMORY (include/memory.h), otherwise 0.
+uint64_t allocation_count(void);
+
+struct Samples {
+	std::vector<double> ns; // wall time of every timed run
+	double allocations;     // operator new calls per timed run, -1 if not counted
+	CounterValues counters; // per timed run, if options.counters
+};
+
+// Run fn options.warmup times untimed and then options.repetitions times timed.
+template <typename F>
+Samples sample(Options const& options, F&& fn) {
+	using clock = std::chrono::steady_clock;
+
+	for (size_t i = 0; i < options.warmup; ++i) {
+		fn();
+	}
+
+	Samples samples;
+	samples.ns.reserve(options.repetitions);
+	std::unique_ptr<Counters> counters(options.counters ? new Counters() : nullptr);
+	uint64_t allocations = allocation_count();
+	for (size_t i = 0; i < options.repetitions; ++i) {
+		// counting starts and stops outside of the clock, it's a few syscalls
+		if (counters) {
+			counters->start();
+		}
+		auto start = clock::now();
+		fn();
+		auto end = clock::now();
+		if (counters) {
+			counters->stop();
+		}
+		samples.ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+	}
+	samples.allocations = memory::hooked() ? double(allocation_count() - allocations) / options.repetitions : -1;
+	if (counters) {
+		samples.counters = counters->average(options.repetitions);
+	}
+	return samples;
+}
+
+// One benchmark case: a phase (parse, part1, part2, ...) of a day
+struct Result {
+	int day;
+	std::string name;
+	std::string phase;
+	size_t bytes; // input size, for throughput
+	Stats stats;
+	double allocations; // operator new calls per run, -1 if not counted
+	size_t threads; // size of the global thread pool
+	std::string answer;
+	CounterValues counters; // per run, none unless asked for
+
+	double bytes_per_second(void) const {
+		return stats.median_ns > 0 ? bytes / (stats.median_ns * 1e-9) : 0;
+	}
+};
+
+// Whether this binary is fit for timing at all
+bool is_optimized_build(void);
+
+// Human friendly time ("1.23 ms")
+std::string format_ns(double ns);
+// Whole numbers unless they aren't (allocations per run), "-" if negative
+// (not counted)
+std::string format_count(double count);
+
+void print_table(std::ostream& out, std::vector<Result> const& results);
+void write_json(std::ostream& out, std::vector<Result> const& results, Options const& options);
+
+} // namespace bench
+} // namespace aoc
+
+#endif // HARNESS_H
@@ -0,0 +1,61 @@
+#include "arena.h"
+
+#include <algorithm>
+
+namespace aoc {
+
+Arena::Arena(size_t block_size) : current(0), used(0), block_size(block_size) {}
+
+Arena::~Arena() {
+	for (auto const& b : blocks) {
+		::operator delete(b.data);
+	}
+}
+
+void* Arena::allocate_slow(size_t size, size_t align) {
+	// worst case padding, blocks themselves are aligned to max_align_t
+	size_t needed = size + align;
+
+	// The blocks after current are free again after a rewind, take the first
+	// one that fits and move the ones that don't out of the way
+	size_t next = blocks.empty() ? 0 : current + 1;
+	for (size_t i = next; i < blocks.size(); ++i) {
+		if (blocks[i].size >= needed) {
+			std::swap(blocks[next], blocks[i]);
+			current = next;
+			used = 0;
+			return allocate(size, align);
+		}
+	}
+
+	// Grow geometrically so a solve that needs a lot only needs a few blocks
+	size_t grown = blocks.empty() ? block_size : blocks.back().size * 2;
+	Block b { static_cast<char*>(::operator new(std::max(grown, needed))), std::max(grown, needed) };
+	blocks.insert(blocks.begin() + next, b);
+	current = next;
+	used = 0;
+	return allocate(size, align);
+}
+
+size_t Arena::bytes_used(void) const {
+	size_t bytes = used;
+	for (size_t i = 0; i < current && i < blocks.size(); ++i) {
+		bytes += blocks[i].size;
+	}
+	return bytes;
+}
+
+size_t Arena::capacity(void) const {
+	size_t bytes = 0;
+	for (auto const& b : blocks) {
+		bytes += b.size;
+	}
+	return bytes;
+}
+
+Arena& scratch_arena(void) {
+	static thread_local Arena arena;
+	return arena;
+}
+
+} // namespace aoc
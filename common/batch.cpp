@@ -0,0 +1,189 @@
+#include "batch.h"
+#include "input.h"
+#include "parse_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace aoc {
+
+std::vector<BatchItem> read_manifest(std::string const& path) {
+	Input manifest = Input::from_file(path);
+	StringView rest = manifest.view();
+	std::vector<BatchItem> items;
+	while (!rest.empty()) {
+		StringView line = next_line(rest);
+		while (!line.empty() && (line.back() == ' ' || line.back() == '\t' || line.back() == '\r')) {
+			line = line.substr(0, line.size() - 1);
+		}
+		if (line.empty() || line[0] == '#') {
+			continue ;
+		}
+
+		BatchItem item {0, std::string(line.data(), line.size())};
+		size_t space = line.find(' ');
+		if (space != StringView::npos && space > 0 &&
+			std::all_of(line.begin(), line.begin() + space, [](char c) { return c >= '0' && c <= '9'; })) {
+			item.day = std::atoi(std::string(line.data(), space).c_str());
+			item.path = std::string(line.data() + space + 1, line.size() - space - 1);
+		}
+		items.push_back(std::move(item));
+	}
+	return items;
+}
+
+std::vector<BatchResult> run_batch(std::vector<BatchItem> const& items,
+								   std::function<Solution const*(int)> const& find, ParseCache const& cache,
+								   ThreadPool& pool) {
+	using clock = std::chrono::steady_clock;
+
+	std::vector<BatchResult> results(items.size(), BatchResult {"", "", 0, false, ""});
+	std::vector<Input> inputs(items.size());
+	std::vector<uint64_t> hashes(items.size(), 0);
+
+	// Map and hash everything first, so the copies can be told apart before
+	// anything is solved. A group per phase, the pool may be busy with others.
+	TaskGroup reading(pool);
+	for (size_t i = 0; i < items.size(); ++i) {
+		reading.spawn([&, i]() {
+			try {
+				inputs[i] = Input::from_file(items[i].path);
+				hashes[i] = content_hash(inputs[i].view());
+			} catch (std::exception const& e) {
+				results[i].error = e.what();
+			}
+		});
+	}
+	reading.wait();
+
+	// original[i] == i for the inputs that get solved
+	std::vector<size_t> original(items.size());
+	std::map<std::pair<int, uint64_t>, std::vector<size_t>> seen;
+	for (size_t i = 0; i < items.size(); ++i) {
+		original[i] = i;
+		if (!results[i].error.empty()) {
+			continue ;
+		}
+		auto& same_hash = seen[std::make_pair(items[i].day, hashes[i])];
+		for (size_t j : same_hash) {
+			if (inputs[j].view() == inputs[i].view()) {
+				original[i] = j;
+				break ;
+			}
+		}
+		if (original[i] == i) {
+			same_hash.push_back(i);
+		}
+	}
+
+	TaskGroup solving(pool);
+	for (size_t i = 0; i < items.size(); ++i) {
+		if (original[i] != i || !results[i].error.empty()) {
+			continue ;
+		}
+		solving.spawn([&, i]() {
+			BatchResult& r = results[i];
+			try {
+				Solution const* solution = find(items[i].day);
+				if (solution == nullptr) {
+					throw std::runtime_error("no solution for day " + std::to_string(items[i].day));
+				}
+				auto start = clock::now();
+				Solution::parsed_t parsed = cache.parse(*solution, inputs[i].view());
+				r.part1 = solution->part1(parsed.get());
+				if (solution->part2) {
+					r.part2 = solution->part2(parsed.get());
+				}
+				r.ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+			} catch (std::exception const& e) {
+				r.error = e.what();
+			}
+			// unmap as we go, sweeps can be large
+			inputs[i] = Input();
+		});
+	}
+	solving.wait();
+
+	for (size_t i = 0; i < items.size(); ++i) {
+		if (original[i] != i) {
+			results[i] = results[original[i]];
+			results[i].ns = 0;
+			results[i].duplicate = true;
+		}
+	}
+	return results;
+}
+
+void print_batch(std::ostream& out, std::vector<BatchItem> const& items,
+				 std::vector<BatchResult> const& results, bool with_day) {
+	for (size_t i = 0; i < items.size(); ++i) {
+		BatchResult const& r = results[i];
+		if (with_day) {
+			out << items[i].day << '\t';
+		}
+		out << items[i].path << '\t';
+		if (!r.error.empty()) {
+			out << "error: " << r.error << '\n';
+			continue ;
+		}
+		out << r.part1 << '\t' << (r.part2.empty() ? "-" : r.part2) << '\t'
+			<< std::fixed << std::setprecision(3) << r.ns * 1e-6
+			<< (r.duplicate ? "\t(same as an earlier input)" : "") << '\n';
+	}
+}
+
+bool is_batch(int argc, char** argv) {
+	return argc > 2 || (argc == 2 && argv[1][0] == '-' && argv[1][1] == '-');
+}
+
+int batch_main(int argc, char** argv, Solution const& solution) {
+	static char const* const USAGE =
+		"usage: dayNN [INPUT]\n"
+		"       dayNN [--threads N] [--manifest FILE] INPUT...\n"
+		"  With more than one input (or a manifest, one path per line) prints a line\n"
+		"  per input: PATH PART1 PART2 MS, in the order they were given\n";
+
+	std::vector<BatchItem> items;
+	size_t threads = ThreadPool::default_thread_count();
+	try {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			bool has_value = (i + 1 < argc);
+			if (arg == "--threads" && has_value) {
+				threads = std::max(1ul, std::stoul(argv[++i]));
+			} else if (arg == "--manifest" && has_value) {
+				for (auto& item : read_manifest(argv[++i])) {
+					items.push_back(std::move(item));
+				}
+			} else if (arg[0] != '-') {
+				items.push_back({0, arg});
+			} else {
+				throw std::runtime_error("bad argument \"" + arg + "\"\n" + USAGE);
+			}
+		}
+	} catch (std::exception const& e) {
+		std::cerr << e.what();
+		return EXIT_FAILURE;
+	}
+
+	ThreadPool::set_global_threads(threads);
+	std::vector<BatchResult> results = run_batch(items, [&solution](int day) {
+		return (day == 0 || day == solution.day) ? &solution : nullptr;
+	});
+	print_batch(std::cout, items, results, false);
+
+	for (auto const& r : results) {
+		if (!r.error.empty()) {
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+} // namespace aoc
@@ -0,0 +1,125 @@
+#include "input.h"
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace aoc {
+
+// === Input ===
+Input::Input() : ptr(nullptr), len(0), mapped(false) {}
+
+Input::Input(Input&& other) : ptr(nullptr), len(0), mapped(false) {
+	*this = std::move(other);
+}
+
+Input& Input::operator=(Input&& other) {
+	if (this == &other) {
+		return *this;
+	}
+	release();
+	buffer.swap(other.buffer);
+	ptr = other.mapped ? other.ptr : buffer.data();
+	len = other.len;
+	mapped = other.mapped;
+	other.ptr = nullptr;
+	other.len = 0;
+	other.mapped = false;
+	return *this;
+}
+
+Input::~Input() {
+	release();
+}
+
+void Input::release(void) {
+	if (mapped) {
+		::munmap(const_cast<char*>(ptr), len);
+	}
+	buffer.clear();
+	ptr = nullptr;
+	len = 0;
+	mapped = false;
+}
+
+Input Input::from_fd(int fd) {
+	Input input;
+
+	struct stat st;
+	if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			::madvise(p, st.st_size, MADV_SEQUENTIAL);
+			input.ptr = static_cast<char const*>(p);
+			input.len = st.st_size;
+			input.mapped = true;
+			return input;
+		}
+	}
+
+	// Not mappable (stdin, pipe, ...), read everything in big chunks
+	static size_t const CHUNK = 1 << 16;
+	size_t used = 0;
+	for (;;) {
+		if (input.buffer.size() - used < CHUNK) {
+			input.buffer.resize(std::max(input.buffer.size() * 2, used + CHUNK));
+		}
+		ssize_t n = ::read(fd, input.buffer.data() + used, input.buffer.size() - used);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::runtime_error(std::string("Can't read input: ") + std::strerror(errno));
+		}
+		if (n == 0) {
+			break ;
+		}
+		used += n;
+	}
+	input.buffer.resize(used);
+	input.ptr = input.buffer.data();
+	input.len = used;
+	return input;
+}
+
+Input Input::from_file(std::string const& path) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("Can't open file \"" + path + '\"');
+	}
+	try {
+		Input input = from_fd(fd);
+		::close(fd);
+		return input;
+	} catch (...) {
+		::close(fd);
+		throw;
+	}
+}
+
+Input map_input(int argc, char** argv) {
+	if (argc < 2 || argv == nullptr || argv[1] == nullptr) {
+		return Input::from_fd(STDIN_FILENO);
+	}
+	return Input::from_file(argv[1]);
+}
+
+// === View Lines ===
+StringView next_line(StringView& input) {
+	size_t pos = input.find('\n');
+	if (pos == StringView::npos) {
+		StringView line = input;
+		input = StringView(input.end(), size_t(0));
+		return line;
+	}
+	StringView line = input.substr(0, pos);
+	input.remove_prefix(pos + 1);
+	return line;
+}
+
+} // namespace aoc
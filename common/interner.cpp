@@ -0,0 +1,67 @@
+#include "interner.h"
+
+#include <functional>
+
+namespace aoc {
+
+Interner::id_t const Interner::NONE;
+
+// index of the slot holding label, or of the empty slot it would go in
+size_t Interner::slot_of(StringView label, size_t hash) const {
+	size_t mask = slots.size() - 1;
+	for (size_t i = hash & mask;; i = (i + 1) & mask) {
+		id_t id = slots[i];
+		if (id == NONE || (hashes[id] == hash && StringView(names[id]) == label)) {
+			return i;
+		}
+	}
+}
+
+void Interner::rehash(size_t slot_count) {
+	slots.assign(slot_count, NONE);
+	size_t mask = slot_count - 1;
+	for (id_t id = 0; id < names.size(); ++id) {
+		size_t i = hashes[id] & mask;
+		while (slots[i] != NONE) {
+			i = (i + 1) & mask;
+		}
+		slots[i] = id;
+	}
+}
+
+Interner::id_t Interner::intern(StringView label) {
+	// at most half full, keeps the probe sequences short
+	if ((names.size() + 1) * 2 > slots.size()) {
+		rehash(slots.empty() ? 64 : slots.size() * 2);
+	}
+
+	size_t hash = std::hash<StringView>()(label);
+	size_t i = slot_of(label, hash);
+	if (slots[i] == NONE) {
+		slots[i] = id_t(names.size());
+		names.push_back(label.str());
+		hashes.push_back(hash);
+	}
+	return slots[i];
+}
+
+Interner::id_t Interner::find(StringView label) const {
+	if (slots.empty()) {
+		return NONE;
+	}
+	return slots[slot_of(label, std::hash<StringView>()(label))];
+}
+
+void Interner::reserve(size_t n) {
+	names.reserve(n);
+	hashes.reserve(n);
+	size_t slot_count = slots.empty() ? 64 : slots.size();
+	while (n * 2 > slot_count) {
+		slot_count *= 2;
+	}
+	if (slot_count != slots.size()) {
+		rehash(slot_count);
+	}
+}
+
+} // namespace aoc
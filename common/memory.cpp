@@ -0,0 +1,203 @@
+#include "memory.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace aoc {
+namespace memory {
+
+namespace {
+
+// Fixed table, the hook can't allocate. Slot 0 (without a name) is for
+// allocations outside of any phase, the last one for every phase that didn't fit.
+static size_t const MAX_PHASES = 256;
+
+struct Slot {
+	std::atomic<char const*> name;
+	std::atomic<uint64_t> allocations;
+	std::atomic<uint64_t> bytes;
+	std::atomic<uint64_t> peak_live_bytes;
+};
+
+Slot slots[MAX_PHASES];
+std::atomic<size_t> slot_count(1);
+std::mutex slots_mutex; // for adding slots
+
+std::atomic<bool> is_hooked(false);
+std::atomic<uint64_t> allocations(0);
+std::atomic<uint64_t> frees(0);
+std::atomic<uint64_t> bytes(0);
+std::atomic<uint64_t> live_bytes(0);
+std::atomic<uint64_t> peak_live_bytes(0);
+
+thread_local size_t current_phase = 0;
+
+void update_max(std::atomic<uint64_t>& max, uint64_t value) {
+	uint64_t seen = max.load(std::memory_order_relaxed);
+	while (value > seen && !max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+	}
+}
+
+size_t find_slot(char const* name) {
+	// same literal, no lock needed: slots are never changed once counted
+	size_t count = slot_count.load(std::memory_order_acquire);
+	for (size_t i = 1; i < count; ++i) {
+		if (slots[i].name.load(std::memory_order_relaxed) == name) {
+			return i;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(slots_mutex);
+	count = slot_count.load(std::memory_order_relaxed);
+	for (size_t i = 1; i < count; ++i) {
+		if (std::strcmp(slots[i].name.load(std::memory_order_relaxed), name) == 0) {
+			return i;
+		}
+	}
+	if (count == MAX_PHASES - 1) {
+		slots[count].name = "(other phases)";
+		slot_count.store(count + 1, std::memory_order_release);
+		return count;
+	}
+	if (count == MAX_PHASES) {
+		return MAX_PHASES - 1;
+	}
+	slots[count].name = name;
+	slot_count.store(count + 1, std::memory_order_release);
+	return count;
+}
+
+std::string format_bytes(uint64_t n) {
+	static char const* const UNITS[] = {"B", "KB", "MB", "GB"};
+	double value = double(n);
+	size_t unit = 0;
+	while (value >= 1024.0 && unit < 3) {
+		value /= 1024.0;
+		++unit;
+	}
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(unit ? 1 : 0) << value << ' ' << UNITS[unit];
+	return ss.str();
+}
+
+} // namespace
+
+bool hooked(void) {
+	return is_hooked.load(std::memory_order_relaxed);
+}
+
+Totals totals(void) {
+	return Totals {
+		allocations.load(std::memory_order_relaxed),
+		frees.load(std::memory_order_relaxed),
+		bytes.load(std::memory_order_relaxed),
+		live_bytes.load(std::memory_order_relaxed),
+		peak_live_bytes.load(std::memory_order_relaxed)
+	};
+}
+
+std::vector<PhaseStats> phases(void) {
+	std::vector<PhaseStats> stats;
+	size_t count = slot_count.load(std::memory_order_acquire);
+	for (size_t i = 0; i < count; ++i) {
+		Slot const& s = slots[i];
+		uint64_t n = s.allocations.load(std::memory_order_relaxed);
+		if (n == 0) {
+			continue ;
+		}
+		char const* name = s.name.load(std::memory_order_relaxed);
+		stats.push_back({
+			name ? name : "(no phase)", n,
+			s.bytes.load(std::memory_order_relaxed),
+			s.peak_live_bytes.load(std::memory_order_relaxed)
+		});
+	}
+	return stats;
+}
+
+size_t peak_rss_kb(void) {
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.compare(0, 6, "VmHWM:") == 0) {
+			return std::strtoul(line.c_str() + 6, nullptr, 10);
+		}
+	}
+	return 0;
+}
+
+void report(std::ostream& out) {
+	Totals t = totals();
+	size_t rss_kb = peak_rss_kb();
+	out << "memory: " << t.allocations << " allocations, " << format_bytes(t.bytes) << " allocated, peak live "
+		<< format_bytes(t.peak_live_bytes) << ", peak RSS " << (rss_kb ? format_bytes(rss_kb * 1024) : "unknown") << '\n';
+
+	out << std::left << std::setw(24) << "phase" << std::right
+		<< std::setw(12) << "allocs" << std::setw(12) << "bytes" << std::setw(12) << "peak live" << '\n';
+	for (auto const& p : phases()) {
+		out << std::left << std::setw(24) << p.name << std::right
+			<< std::setw(12) << p.allocations
+			<< std::setw(12) << format_bytes(p.bytes)
+			<< std::setw(12) << format_bytes(p.peak_live_bytes) << '\n';
+	}
+}
+
+ScopedPhase::ScopedPhase(char const* name) : previous(current_phase) {
+	current_phase = find_slot(name);
+}
+
+ScopedPhase::~ScopedPhase() {
+	current_phase = previous;
+}
+
+namespace detail {
+
+void record_allocation(size_t n) {
+	uint64_t live = live_bytes.fetch_add(n, std::memory_order_relaxed) + n;
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	bytes.fetch_add(n, std::memory_order_relaxed);
+	update_max(peak_live_bytes, live);
+
+	Slot& s = slots[current_phase];
+	s.allocations.fetch_add(1, std::memory_order_relaxed);
+	s.bytes.fetch_add(n, std::memory_order_relaxed);
+	update_max(s.peak_live_bytes, live);
+}
+
+void record_free(size_t n) {
+	live_bytes.fetch_sub(n, std::memory_order_relaxed);
+	frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void set_hooked(void) {
+	is_hooked.store(true, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+#ifdef AOC_MEMORY
+
+namespace {
+
+// Constructed before main(), so this runs after main() has returned
+struct ReportAtExit {
+	~ReportAtExit() {
+		if (hooked()) {
+			report(std::cerr);
+		}
+	}
+} report_at_exit;
+
+} // namespace
+
+#endif // AOC_MEMORY
+
+} // namespace memory
+} // namespace aoc
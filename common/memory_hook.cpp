@@ -0,0 +1,63 @@
+#include "memory.h"
+
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new and delete of the binary this is linked
+// into, to count every allocation (include/memory.h). Every block gets a
+// header with its size in front, so delete knows how many bytes are freed.
+// The array forms go through these.
+
+namespace {
+
+// keeps the pointers handed out aligned like the ones of malloc
+static size_t const HEADER = 16;
+
+struct MarkHooked {
+	MarkHooked() { aoc::memory::detail::set_hooked(); }
+} mark_hooked;
+
+void* allocate(size_t size) {
+	void* block = std::malloc(size + HEADER);
+	if (block == nullptr) {
+		return nullptr;
+	}
+	*static_cast<size_t*>(block) = size;
+	aoc::memory::detail::record_allocation(size);
+	return static_cast<char*>(block) + HEADER;
+}
+
+void release(void* p) {
+	if (p == nullptr) {
+		return ;
+	}
+	void* block = static_cast<char*>(p) - HEADER;
+	aoc::memory::detail::record_free(*static_cast<size_t*>(block));
+	std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+	void* p = allocate(size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept {
+	return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+	release(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	release(p);
+}
+
+void operator delete(void* p, std::nothrow_t const&) noexcept {
+	release(p);
+}
@@ -0,0 +1,84 @@
+#include "number_theory.h"
+
+namespace aoc {
+
+typedef __int128 int128_t;
+
+// x with (a * x) % m == 1, a and m have to be coprime
+static int128_t modular_inverse(int128_t a, int128_t m) {
+	// extended Euclid, only tracking the coefficient of a
+	int128_t old_r = a, r = m;
+	int128_t old_s = 1, s = 0;
+	while (r != 0) {
+		int128_t q = old_r / r;
+		int128_t t = old_r - q * r; old_r = r; r = t;
+		t = old_s - q * s; old_s = s; s = t;
+	}
+	old_s %= m;
+	return old_s < 0 ? old_s + m : old_s;
+}
+
+// whether value is one of the values of c
+static bool in_cycle(uint64_t value, Cycle const& c) {
+	if (value < c.offset) {
+		return false;
+	}
+	return c.period == 0 ? value == c.offset : (value - c.offset) % c.period == 0;
+}
+
+bool combine_cycles(Cycle const& a, Cycle const& b, Cycle& out) {
+	if (a.period == 0 || b.period == 0) {
+		Cycle const& single = (a.period == 0) ? a : b;
+		Cycle const& other = (a.period == 0) ? b : a;
+		if (!in_cycle(single.offset, other)) {
+			return false;
+		}
+		out = {single.offset, 0};
+		return true;
+	}
+
+	// x = a.offset (mod a.period) and x = b.offset (mod b.period)
+	// has a solution only if the offsets agree modulo the gcd
+	uint64_t g = gcd(a.period, b.period);
+	int128_t diff = int128_t(b.offset) - int128_t(a.offset);
+	if (diff % int128_t(g) != 0) {
+		return false;
+	}
+	uint64_t period;
+	if (!checked_lcm(a.period, b.period, period)) {
+		return false;
+	}
+
+	// a.offset + a.period * k = b.offset (mod b.period), solve for k
+	int128_t m = b.period / g;
+	int128_t k = ((diff / int128_t(g)) % m + m) % m;
+	k = (k * modular_inverse(int128_t(a.period / g) % m, m)) % m;
+	int128_t x = (int128_t(a.offset) + int128_t(a.period) * k) % int128_t(period);
+
+	// the first meeting that is in both (x can still be before their offsets)
+	int128_t first = (a.offset > b.offset) ? a.offset : b.offset;
+	if (x < first) {
+		x += ((first - x + period - 1) / period) * period;
+	}
+	if (x > int128_t(std::numeric_limits<uint64_t>::max())) {
+		return false;
+	}
+	out = {uint64_t(x), period};
+	return true;
+}
+
+bool combine_cycles(std::vector<Cycle> const& cycles, Cycle& out) {
+	if (cycles.empty()) {
+		return false;
+	}
+	Cycle combined = cycles.front();
+	for (size_t i = 1; i < cycles.size(); ++i) {
+		if (!combine_cycles(combined, cycles[i], combined)) {
+			return false;
+		}
+	}
+	out = combined;
+	return true;
+}
+
+} // namespace aoc
@@ -0,0 +1,60 @@
+#include "parallel.h"
+#include "thread_pool.h"
+
+#include <exception>
+
+namespace aoc {
+
+size_t parallel_threads(void) {
+	return ThreadPool::global().size();
+}
+
+std::vector<StringView> split_lines(StringView buffer, size_t max_chunks, size_t min_bytes) {
+	size_t chunk_count = std::max<size_t>(1, std::min(max_chunks, buffer.size() / std::max<size_t>(1, min_bytes)));
+	size_t target = buffer.size() / chunk_count;
+
+	std::vector<StringView> chunks;
+	char const* begin = buffer.begin();
+	char const* end = buffer.end();
+	while (chunks.size() + 1 < chunk_count && begin != end) {
+		// cut after the first line end past the target size
+		char const* cut = begin + std::min<size_t>(target, end - begin);
+		while (cut != end && cut[-1] != '\n') {
+			++cut;
+		}
+		chunks.push_back(StringView(begin, cut));
+		begin = cut;
+	}
+	if (begin != end || chunks.empty()) {
+		chunks.push_back(StringView(begin, end));
+	}
+	return chunks;
+}
+
+void run_parallel(size_t n, std::function<void(size_t)> const& fn) {
+	std::vector<std::exception_ptr> errors(n);
+	auto run = [&](size_t i) {
+		try {
+			fn(i);
+		} catch (...) {
+			errors[i] = std::current_exception();
+		}
+	};
+
+	TaskGroup group;
+	for (size_t i = 1; i < n; ++i) {
+		group.spawn([&run, i]() { run(i); });
+	}
+	if (n > 0) {
+		run(0);
+	}
+	group.wait();
+
+	for (auto const& e : errors) {
+		if (e) {
+			std::rethrow_exception(e);
+		}
+	}
+}
+
+} // namespace aoc
@@ -0,0 +1,147 @@
+#include "parse_cache.h"
+#include "hash.h"
+#include "input.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace aoc {
+
+namespace {
+
+static char const MAGIC[8] = {'A', 'O', 'C', 'P', 'A', 'R', 'S', 'E'};
+// of the header and the containers of BinaryWriter, not of any day
+static uint32_t const FORMAT_VERSION = 1;
+
+struct Header {
+	char magic[8];
+	uint32_t format;
+	uint32_t day;
+	uint32_t version; // Solution::cache_version
+	uint32_t reserved;
+	uint64_t input_size;
+	uint64_t input_hash;
+	uint64_t payload_size;
+};
+
+Header make_header(Solution const& solution, StringView input, uint64_t input_hash, uint64_t payload_size) {
+	Header header;
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.format = FORMAT_VERSION;
+	header.day = uint32_t(solution.day);
+	header.version = solution.cache_version;
+	header.reserved = 0;
+	header.input_size = input.size();
+	header.input_hash = input_hash;
+	header.payload_size = payload_size;
+	return header;
+}
+
+// Parsed data out of a cache file, nullptr if it isn't one for this input
+Solution::parsed_t load(Solution const& solution, std::string const& path, StringView input, uint64_t input_hash) {
+	Input file;
+	try {
+		file = Input::from_file(path);
+	} catch (std::exception const&) {
+		return nullptr; // not cached yet
+	}
+
+	Header expected = make_header(solution, input, input_hash, 0);
+	Header header;
+	if (file.size() < sizeof(Header)) {
+		return nullptr;
+	}
+	std::memcpy(&header, file.data(), sizeof(Header));
+	expected.payload_size = header.payload_size;
+	if (std::memcmp(&header, &expected, sizeof(Header)) != 0 ||
+		header.payload_size != file.size() - sizeof(Header)) {
+		return nullptr;
+	}
+
+	try {
+		BinaryReader reader(file.view().substr(sizeof(Header)));
+		Solution::parsed_t parsed = solution.load(reader);
+		return reader.at_end() ? parsed : nullptr;
+	} catch (std::exception const&) {
+		return nullptr; // corrupted, parse it again
+	}
+}
+
+// Written next to path first and renamed, so a reader never sees half a file
+void store(Solution const& solution, std::string const& path, StringView input, uint64_t input_hash,
+		   void const* parsed) {
+	static std::atomic<unsigned> counter(0);
+
+	BinaryWriter writer;
+	writer.write(Header());
+	solution.save(parsed, writer);
+	Header header = make_header(solution, input, input_hash, writer.bytes.size() - sizeof(Header));
+	std::memcpy(&writer.bytes[0], &header, sizeof(Header));
+
+	std::string tmp = path + ".tmp" + std::to_string(::getpid()) + '-' + std::to_string(counter++);
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		out.write(writer.bytes.data(), writer.bytes.size());
+		if (!out) {
+			std::cerr << "warning: can't write parse cache \"" << tmp << "\"\n";
+			std::remove(tmp.c_str());
+			return ;
+		}
+	}
+	if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+		std::cerr << "warning: can't write parse cache \"" << path << "\"\n";
+		std::remove(tmp.c_str());
+	}
+}
+
+} // namespace
+
+uint64_t content_hash(StringView input) {
+	return hash_bytes(input.data(), input.size());
+}
+
+ParseCache ParseCache::from_env(void) {
+	char const* dir = std::getenv("AOC_CACHE_DIR");
+	return ParseCache(dir ? dir : "");
+}
+
+std::string ParseCache::path_of(int day, uint64_t input_hash) const {
+	char name[64];
+	std::snprintf(name, sizeof(name), "/day%02d-%016llx.bin", day, (unsigned long long)input_hash);
+	return dir + name;
+}
+
+Solution::parsed_t ParseCache::parse(Solution const& solution, StringView input, bool* hit) const {
+	if (hit) {
+		*hit = false;
+	}
+	if (!enabled() || solution.cache_version == 0) {
+		return solution.parse(input);
+	}
+
+	uint64_t input_hash = content_hash(input);
+	std::string path = path_of(solution.day, input_hash);
+	if (Solution::parsed_t parsed = load(solution, path, input, input_hash)) {
+		if (hit) {
+			*hit = true;
+		}
+		return parsed;
+	}
+
+	Solution::parsed_t parsed = solution.parse(input);
+	if (::mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST) {
+		std::cerr << "warning: can't create parse cache directory \"" << dir << "\"\n";
+		return parsed;
+	}
+	store(solution, path, input, input_hash, parsed.get());
+	return parsed;
+}
+
+} // namespace aoc
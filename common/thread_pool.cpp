@@ -0,0 +1,239 @@
+#include "thread_pool.h"
+
+#include <cstdlib>
+#include <iterator>
+#include <string>
+
+namespace aoc {
+
+namespace {
+
+// Which pool (and which worker of it) the current thread is, nullptr if it
+// isn't a worker
+thread_local ThreadPool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads) : queued(0), next_queue(0), pending(0), stopping(false) {
+	if (threads == 0) {
+		threads = 1;
+	}
+	for (size_t i = 0; i < threads; ++i) {
+		queues.emplace_back(new Queue());
+	}
+	workers.reserve(threads);
+	for (size_t i = 0; i < threads; ++i) {
+		workers.emplace_back(&ThreadPool::work, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	task_added.notify_all();
+	for (auto& w : workers) {
+		w.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task, TaskGroup const* group) {
+	size_t index = (current_pool == this) ? current_index : next_queue++ % queues.size();
+	// counted before it's in a queue: once it is, a thief may run it (and
+	// count it as done) right away
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		++pending;
+		++queued;
+	}
+	{
+		std::lock_guard<std::mutex> lock(queues[index]->mutex);
+		queues[index]->tasks.push_back({std::move(task), group});
+	}
+	task_added.notify_one();
+}
+
+void ThreadPool::wait(void) {
+	std::unique_lock<std::mutex> lock(mutex);
+	tasks_done.wait(lock, [this]() { return pending == 0; });
+}
+
+// Newest task of the own queue, otherwise the oldest one of another queue.
+// With a group only tasks of that group are taken.
+bool ThreadPool::pop(std::function<void()>& task, TaskGroup const* group) {
+	if (queued == 0) {
+		return false;
+	}
+	auto take = [&](std::deque<Task>& tasks, std::deque<Task>::iterator it) {
+		task = std::move(it->fn);
+		tasks.erase(it);
+		--queued;
+		return true;
+	};
+	size_t self = (current_pool == this) ? current_index : 0;
+	if (current_pool == this) {
+		Queue& q = *queues[self];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		for (auto it = q.tasks.rbegin(); it != q.tasks.rend(); ++it) {
+			if (!group || it->group == group) {
+				return take(q.tasks, std::next(it).base());
+			}
+		}
+	}
+	for (size_t i = 0; i < queues.size(); ++i) {
+		Queue& q = *queues[(self + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		for (auto it = q.tasks.begin(); it != q.tasks.end(); ++it) {
+			if (!group || it->group == group) {
+				return take(q.tasks, it);
+			}
+		}
+	}
+	return false;
+}
+
+void ThreadPool::run(std::function<void()>& task) {
+	task();
+	task = nullptr;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (--pending == 0) {
+		tasks_done.notify_all();
+	}
+}
+
+bool ThreadPool::run_pending_task(TaskGroup const* group) {
+	std::function<void()> task;
+	if (!pop(task, group)) {
+		return false;
+	}
+	run(task);
+	return true;
+}
+
+void ThreadPool::work(size_t index) {
+	current_pool = this;
+	current_index = index;
+
+	std::function<void()> task;
+	for (;;) {
+		if (pop(task, nullptr)) {
+			run(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		task_added.wait(lock, [this]() { return stopping || queued != 0; });
+		if (stopping && queued == 0) {
+			return ;
+		}
+	}
+}
+
+size_t ThreadPool::default_thread_count(void) {
+	if (char const* env = std::getenv("AOC_THREADS")) {
+		long n = std::strtol(env, nullptr, 10);
+		if (n > 0) {
+			return size_t(n);
+		}
+	}
+	size_t n = std::thread::hardware_concurrency();
+	return n == 0 ? 1 : n;
+}
+
+static std::unique_ptr<ThreadPool>& global_pool(void) {
+	static std::unique_ptr<ThreadPool> pool;
+	return pool;
+}
+
+static std::mutex global_mutex;
+
+ThreadPool& ThreadPool::global(void) {
+	std::lock_guard<std::mutex> lock(global_mutex);
+	auto& pool = global_pool();
+	if (!pool) {
+		pool.reset(new ThreadPool(default_thread_count()));
+	}
+	return *pool;
+}
+
+void ThreadPool::set_global_threads(size_t threads) {
+	std::lock_guard<std::mutex> lock(global_mutex);
+	auto& pool = global_pool();
+	if (!pool || pool->size() != std::max<size_t>(threads, 1)) {
+		pool.reset(); // joins the old workers first
+		pool.reset(new ThreadPool(threads));
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Task Group                                 */
+/* -------------------------------------------------------------------------- */
+
+TaskGroup::~TaskGroup() {
+	help_until_done();
+}
+
+void TaskGroup::spawn(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		++pending;
+	}
+	pool.submit([this, task]() {
+		std::exception_ptr e;
+		try {
+			task();
+		} catch (...) {
+			e = std::current_exception();
+		}
+		// the waiter may destroy the group as soon as the lock is released
+		std::lock_guard<std::mutex> lock(mutex);
+		if (e && !error) {
+			error = e;
+		}
+		if (--pending == 0) {
+			changed.notify_all();
+		}
+	}, this);
+
+	// only once it's queued, a waiter woken before couldn't take it
+	std::lock_guard<std::mutex> lock(mutex);
+	++spawned;
+	changed.notify_all();
+}
+
+// Runs queued tasks of the group while there are any, then sleeps until the
+// ones running elsewhere are done or spawn more
+void TaskGroup::help_until_done(void) {
+	for (;;) {
+		size_t seen;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (pending == 0) {
+				return ;
+			}
+			seen = spawned;
+		}
+		if (pool.run_pending_task(this)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [this, seen]() { return pending == 0 || spawned != seen; });
+	}
+}
+
+void TaskGroup::wait(void) {
+	help_until_done();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (error) {
+		std::exception_ptr e = error;
+		error = nullptr;
+		std::rethrow_exception(e);
+	}
+}
+
+} // namespace aoc
@@ -0,0 +1,111 @@
+#include "trace.h"
+
+#ifdef AOC_TRACE
+
+# include <chrono>
+# include <cstdio>
+# include <cstdlib>
+# include <mutex>
+# include <vector>
+
+namespace aoc {
+namespace trace {
+
+namespace {
+
+struct Event {
+	char const* name;
+	char phase; // 'X' slice, 'C' counter
+	uint64_t ts_ns;
+	uint64_t dur_ns;
+	int64_t value;
+};
+
+// Only ever written by its own thread. Buffers outlive their threads, they
+// are owned by the Registry and written out at exit.
+struct ThreadBuffer {
+	size_t tid;
+	std::vector<Event> events;
+};
+
+struct Registry {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::mutex mutex; // only taken once per thread and at exit
+	std::vector<ThreadBuffer*> buffers;
+
+	~Registry() {
+		write();
+		for (auto* b : buffers) {
+			delete b;
+		}
+	}
+
+	ThreadBuffer* add_thread(void) {
+		std::lock_guard<std::mutex> lock(mutex);
+		buffers.push_back(new ThreadBuffer{buffers.size() + 1, {}});
+		buffers.back()->events.reserve(1024);
+		return buffers.back();
+	}
+
+	void write(void) {
+		std::lock_guard<std::mutex> lock(mutex);
+		char const* path = std::getenv("AOC_TRACE_FILE");
+		if (path == nullptr || *path == '\0') {
+			path = "aoc_trace.json";
+		}
+		std::FILE* out = std::fopen(path, "w");
+		if (out == nullptr) {
+			std::fprintf(stderr, "Can't write trace to \"%s\"\n", path);
+			return ;
+		}
+
+		std::fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+		char const* separator = "\n";
+		for (auto const* b : buffers) {
+			for (auto const& e : b->events) {
+				// timestamps are in microseconds
+				if (e.phase == 'X') {
+					std::fprintf(out, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %zu, "
+						"\"ts\": %.3f, \"dur\": %.3f}", separator, e.name, b->tid, e.ts_ns / 1e3, e.dur_ns / 1e3);
+				} else {
+					std::fprintf(out, "%s{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"tid\": %zu, "
+						"\"ts\": %.3f, \"args\": {\"value\": %lld}}", separator, e.name, b->tid, e.ts_ns / 1e3,
+						static_cast<long long>(e.value));
+				}
+				separator = ",\n";
+			}
+		}
+		std::fprintf(out, "\n]}\n");
+		std::fclose(out);
+	}
+};
+
+Registry& registry(void) {
+	static Registry r;
+	return r;
+}
+
+ThreadBuffer& thread_buffer(void) {
+	static thread_local ThreadBuffer* buffer = registry().add_thread();
+	return *buffer;
+}
+
+} // namespace
+
+uint64_t now(void) {
+	auto elapsed = std::chrono::steady_clock::now() - registry().start;
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+void record_slice(char const* name, uint64_t begin_ns, uint64_t end_ns) {
+	thread_buffer().events.push_back({name, 'X', begin_ns, end_ns - begin_ns, 0});
+}
+
+void record_counter(char const* name, int64_t value) {
+	thread_buffer().events.push_back({name, 'C', now(), 0, value});
+}
+
+} // namespace trace
+} // namespace aoc
+
+#endif // AOC_TRACE
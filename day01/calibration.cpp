@@ -1,11 +1,14 @@
 #include "common.h"
+#include "parallel.h"
 
 #include <unordered_map>
 #include <numeric>
 
+namespace day01 {
+
 // This map will help connect a value to the words and will also provide
 // a handy 'list' to iterate through
-static std::unordered_map<std::string, uint64_t> digit_map {
+static std::unordered_map<std::string, uint64_t> const digit_map {
 	{"zero", 0},
 	{"one", 1},
 	{"two", 2},
@@ -18,9 +21,9 @@ static std::unordered_map<std::string, uint64_t> digit_map {
 	{"nine", 9},
 };
 
-uint64_t get_first_digit(std::string const& line) {
+uint64_t get_first_digit(aoc::StringView line) {
 	uint64_t digit = 0;
-	size_t pos = std::string::npos;
+	size_t pos = aoc::StringView::npos;
 
 	// first occurence of an actual digit
 	for (size_t i = 0; i < line.length(); ++i) {
@@ -43,14 +46,14 @@ uint64_t get_first_digit(std::string const& line) {
 	return digit;
 }
 
-uint64_t get_last_digit(std::string const& line) {
+uint64_t get_last_digit(aoc::StringView line) {
 	// Very similar to get_first_digit, just reversed
 	uint64_t digit = 0;
 	size_t pos = 0;
 
-	// the length + 1 and [i - 1] are to make sure we don't have to make the conditon 'i >= 0'
+	// the [i - 1] is to make sure we don't have to make the conditon 'i >= 0'
 	// which would cause an underflow and an infinite loop
-	for (size_t i = line.length() + 1; i > 0; --i) {
+	for (size_t i = line.length(); i > 0; --i) {
 		if (std::isdigit(line[i - 1])) {
 			digit = line[i - 1] - '0';
 			pos = i - 1;
@@ -62,7 +65,7 @@ uint64_t get_last_digit(std::string const& line) {
 	// did have to specifically exclude npos, because that's always higher and returned on 'not found'
 	for (auto const& pair : digit_map) {
 		size_t found = line.rfind(pair.first);
-		if (found != std::string::npos && found > pos) {
+		if (found != aoc::StringView::npos && found > pos) {
 			pos = found;
 			digit = pair.second;
 		}
@@ -70,14 +73,15 @@ uint64_t get_last_digit(std::string const& line) {
 	return digit;
 }
 
-uint64_t get_sum(std::istream& stream) {
-	// Iterate through the entire document line by line and sum up
+uint64_t sum_lines(aoc::StringView input) {
+	// Iterate through the (part of the) document line by line and sum up
 	// their calibration values
 
 #if (0)
-	// A relatively simple way to iterate over lines in a stream
+	// A relatively simple way to iterate over lines in a buffer
 	uint64_t sum = 0;
-	for (std::string line; std::getline(stream, line); ) {
+	for (aoc::StringView line; !input.empty(); ) {
+		line = aoc::next_line(input);
 		sum += get_first_digit(line) * 10 + get_last_digit(line);
 	}
 	return sum;
@@ -85,7 +89,7 @@ uint64_t get_sum(std::istream& stream) {
 	// A range-based approach with a custom iterator to iterate of the lines
 	// this approach is more "C++"-esque
 	uint64_t sum = 0;
-	for (auto& line : aoc::Lines(stream)) {
+	for (auto line : aoc::ViewLines(input)) {
 		sum += get_first_digit(line) * 10 + get_last_digit(line);
 	}
 	return sum;
@@ -95,20 +99,50 @@ uint64_t get_sum(std::istream& stream) {
 	// A lamba to define how to sum the values.
 	// And the use of the STL function std::accumulate.
 	// However, this is imo quite overkill for simple problems.
-	auto add = [](uint64_t n, std::string line) {
+	auto add = [](uint64_t n, aoc::StringView line) {
 		return n + get_first_digit(line) * 10 + get_last_digit(line);
 	};
 
-	aoc::Lines l(stream);
+	aoc::ViewLines l(input);
 	return std::accumulate(l.begin(), l.end(), uint64_t(0), add);
 #endif
 }
 
+uint64_t get_sum(aoc::StringView input) {
+	// Every line is on its own, so chunks of them are summed on every core
+	return aoc::parallel_lines(input, sum_lines, std::plus<uint64_t>());
+}
+
+// There isn't much to parse, get_sum goes through the input in one pass
+aoc::StringView parse_document(aoc::StringView input) {
+	aoc::ScopedTimer timer("day01 parse");
+	return input;
+}
+
+uint64_t sum_calibration(aoc::StringView const& document) {
+	aoc::ScopedTimer timer("day01 part1");
+	return get_sum(document);
+}
+
+aoc::Solution solution() {
+	return aoc::make_solution(1, "calibration", parse_document, sum_calibration);
+}
+
+} // namespace day01
+
+#ifndef AOC_NO_MAIN
 int	main(int argc, char **argv) {
-	auto input = aoc::get_input(argc, argv);
-	uint64_t sum = get_sum(*input);
+	using namespace day01;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
+	uint64_t sum = get_sum(input.view());
 
 	std::cout << "Sum of all calibration values: " << sum << std::endl;
 	
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
@@ -1,11 +1,12 @@
 #include "common.h"
+#include "parallel.h"
 
 #include <vector>
-#include <sstream>
-#include <unordered_map>
 
-// Easier parsing by creating a locale
-static auto const LOCALE = aoc::create_delimitor_locale<':', ',', ';'>();
+namespace day02 {
+
+// Easier parsing by skipping these
+static aoc::Charset const DELIMITERS(":,; ");
 
 struct Game {
 	// Could've gone with a hash-map based approach (I didn't bother)
@@ -13,19 +14,11 @@ struct Game {
 	uint64_t green;
 	uint64_t blue;
 
-	uint64_t* get_color(std::string const& str) {
-		// For some reason I did go with a tiny hash-map here.
-		// Overhead is way too big for it's benefits, could easily just do 3 if-statements
-		static std::unordered_map<std::string, uint64_t&> const COLOR_BINDS {{
-			{"red", red},
-			{"green", green},
-			{"blue", blue}
-		}};
-
-		auto it = COLOR_BINDS.find(str);
-		if (it != COLOR_BINDS.end()) {
-			return &(it->second);
-		}
+	uint64_t* get_color(aoc::StringView str) {
+		// Used to be a tiny (static!) hash-map here, 3 if-statements do just fine
+		if (str == "red") return &red;
+		if (str == "green") return &green;
+		if (str == "blue") return &blue;
 		return nullptr; // unknown color
 	}
 
@@ -34,22 +27,21 @@ struct Game {
 	}
 };
 
-std::vector<Game> parse_games(std::istream& stream) {
+std::vector<Game> parse_chunk(aoc::StringView input) {
 	std::vector<Game> games;
-	for (auto line : aoc::Lines(stream)) {
+	for (auto line : aoc::ViewLines(input)) {
+
+		aoc::Scanner sc(line);
 
-		// Imbuing streams with a customized locale is pretty cool
-		std::istringstream ss(line); ss.imbue(LOCALE);
-		
 		Game game {0, 0, 0};
 		uint64_t x;
-		std::string color;
 
 		// Skip "Game x"
-		ss >> aoc::next_digit >> x;
+		sc.next_int(x);
 
 		// While we have a number-color pair
-		while (ss >> x >> color) {
+		while (sc.next_int(x)) {
+			aoc::StringView color = sc.next_token(DELIMITERS);
 			// get a ptr to the corresponding color-count integer within current game
 			auto* c = game.get_color(color);
 			if (!c) {
@@ -64,7 +56,14 @@ std::vector<Game> parse_games(std::istream& stream) {
 	return games;
 }
 
+std::vector<Game> parse_games(aoc::StringView input) {
+	aoc::ScopedTimer timer("day02 parse");
+	return aoc::parallel_lines(input, parse_chunk, aoc::concat<Game>);
+}
+
 uint64_t sum_games_id(std::vector<Game> const& games) {
+	aoc::ScopedTimer timer("day02 part1");
+
 	static Game const max_game {
 		.red = 12,
 		.green = 13,
@@ -84,17 +83,36 @@ uint64_t sum_games_id(std::vector<Game> const& games) {
 	return sum;
 }
 
+uint64_t sum_games_power(std::vector<Game> const& games) {
+	aoc::ScopedTimer timer("day02 part2");
+	return aoc::sum<uint64_t>(games, &Game::power);
+}
+
+aoc::Solution solution() {
+	return aoc::make_solution(2, "cubes", parse_games, sum_games_id, sum_games_power);
+}
+
+} // namespace day02
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto file = aoc::get_input_file(argc, argv);
+	using namespace day02;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
-	std::vector<Game> games = parse_games(file);
+	std::vector<Game> games = parse_games(input.view());
 
 	std::cout << "(part 1) Sum of IDs of games:   "
 		<< sum_games_id(games)
 		<< std::endl;
 	std::cout << "(part 2) Sum of power of games: "
-		<< aoc::sum<uint64_t>(games, &Game::power)
+		<< sum_games_power(games)
 		<< std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
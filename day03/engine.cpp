@@ -1,43 +1,51 @@
 #include "common.h"
+#include "grid.h"
+#include "parse_cache.h"
 
 #include <vector>
 #include <algorithm>
 
+namespace day03 {
+
 bool is_symbol(char c) {
 	return (!std::isdigit(c) && c != '.');
 }
 
-bool is_adjacent(std::vector<std::string> const& schematic, size_t x, size_t y) {
-	bool adjacent = false;
+// Bordered with '.', so every cell in the schematic has 8 valid neighbours
+using schematic_t = Grid<char>;
 
-	size_t x_max = std::min(x + 2, (size_t)schematic[0].length());
-	size_t y_max = std::min(y + 2, (size_t)schematic.size());
-	size_t x_start = (x > 0) ? x - 1 : x;
-	size_t y_start = (y > 0) ? y - 1 : y;
+bool is_adjacent(schematic_t const& schematic, size_t i) {
+	bool adjacent = false;
 
-	for (y = y_start; y < y_max; ++y) {
-		for (x = x_start; x < x_max; ++x) {
-			adjacent |= is_symbol(schematic[y][x]);
-		}
+	// row holds the index of the cell directly above, at and below i
+	for (size_t row = i - schematic.stride(); row <= i + schematic.stride(); row += schematic.stride()) {
+		adjacent |= is_symbol(schematic[row - 1]);
+		adjacent |= is_symbol(schematic[row]);
+		adjacent |= is_symbol(schematic[row + 1]);
 	}
 
 	return adjacent;
 }
 
 // Part 1
-uint64_t sum_parts(std::vector<std::string> const& schematic) {
+uint64_t sum_parts(schematic_t const& schematic) {
+	aoc::ScopedTimer timer("day03 part1");
+
 	uint64_t sum = 0;
-	for (size_t y = 0; y < schematic.size(); ++y) {
-		for (size_t x = 0; x < schematic[0].length(); ++x) {
-			if (std::isdigit(schematic[y][x])) {
+	for (int64_t y = 0; y < schematic.height(); ++y) {
+		size_t i = schematic.index(0, y);
+		size_t const row_end = i + schematic.width();
+		for (; i < row_end; ++i) {
+			if (std::isdigit(schematic[i])) {
 				// parse and check number
 				bool adjacent = false;
 				uint64_t n = 0;
 				// A simple unsigned parse without overflow check, combined with adjacent check
-				while (std::isdigit(schematic[y][x]) && schematic[0].length()) {
-					adjacent |= is_adjacent(schematic, x, y);
-					n = (n * 10) + (schematic[y][x] - '0');
-					++x;
+				// (the border stops it at the end of the row)
+				while (std::isdigit(schematic[i])) {
+					adjacent |= is_adjacent(schematic, i);
+					n = (n * 10) + (schematic[i] - '0');
+					++i;
 				}
 				if (adjacent) {
 					sum += n;
@@ -48,38 +56,33 @@ uint64_t sum_parts(std::vector<std::string> const& schematic) {
 	return sum;
 }
 
-uint64_t parse_n(std::string const& line, size_t x) {
+uint64_t parse_n(schematic_t const& schematic, size_t i) {
 	uint64_t n = 0;
 	// Go all the way to the start of the number
-	while (x > 0 && std::isdigit(line[x - 1])) {
-		--x;
+	while (std::isdigit(schematic[i - 1])) {
+		--i;
 	}
 	// simple unsigned integer parse (without overflow check)
-	while (std::isdigit(line[x]) && x < line.length()) {
-		n = (n * 10) + line[x] - '0';
-		++x;
+	while (std::isdigit(schematic[i])) {
+		n = (n * 10) + schematic[i] - '0';
+		++i;
 	}
 	return n;
 }
 
-uint64_t calculate_ratio(std::vector<std::string> const& schematic, size_t x, size_t y) {
+uint64_t calculate_ratio(schematic_t const& schematic, size_t i) {
 	uint64_t ratio = 1;
 	uint64_t count = 0;
-	
-	size_t x_max = std::min(x + 2, (size_t)schematic[0].length());
-	size_t y_max = std::min(y + 2, (size_t)schematic.size());
-	size_t x_start = (x > 0) ? x - 1 : x;
-	size_t y_start = (y > 0) ? y - 1 : y;
-
-	for (y = y_start; y < y_max; ++y) {
-		for (x = x_start; x < x_max; ++x) {
-			if (std::isdigit(schematic[y][x])) {
+
+	for (size_t row = i - schematic.stride(); row <= i + schematic.stride(); row += schematic.stride()) {
+		for (size_t x = row - 1; x <= row + 1; ++x) {
+			if (std::isdigit(schematic[x])) {
 				// If we found a number, parse and multiply
-				ratio *= parse_n(schematic[y], x);
+				ratio *= parse_n(schematic, x);
 				++count;
 
 				// skip digits that have already been parsed
-				while (std::isdigit(schematic[y][x])) {
+				while (std::isdigit(schematic[x])) {
 					++x;
 				}
 			}
@@ -94,12 +97,14 @@ uint64_t calculate_ratio(std::vector<std::string> const& schematic, size_t x, si
 }
 
 // Part 2
-uint64_t sum_gears(std::vector<std::string> const& schematic) {
+uint64_t sum_gears(schematic_t const& schematic) {
+	aoc::ScopedTimer timer("day03 part2");
+
 	uint64_t sum = 0;
-	for (size_t y = 0; y < schematic.size(); ++y) {
-		for (size_t x = 0; x < schematic[0].length(); ++x) {
-			if (schematic[y][x] == '*') {
-				uint64_t ratio = calculate_ratio(schematic, x, y);
+	for (int64_t y = 0; y < schematic.height(); ++y) {
+		for (size_t i = schematic.index(0, y); i < schematic.index(schematic.width(), y); ++i) {
+			if (schematic[i] == '*') {
+				uint64_t ratio = calculate_ratio(schematic, i);
 				sum += ratio;
 			}
 		}
@@ -107,28 +112,36 @@ uint64_t sum_gears(std::vector<std::string> const& schematic) {
 	return sum;
 }
 
-std::vector<std::string> parse_schematic(std::istream& input) {
-	std::vector<std::string> schematic;
-	for (auto& line : aoc::Lines(input)) {
-		schematic.emplace_back(std::move(line));
+schematic_t parse_schematic(aoc::StringView input) {
+	aoc::ScopedTimer timer("day03 parse");
 
-		// Bad error handling
-		if (line.length() != schematic[0].length()) {
-			throw std::runtime_error("bad schematic");
-		}
-	}
-	return schematic;
+	// throws on a non-rectangular schematic
+	return schematic_t::from_lines(input, 1, '.');
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(3, "engine", parse_schematic, sum_parts, sum_gears),
+		1, aoc::save_grid<char>, aoc::load_grid<char>);
 }
 
+} // namespace day03
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day03;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
 	// The schematic is basically a 2d-array
-	std::vector<std::string> schematic = parse_schematic(*input);
+	schematic_t schematic = parse_schematic(input.view());
 
 	std::cout << "(part 1) Sum of all parts is:       " << sum_parts(schematic) << std::endl;
 	std::cout << "(part 2) Sum of all gear ratios is: " << sum_gears(schematic) << std::endl;
 
 	return (EXIT_SUCCESS);
 }
-
+#endif // AOC_NO_MAIN
@@ -1,8 +1,10 @@
 #include "common.h"
+#include "parallel.h"
 
 #include <set>
 #include <vector>
-#include <sstream>
+
+namespace day04 {
 
 struct Scratchcard {
 	uint64_t amount;
@@ -31,29 +33,39 @@ struct Scratchcard {
 	}
 };
 
-std::vector<Scratchcard> parse_cards(std::istream& stream) {
+std::vector<Scratchcard> parse_chunk(aoc::StringView input) {
 	std::vector<Scratchcard> cards;
-	for (auto& line : aoc::Lines(stream)) {
-		std::istringstream ss(line);
+	for (auto line : aoc::ViewLines(input)) {
+		if (line.length() == 0) {
+			continue;
+		}
+
+		aoc::Scanner sc(line);
 
 		Scratchcard card;
 		card.amount = 1;
 
-		std::string word;
-		// skip "Card x"
-		ss >> aoc::next_digit >> word;
+		// skip "Card x:"
+		sc.next_int<uint64_t>();
+		sc.expect(":");
 
-		while (ss >> word && word[0] != '|') {
-			card.winning.emplace(std::stoull(word));
+		while (sc.skip_whitespace().peek() != '|' && !sc.done()) {
+			card.winning.emplace(sc.next_int<uint64_t>());
 		}
-		while (ss >> word) {
-			card.owned.emplace(std::stoull(word));
+		uint64_t n;
+		while (sc.next_int(n)) {
+			card.owned.emplace(n);
 		}
 		cards.emplace_back(std::move(card));
 	}
 	return cards;
 }
 
+std::vector<Scratchcard> parse_cards(aoc::StringView input) {
+	aoc::ScopedTimer timer("day04 parse");
+	return aoc::parallel_lines(input, parse_chunk, aoc::concat<Scratchcard>);
+}
+
 void process_copies(std::vector<Scratchcard>& cards) {
 	for (size_t i = 0; i < cards.size(); ++i) {
 		// The way you process how many copies you get is quite simple.
@@ -66,21 +78,56 @@ void process_copies(std::vector<Scratchcard>& cards) {
 	}
 }
 
+uint64_t sum_values(std::vector<Scratchcard> const& cards) {
+	aoc::ScopedTimer timer("day04 part1");
+
+	// The value of a card doesn't depend on the others (the copies in part 2 do)
+	return aoc::parallel_reduce(cards.size(), 4096, [&](size_t begin, size_t end) {
+		uint64_t sum = 0;
+		for (size_t i = begin; i < end; ++i) {
+			sum += cards[i].calculate_value();
+		}
+		return sum;
+	}, std::plus<uint64_t>());
+}
+
+uint64_t sum_amounts(std::vector<Scratchcard> const& cards) {
+	aoc::ScopedTimer timer("day04 part2");
+
+	// processing copies changes the amounts, so work on a copy
+	std::vector<Scratchcard> copies(cards);
+	process_copies(copies);
+	return aoc::sum<uint64_t>(copies, &Scratchcard::get_amount);
+}
+
+aoc::Solution solution() {
+	return aoc::make_solution(4, "scratchcard", parse_cards, sum_values, sum_amounts);
+}
+
+} // namespace day04
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day04;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
 	// While for part 1 you really don't need to store the parsed cards,
 	// part 2 becomes a lot easier if you do.
-	std::vector<Scratchcard> cards = parse_cards(*input);
+	std::vector<Scratchcard> cards = parse_cards(input.view());
 
 	std::cout << "(Part 1) Sum of scratchcard values:  "
-		<< aoc::sum<uint64_t>(cards, &Scratchcard::calculate_value)
+		<< sum_values(cards)
 		<< std::endl;
 
-	process_copies(cards);
 	std::cout << "(Part 2) Sum of scratchcard amounts: "
-		<< aoc::sum<uint64_t>(cards, &Scratchcard::get_amount)
+		<< sum_amounts(cards)
 		<< std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
@@ -1,95 +1,50 @@
 #include "common.h"
+#include "range.h"
+#include "parse_cache.h"
 
 #include <vector>
-#include <vector>
-#include <sstream>
-
-struct Range {
-	uint64_t begin;
-	uint64_t end;
-
-	Range() : begin(0), end(0) {}
-
-	Range(uint64_t begin, uint64_t end) : begin(begin), end(end) {}
-
-	operator bool() const {
-		return end > begin;
-	}
-
-	bool operator<(Range const& rhs) {
-		return begin < rhs.begin;
-	}
-
-	bool includes(uint64_t value) const {
-		if (value >= begin && value < end) {
-			return true;
-		}
-		return false;
-	}
-
-	Range intersect(Range const& other) const {
-		return Range(
-			std::max(begin, other.begin),
-			std::min(end, other.end)
-		);
-	}
-};
-
-struct Entry {
-	Range range;
-	uint64_t destination;
-};
 
-struct Map {
-	std::vector<Entry> entries;
+namespace day05 {
 
-	uint64_t process(uint64_t n) const {
-		for (auto const& e : entries) {
-			if (e.range.includes(n)) {
-				return e.destination + n - e.range.begin;
-			}
-		}
-		return n;
-	}
-};
+using Map = PiecewiseMap;
 
-std::vector<Range> parse_seeds(std::istream& stream) {
+// consumes the first line of input
+std::vector<Range> parse_seeds(aoc::StringView& input) {
 	std::vector<Range> seeds;
-	auto line = aoc::Lines(stream).begin();
-
-	std::stringstream ss(*line);
+	aoc::Scanner sc(aoc::next_line(input));
 	Range seed_range;
-	while (ss >> aoc::next_digit >> seed_range.begin >> seed_range.end) {
+	while (sc.next_int(seed_range.begin) && sc.next_int(seed_range.end)) {
 		seed_range.end += seed_range.begin;
 		seeds.push_back(seed_range);
 	}
 	return seeds;
 }
 
-std::vector<Map> parse_maps(std::istream& stream) {
+std::vector<Map> parse_maps(aoc::StringView input) {
 	std::vector<Map> maps;
 
-	Map map;
-	stream >> aoc::skip<'\n'> >> aoc::skip<'\n'>;
-	for (auto const& line : aoc::Lines(stream)) {
-		std::stringstream ss(line);
+	std::vector<Map::Piece> pieces;
+	aoc::next_line(input); aoc::next_line(input);
+	for (auto const& line : aoc::ViewLines(input)) {
 		if (line.length() == 0) {
 			continue;
 		}
 
 		// Only push if we are at the next map
-		if (!std::isdigit(ss.peek())) {
-			maps.push_back(map);
-			map = Map();
+		if (!std::isdigit(line[0])) {
+			maps.emplace_back(std::move(pieces));
+			pieces.clear();
 			continue; // skip
 		}
 
-		Entry entry;
-		ss >> entry.destination >> entry.range.begin >> entry.range.end;
-		entry.range.end += entry.range.begin;
-		map.entries.push_back(entry);
+		aoc::Scanner sc(line);
+		uint64_t destination, source, length;
+		sc.next_int(destination);
+		sc.next_int(source);
+		sc.next_int(length);
+		pieces.push_back({Range(source, source + length), int64_t(destination - source)});
 	}
-	maps.push_back(map);
+	maps.emplace_back(std::move(pieces));
 	return maps;
 }
 
@@ -103,62 +58,92 @@ std::vector<uint64_t> calculate_locations(std::vector<Range> const& seeds, std::
 	// This pretty much just traces each individual value to it's end locations
 	for (auto const& m : maps) {
 		for (auto& l : locations) {
-			l = m.process(l);
+			l = m(l);
 		}
 	}
 	return locations;
 }
 
-void process_seeds(std::vector<Range>& seeds, std::vector<Map> const& maps) {
-	for (auto& m : maps) {
-		std::vector<Range> next_seeds;
-		while (seeds.size() > 0) {
-			Range s(seeds.back()); seeds.pop_back();
-			bool used = false;
-			for (auto& e : m.entries) {
-				Range intersection(e.range.intersect(s));
-				if (intersection) {
-					// offset and add the intersection to the new seeds
-					next_seeds.emplace_back(
-						intersection.begin - e.range.begin + e.destination,
-						intersection.end - e.range.begin + e.destination
-					);
-					// Split off the left side of the intersection and process it again
-					if (intersection.begin > s.begin) {
-						seeds.emplace_back(s.begin, intersection.begin);
-					}
-					// Split off the right side of the intersection and process it again
-					if (s.end > intersection.end) {
-						seeds.emplace_back(intersection.end, s.end);
-					}
-					// The seed has been processed
-					used = true;
-					break ;
-				}
-			}
-			// There is only need to add the seed-range back into the pool if it has not been processed
-			if (!used) {
-				next_seeds.push_back(s);
-			}
-		}
-		// next seeds become the new seeds
-		seeds.swap(next_seeds);
+// Every map applied to the whole set at once, touching ranges are merged
+// after each map so the fragments don't pile up
+IntervalSet process_seeds(IntervalSet seeds, std::vector<Map> const& maps) {
+	for (auto const& m : maps) {
+		seeds = m.apply(seeds);
 	}
+	return seeds;
 }
 
+struct Almanac {
+	std::vector<Range> seeds;
+	std::vector<Map> maps;
+};
+
+Almanac parse_almanac(aoc::StringView input) {
+	aoc::ScopedTimer timer("day05 parse");
+
+	Almanac almanac;
+	almanac.seeds = parse_seeds(input);
+	almanac.maps = parse_maps(input);
+	return almanac;
+}
+
+// For the parse cache
+void save_almanac(aoc::BinaryWriter& out, Almanac const& almanac) {
+	out.write(almanac.seeds);
+	out.write<uint64_t>(almanac.maps.size());
+	for (auto const& m : almanac.maps) {
+		out.write(std::vector<Map::Piece>(m.begin(), m.end()));
+	}
+}
+
+Almanac load_almanac(aoc::BinaryReader& in) {
+	Almanac almanac;
+	in.read(almanac.seeds);
+	almanac.maps.resize(in.read<uint64_t>());
+	std::vector<Map::Piece> pieces;
+	for (auto& m : almanac.maps) {
+		in.read(pieces);
+		m = Map(std::move(pieces));
+	}
+	return almanac;
+}
+
+uint64_t lowest_location(Almanac const& almanac) {
+	aoc::ScopedTimer timer("day05 part1");
+
+	auto locations = calculate_locations(almanac.seeds, almanac.maps);
+	return *std::min_element(locations.begin(), locations.end());
+}
+
+uint64_t lowest_location_ranges(Almanac const& almanac) {
+	aoc::ScopedTimer timer("day05 part2");
+
+	IntervalSet seeds(almanac.seeds.begin(), almanac.seeds.end());
+	return process_seeds(seeds, almanac.maps).min();
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(5, "seed", parse_almanac, lowest_location, lowest_location_ranges),
+		1, save_almanac, load_almanac);
+}
+
+} // namespace day05
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day05;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
 
-	std::vector<Range> seeds = parse_seeds(*input);
-	std::vector<Map> maps = parse_maps(*input);
+	auto input = aoc::map_input(argc, argv);
 
-	auto locations = calculate_locations(seeds, maps);
-	std::cout << "(Part 1) Lowest location number: " <<
-		*std::min_element(locations.begin(), locations.end()) << std::endl;
+	Almanac almanac = parse_almanac(input.view());
 
-	process_seeds(seeds, maps);
-	std::cout << "(Part 2) Lowest location number: " <<
-		std::min_element(seeds.begin(), seeds.end())->begin << std::endl;
+	std::cout << "(Part 1) Lowest location number: " << lowest_location(almanac) << std::endl;
+	std::cout << "(Part 2) Lowest location number: " << lowest_location_ranges(almanac) << std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
@@ -1,9 +1,10 @@
 #include "common.h"
 
 #include <vector>
-#include <sstream>
 #include <cmath>
 
+namespace day06 {
+
 struct Race {
 	uint64_t time;
 	uint64_t distance;
@@ -71,48 +72,76 @@ struct Race {
 	}
 };
 
+// append the digits of n to concat: (12, 345) -> 12345
+uint64_t concat_digits(uint64_t concat, uint64_t n) {
+	uint64_t shift = 10;
+	while (shift <= n) {
+		shift *= 10;
+	}
+	return concat * shift + n;
+}
+
 // I personally usually prefer this over a std::pair
 using result_t = struct {
 	std::vector<Race> races;
 	Race big_race;
 };
-result_t parse_races(std::istream& stream) {
+result_t parse_races(aoc::StringView input) {
+	aoc::ScopedTimer timer("day06 parse");
+
 	result_t result;
-	std::string n;
-	std::string concat;
+	uint64_t n;
 
-	auto lines = aoc::Lines(stream).begin();
 	// The first line is time
-	std::stringstream ss(*lines);
-	while (ss >> aoc::next_digit >> n) {
-		result.races.emplace_back(std::stoull(n), 0);
-		concat += n;
+	aoc::Scanner sc(aoc::next_line(input));
+	while (sc.next_int(n)) {
+		result.races.emplace_back(n, 0);
+		result.big_race.time = concat_digits(result.big_race.time, n);
 	}
-	result.big_race.time = std::stoull(concat);
-	concat.clear();
 
 	// Second line is distance
-	++lines;
-	ss = std::stringstream(*lines);
+	sc = aoc::Scanner(aoc::next_line(input));
 	for (auto& r : result.races) {
-		ss >>  aoc::next_digit >> n;
-		r.distance = std::stoull(n);
-		concat += n;
+		sc.next_int(r.distance);
+		result.big_race.distance = concat_digits(result.big_race.distance, r.distance);
 	}
-	result.big_race.distance = std::stoull(concat);
 
 	return result;
 }
 
+uint64_t product_ways_to_beat(result_t const& result) {
+	aoc::ScopedTimer timer("day06 part1");
+	return aoc::product<uint64_t>(result.races, &Race::ways_to_beat);
+}
+
+uint64_t big_race_ways_to_beat(result_t const& result) {
+	aoc::ScopedTimer timer("day06 part2");
+	return result.big_race.ways_to_beat();
+}
+
+aoc::Solution solution() {
+	return aoc::make_solution(6, "race", parse_races, product_ways_to_beat, big_race_ways_to_beat);
+}
+
+} // namespace day06
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day06;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
-	auto result = parse_races(*input);
+	auto result = parse_races(input.view());
 
 	std::cout << "(Part 1) Product of ways to beat: "
-		<< aoc::product<uint64_t>(result.races, &Race::ways_to_beat)
+		<< product_ways_to_beat(result)
 		<< std::endl;
-	std::cout << "(Part 2) ways to beat big race:   " << result.big_race.ways_to_beat() << std::endl;
+	std::cout << "(Part 2) ways to beat big race:   " << big_race_ways_to_beat(result) << std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
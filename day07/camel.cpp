@@ -1,9 +1,11 @@
 #include "common.h"
+#include "parallel.h"
 
 #include <unordered_map>
 #include <set>
 #include <vector>
-#include <sstream>
+
+namespace day07 {
 
 static std::unordered_map<char, uint64_t> const PART1_VALUE_MAP = {
 	{'A', 0},
@@ -37,8 +39,6 @@ static std::unordered_map<char, uint64_t> const PART2_VALUE_MAP = {
 	{'J', 13} // Joker now weakest value
 };
 
-static auto const* CARD_VALUE_MAP = &PART1_VALUE_MAP;
-
 enum class Type {
 	FIVE_OF_A_KIND = 0,
 	FOUR_OF_A_KIND,
@@ -98,12 +98,16 @@ struct Hand {
 	uint64_t bid;
 	std::string cards;
 	Type type;
+};
 
-	// less-than operator for easy sorting
-	bool operator<(Hand const& rhs) const {
-		if (type == rhs.type) {
-			for (size_t i = 0; i < cards.length(); ++i) {
-				int64_t diff = CARD_VALUE_MAP->at(cards[i]) - CARD_VALUE_MAP->at(rhs.cards[i]);
+// less-than comparison for easy sorting, card values differ per part
+struct HandLess {
+	std::unordered_map<char, uint64_t> const& card_values;
+
+	bool operator()(Hand const& lhs, Hand const& rhs) const {
+		if (lhs.type == rhs.type) {
+			for (size_t i = 0; i < lhs.cards.length(); ++i) {
+				int64_t diff = card_values.at(lhs.cards[i]) - card_values.at(rhs.cards[i]);
 				if (diff < 0) {
 					return true;
 				// Was stuck on this for 20 minutes because I put >=
@@ -113,23 +117,30 @@ struct Hand {
 			}
 			return false;
 		}
-		return type < rhs.type;
+		return lhs.type < rhs.type;
 	}
 };
 
-std::vector<Hand> parse_hands(std::istream& stream) {
+std::vector<Hand> parse_chunk(aoc::StringView input) {
 	std::vector<Hand> hands;
-	for (auto& line : aoc::Lines(stream)) {
+	for (auto line : aoc::ViewLines(input)) {
 		Hand h;
 
-		std::istringstream ss(line);
-		ss >> h.cards >> h.bid;
+		aoc::Scanner sc(line);
+		h.cards = sc.next_word().str();
+		h.bid = sc.next_int<uint64_t>();
 		h.type = get_hand_type<false>(h.cards);
 		hands.push_back(h);
 	}
 	return hands;
 }
 
+// Ranking needs all hands sorted, only parsing (and typing) them is per line
+std::vector<Hand> parse_hands(aoc::StringView input) {
+	aoc::ScopedTimer timer("day07 parse");
+	return aoc::parallel_lines(input, parse_chunk, aoc::concat<Hand>);
+}
+
 uint64_t sum_winnings(std::vector<Hand> const& hands) {
 	uint64_t i = 0;
 	uint64_t sum = 0;
@@ -141,21 +152,48 @@ uint64_t sum_winnings(std::vector<Hand> const& hands) {
 	return sum;
 }
 
-int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+uint64_t total_winnings(std::vector<Hand> const& parsed) {
+	aoc::ScopedTimer timer("day07 part1");
 
-	auto hands = parse_hands(*input);
-	std::sort(hands.begin(), hands.end());
+	std::vector<Hand> hands(parsed);
+	std::sort(hands.begin(), hands.end(), HandLess{PART1_VALUE_MAP});
+	return sum_winnings(hands);
+}
 
-	std::cout << "(Part1) Sum of winnings: " << sum_winnings(hands) << std::endl;
+uint64_t total_winnings_jokers(std::vector<Hand> const& parsed) {
+	aoc::ScopedTimer timer("day07 part2");
 
-	// PART 2
-	CARD_VALUE_MAP = &PART2_VALUE_MAP;
+	std::vector<Hand> hands(parsed);
 	for (auto& h : hands) {
 		h.type = get_hand_type<true>(h.cards);
 	}
-	std::sort(hands.begin(), hands.end());
-	std::cout << "(Part2) Sum of winnings: " << sum_winnings(hands) << std::endl;
+	std::sort(hands.begin(), hands.end(), HandLess{PART2_VALUE_MAP});
+	return sum_winnings(hands);
+}
+
+aoc::Solution solution() {
+	return aoc::make_solution(7, "camel", parse_hands, total_winnings, total_winnings_jokers);
+}
+
+} // namespace day07
+
+#ifndef AOC_NO_MAIN
+int main(int argc, char** argv) {
+	using namespace day07;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
+
+	auto hands = parse_hands(input.view());
+
+	std::cout << "(Part1) Sum of winnings: " << total_winnings(hands) << std::endl;
+
+	// PART 2
+	std::cout << "(Part2) Sum of winnings: " << total_winnings_jokers(hands) << std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
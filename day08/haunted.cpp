@@ -1,107 +1,238 @@
 #include "common.h"
+#include "flat_map.h"
+#include "interner.h"
+#include "parse_cache.h"
+#include "thread_pool.h"
 
 #include <vector>
-#include <unordered_map>
-#include <sstream>
 
-// LOCALE to filter input
-static auto const LOCALE = aoc::create_delimitor_locale<'=', '(', ',', ')'>();
+namespace day08 {
+
+// To filter input
+static aoc::Charset const DELIMITERS("=(,) ");
+
+using node_id = aoc::Interner::id_t;
 
 struct Node {
-	std::string left;
-	std::string right;
+	node_id left;
+	node_id right;
 };
 
-std::string parse_instructions(std::istream& stream) {
-	std::string str; std::getline(stream, str); // just grab first line
-	return str;
+// consumes the first line of input
+std::string parse_instructions(aoc::StringView& input) {
+	return aoc::next_line(input).str(); // just grab first line
 }
 
-using map_t = std::unordered_map<std::string, Node>;
+// Node names are only looked at while parsing, walking the network is
+// indexing into nodes by id
+struct Map {
+	aoc::Interner names;
+	std::vector<Node> nodes;     // by id
+	std::vector<char> ends_with; // by id, last character of the name
+};
 
-map_t parse_nodes(std::istream& stream) {
-	map_t nodes;
-	for (auto& line : aoc::Lines(stream)) {
+Map parse_nodes(aoc::StringView input) {
+	Map map;
+	for (auto line : aoc::ViewLines(input)) {
 		if (line.length() == 0) {
 			continue;
 		}
 
-		std::istringstream ss(line); ss.imbue(LOCALE);
+		aoc::Scanner sc(line);
 
-		Node node; std::string key;
-		ss >> key >> node.left >> node.right;
+		node_id key = map.names.intern(sc.next_token(DELIMITERS));
+		Node node;
+		node.left = map.names.intern(sc.next_token(DELIMITERS));
+		node.right = map.names.intern(sc.next_token(DELIMITERS));
 
-		nodes.insert({key, node});
+		if (map.nodes.size() < map.names.size()) {
+			map.nodes.resize(map.names.size(), {aoc::Interner::NONE, aoc::Interner::NONE});
+		}
+		map.nodes[key] = node;
 	}
-	return nodes;
-}
 
-using iter_t = map_t::const_iterator;
+	for (node_id id = 0; id < map.names.size(); ++id) {
+		if (map.nodes[id].left == aoc::Interner::NONE) {
+			throw std::runtime_error("Node " + map.names.name(id) + " is never defined");
+		}
+		map.ends_with.push_back(map.names.name(id).back());
+	}
+	return map;
+}
 
-uint64_t solve_single(map_t const& nodes, std::string const& instructions, iter_t start_it) {
+// Keep hopping through nodes until the next xxZ (at least one step).
+// steps is the total amount of steps taken so far, it picks the instruction.
+void walk_to_z(Map const& map, std::string const& instructions, node_id& id, uint64_t& steps) {
 	static char const END_CHAR = 'Z';
-	uint64_t count = 0;
-
-	// Simple enough, keep hopping through nodes until you find xxZ
-	auto it_current = start_it;
-	while (it_current->first.back() != END_CHAR) {
-		for (auto const& c : instructions) {
-			++count;
-			if (c == 'L') {
-				it_current = nodes.find(it_current->second.left);
-			} else if (c == 'R') {
-				it_current = nodes.find(it_current->second.right);
-			}
-			if (it_current->first.back() == END_CHAR) {
-				return count;
-			}
+
+	do {
+		char c = instructions[steps % instructions.length()];
+		++steps;
+		if (c == 'L') {
+			id = map.nodes[id].left;
+		} else if (c == 'R') {
+			id = map.nodes[id].right;
+		}
+	} while (map.ends_with[id] != END_CHAR);
+}
+
+uint64_t solve_single(Map const& map, std::string const& instructions, node_id start) {
+	uint64_t steps = 0;
+	walk_to_z(map, instructions, start, steps);
+	return steps;
+}
+
+std::vector<node_id> get_keys_end_with(Map const& map, char c) {
+	std::vector<node_id> ids;
+
+	for (node_id id = 0; id < map.names.size(); ++id) {
+		if (map.ends_with[id] == c) {
+			ids.push_back(id);
 		}
 	}
-	return count;
+	return ids;
 }
 
-std::vector<iter_t> get_keys_end_with(map_t const& nodes, char c) {
-	std::vector<iter_t> iterators;
+// The steps at which the ghost starting at id is on xxZ, as one cycle. It's
+// in the same state whenever it's on the same node at the same instruction,
+// so it walks from xxZ to xxZ until it's on one in a state it was in before:
+// from there on everything repeats. Throws if those steps aren't evenly
+// spaced, they wouldn't be a single cycle.
+aoc::Cycle z_cycle(Map const& map, std::string const& instructions, node_id id) {
+	node_id start = id;
+	uint64_t length = instructions.length();
+	aoc::FlatSet<uint64_t> seen; // node * length + instruction
+	std::vector<uint64_t> hits;
+	uint64_t steps = 0;
+	for (;;) {
+		walk_to_z(map, instructions, id, steps);
+		hits.push_back(steps);
+		if (!seen.insert(uint64_t(id) * length + steps % length).second) {
+			break ;
+		}
+	}
 
-	for (auto it = nodes.begin(); it != nodes.end(); ++it) {
-		if (it->first.back() == c) {
-			iterators.push_back(it);
+	uint64_t period = hits[1] - hits[0];
+	for (size_t i = 2; i < hits.size(); ++i) {
+		if (hits[i] - hits[i - 1] != period) {
+			throw std::runtime_error("The ghost starting at " + map.names.name(start) +
+				" isn't on xxZ every so many steps");
 		}
 	}
-	return iterators;
+	return {hits[0], period};
 }
 
-uint64_t solve_lcm(map_t const& nodes, std::string const& instructions) {
-	std::vector<iter_t> iterators = get_keys_end_with(nodes, 'A');
-	uint64_t lcm = 1;
+uint64_t solve_cycles(Map const& map, std::string const& instructions) {
+	std::vector<node_id> starts = get_keys_end_with(map, 'A');
 
-	/* Least Common Multiple Approach
-		The amount of steps it takes for ALL nodes to reach xxZ simultaniously
-		is equal to the Least Common Multiple of ALL nodes.
+	/* Chinese Remainder Approach
+		Every node ends up in a loop that passes xxZ periodically: the first
+		time after 'offset' steps and then every 'period' steps.
+		All nodes are on xxZ at once at the first step that is in all of
+		those cycles.
 
-		I go through each node one by one to see how many steps it takes to
-		reach xxZ and then take the LCM of those steps.
+		See z_cycle(), that's checked instead of taken for granted.
+
+		In the real input offset == period for every node, which makes this
+		the Least Common Multiple of the periods.
 	*/
 
-	for (auto& it : iterators) {
-		lcm = aoc::least_common_multiple(lcm, solve_single(nodes, instructions, it));
+	// Every ghost walks on its own
+	std::vector<aoc::Cycle> cycles(starts.size());
+	aoc::parallel_for(0, starts.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			cycles[i] = z_cycle(map, instructions, starts[i]);
+		}
+	}, 1);
+
+	aoc::Cycle all;
+	if (!aoc::combine_cycles(cycles, all)) {
+		throw std::runtime_error("The nodes are never on xxZ at the same time");
+	}
+	return all.offset;
+}
+
+struct Network {
+	std::string instructions;
+	Map map;
+};
+
+Network parse_network(aoc::StringView input) {
+	aoc::ScopedTimer timer("day08 parse");
+
+	Network network;
+	network.instructions = parse_instructions(input);
+	network.map = parse_nodes(input);
+	return network;
+}
+
+// For the parse cache
+void save_network(aoc::BinaryWriter& out, Network const& network) {
+	out.write(network.instructions);
+	out.write(network.map.names);
+	out.write(network.map.nodes);
+	out.write(network.map.ends_with);
+}
+
+Network load_network(aoc::BinaryReader& in) {
+	Network network;
+	in.read(network.instructions);
+	in.read(network.map.names);
+	in.read(network.map.nodes);
+	in.read(network.map.ends_with);
+	size_t n = network.map.names.size();
+	if (network.map.nodes.size() != n || network.map.ends_with.size() != n) {
+		throw std::runtime_error("Bad cached network");
+	}
+	for (auto const& node : network.map.nodes) {
+		if (node.left >= n || node.right >= n) {
+			throw std::runtime_error("Bad cached network");
+		}
+	}
+	return network;
+}
+
+uint64_t steps_aaa_to_zzz(Network const& network) {
+	aoc::ScopedTimer timer("day08 part1");
+	node_id start = network.map.names.find("AAA");
+	if (start == aoc::Interner::NONE) {
+		throw std::runtime_error("No node AAA");
 	}
-	return lcm;
+	return solve_single(network.map, network.instructions, start);
+}
+
+uint64_t steps_all_to_z(Network const& network) {
+	aoc::ScopedTimer timer("day08 part2");
+	return solve_cycles(network.map, network.instructions);
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(8, "haunted", parse_network, steps_aaa_to_zzz, steps_all_to_z),
+		1, save_network, load_network);
 }
 
+} // namespace day08
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day08;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
 
-	auto instructions = parse_instructions(*input);
-	auto nodes = parse_nodes(*input);
+	auto input = aoc::map_input(argc, argv);
+
+	auto network = parse_network(input.view());
 
 	std::cout << "(Part 1) Steps required for node AAA to reach ZZZ:  "
-		<< solve_single(nodes, instructions, nodes.find("AAA"))
+		<< steps_aaa_to_zzz(network)
 		<< std::endl;
 
 	std::cout << "(Part 2) Steps required for all nodes to reach xxZ: "
-		<< solve_lcm(nodes, instructions)
+		<< steps_all_to_z(network)
 		<< std::endl;
 
 	return (EXIT_SUCCESS);
-}
\ No newline at end of file
+}
+#endif // AOC_NO_MAIN
@@ -1,70 +1,125 @@
 #include "common.h"
+#include "arena.h"
+#include "parallel.h"
 
 #include <vector>
-#include <sstream>
+
+namespace day09 {
 
 using seq_t = std::vector<int64_t>;
 using sequences_t = std::vector<seq_t>;
 
-sequences_t parse_sequences(std::istream& input) {
+sequences_t parse_chunk(aoc::StringView input) {
 	sequences_t sequences;
 
-	for (auto const& line : aoc::Lines(input)) {
+	for (auto const& line : aoc::ViewLines(input)) {
 		sequences.emplace_back();
 		seq_t& curr_seq = sequences.back();
 
-		std::istringstream ss(line);
+		aoc::Scanner sc(line);
 
 		int64_t n ;
-		while (ss >> n) {
+		while (sc.next_int(n)) {
 			curr_seq.push_back(n);
 		}
 	}
 	return sequences;
 }
 
-seq_t calculate_differences(seq_t const& sequence) {
-	seq_t diff;
-
-	for (auto it = sequence.begin(); it != sequence.end(); ++it) {
-		auto it2 = it + 1;
+sequences_t parse_sequences(aoc::StringView input) {
+	aoc::ScopedTimer timer("day09 parse");
+	return aoc::parallel_lines(input, parse_chunk, aoc::concat<seq_t>);
+}
 
-		if (it2 == sequence.end()) {
-			return diff;
-		}
+// Temporaries of the extrapolation live in the scratch arena, one scope per
+// sequence, so going down the levels of differences never touches the heap
+using scratch_t = aoc::arena_vector<int64_t>;
 
-		diff.push_back(*it2 - *it);
+template <typename Seq>
+void calculate_differences(Seq const& sequence, scratch_t& diff) {
+	diff.reserve(sequence.size());
+	for (size_t i = 1; i < sequence.size(); ++i) {
+		diff.push_back(sequence[i] - sequence[i - 1]);
 	}
-	return diff;
 }
 
-int64_t extrapolate_next(seq_t const& sequence) {
-	seq_t seq = calculate_differences(sequence);
+template <typename Seq>
+int64_t next_value(Seq const& sequence, aoc::Arena& arena) {
+	scratch_t seq(arena);
+	calculate_differences(sequence, seq);
 	if (seq.back() == 0) {
 		return sequence.back();
 	}
-	return extrapolate_next(seq) + sequence.back();
+	return next_value(seq, arena) + sequence.back();
 }
 
-int64_t extrapolate_previous(seq_t const& sequence) {
-	seq_t seq = calculate_differences(sequence);
+template <typename Seq>
+int64_t previous_value(Seq const& sequence, aoc::Arena& arena) {
+	scratch_t seq(arena);
+	calculate_differences(sequence, seq);
 	if (seq.back() == 0) {
 		return sequence[0];
 	}
-	return sequence[0] - extrapolate_previous(seq);
+	return sequence[0] - previous_value(seq, arena);
 }
 
+int64_t extrapolate_next(seq_t const& sequence) {
+	aoc::ArenaScope scope(aoc::scratch_arena());
+	return next_value(sequence, scope.arena());
+}
+
+int64_t extrapolate_previous(seq_t const& sequence) {
+	aoc::ArenaScope scope(aoc::scratch_arena());
+	return previous_value(sequence, scope.arena());
+}
+
+// Sequences are independent, every thread extrapolates a range of them (each
+// in its own scratch arena)
+int64_t sum_extrapolated(sequences_t const& sequences, int64_t (*extrapolate)(seq_t const&)) {
+	return aoc::parallel_reduce(sequences.size(), 1024, [&](size_t begin, size_t end) {
+		int64_t sum = 0;
+		for (size_t i = begin; i < end; ++i) {
+			sum += extrapolate(sequences[i]);
+		}
+		return sum;
+	}, std::plus<int64_t>());
+}
+
+int64_t sum_next(sequences_t const& sequences) {
+	aoc::ScopedTimer timer("day09 part1");
+	return sum_extrapolated(sequences, extrapolate_next);
+}
+
+int64_t sum_previous(sequences_t const& sequences) {
+	aoc::ScopedTimer timer("day09 part2");
+	return sum_extrapolated(sequences, extrapolate_previous);
+}
+
+aoc::Solution solution() {
+	return aoc::make_solution(9, "oasis", parse_sequences, sum_next, sum_previous);
+}
+
+} // namespace day09
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day09;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
-	auto sequences = parse_sequences(*input);
+	auto sequences = parse_sequences(input.view());
 
 	std::cout << "Sum of extrapolated next values:     "
-		<< aoc::sum<int64_t>(sequences, extrapolate_next)
+		<< sum_next(sequences)
 		<< std::endl;
 	std::cout << "Sum of extrapolated previous values: "
-		<< aoc::sum<int64_t>(sequences, extrapolate_previous)
+		<< sum_previous(sequences)
 		<< std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
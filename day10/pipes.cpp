@@ -1,10 +1,14 @@
 #include "common.h"
 #include "vec2.h"
+#include "grid.h"
+#include "parse_cache.h"
+#include "search.h"
 
 #include <vector>
-#include <stack>
 #include <unordered_map>
 
+namespace day10 {
+
 enum Location {
 	NONE = 0,
 	OUTSIDE,
@@ -12,18 +16,19 @@ enum Location {
 	PATH
 };
 
-using loc_map_t = std::vector<std::vector<Location>>;
-using pipe_map_t = std::vector<std::string>;
+using loc_map_t = Grid<Location>;
+// Bordered with ground, so walking off the map is never a valid connection
+using pipe_map_t = Grid<char>;
 
-pipe_map_t parse_map(std::istream& stream) {
-	auto lines = aoc::Lines(stream);
-	return pipe_map_t(lines.begin(), lines.end());
+pipe_map_t parse_map(aoc::StringView input) {
+	aoc::ScopedTimer timer("day10 parse");
+	return pipe_map_t::from_lines(input, 1, '.');
 }
 
 Vec2 find_start(pipe_map_t const& map) {
-	for (int64_t y = 0; y < map.size(); ++y) {
-		for (int64_t x = 0; x < map[0].size(); ++x) {
-			if (map[y][x] == 'S') {
+	for (int64_t y = 0; y < map.height(); ++y) {
+		for (int64_t x = 0; x < map.width(); ++x) {
+			if (map.at(x, y) == 'S') {
 				return {x, y};
 			}
 		}
@@ -52,76 +57,80 @@ static std::unordered_map<char, std::vector<Vec2>> const DIRECTION_MAP = {
 	{ '.', {}}
 };
 
-std::vector<Vec2> get_connections(pipe_map_t const& map, Vec2 p) {
-	Vec2 const END_POS = Vec2(map[0].length() - 1, map.size() - 1);
+// Calls f with every neighbour of p that connects back to p
+template <typename F>
+void for_each_connection(pipe_map_t const& map, Vec2 p, F const& f) {
 	// Bounds check
-	if (!p.is_within_bounds({0, 0}, END_POS)) {
-		return {};
+	if (!map.is_within_bounds(p)) {
+		return ;
 	}
 
-	std::vector<Vec2> connections;
-	for (Vec2 const& d : DIRECTION_MAP.at(map[p.y][p.x])) {
-		Vec2 d_abs = d + p; // to absolute position
-		if (!d_abs.is_within_bounds({0, 0}, END_POS)) {
-			continue;
-		}
+	for (Vec2 const& d : DIRECTION_MAP.at(map[p])) {
+		Vec2 d_abs = d + p; // to absolute position, the border takes care of bounds
 
-		auto next_dirs = DIRECTION_MAP.at(map[d_abs.y][d_abs.x]);
-		for (Vec2& n : next_dirs) {
+		auto const& next_dirs = DIRECTION_MAP.at(map[d_abs]);
+		for (Vec2 const& n : next_dirs) {
 			if (n + d_abs == p) {
-				connections.push_back(d_abs);
+				f(d_abs);
 				break ;
 			}
 		}
 	}
-	return connections;
 }
 
-// Trace a path from S through the loop back to S
-std::vector<Vec2> find_path(pipe_map_t const& map) {
-	Vec2 start = find_start(map);
-
-	// For every connection coming from start
-	auto connections = get_connections(map, start);
-	for (Vec2& current : connections) {
-		std::vector<Vec2> path;
-		path.push_back(start);
-		path.push_back(current);
-
-		Vec2 from = start;
-		// trace a path
-		for (auto to = get_connections(map, current); to.size() == 2; to = get_connections(map, current)) {
-			path.push_back( (to[0] == from) ? to[1] : to[0] );
-			from = current;
-			current = path.back();
-			// Until we reach start
-			if (current == start) {
-				return path;
-			}
-		}
+// A state is a tile (index into the bordered map), its neighbours are the
+// tiles it connects with
+struct Connections {
+	pipe_map_t const& map;
+
+	template <typename Emit>
+	void operator()(uint32_t s, Emit const& emit) const {
+		for_each_connection(map, map.position(s), [&](Vec2 next) {
+			emit(uint32_t(map.index(next)), 1);
+		});
 	}
-	return {}; // no path
+};
+
+// Every tile of the loop connects to exactly two others, so the loop is
+// everything that can be reached from S
+struct Loop {
+	std::vector<Vec2> tiles;
+	size_t farthest; // steps along the loop from S
+};
+
+Loop find_loop(pipe_map_t const& map) {
+	uint32_t const sources[] = {uint32_t(map.index(find_start(map)))};
+
+	Loop loop {{}, 0};
+	aoc::Traversal search;
+	search.breadth_first(map.size(), sources, Connections {map}, [&](uint32_t s, size_t steps) {
+		loop.tiles.push_back(map.position(s));
+		loop.farthest = steps;
+	});
+	return loop;
 }
 
 void draw_path(loc_map_t& map, std::vector<Vec2> const& path) {
 	for (auto const& p : path) {
-		map[p.y][p.x] = PATH;
+		map[p] = PATH;
 	}
 }
 
 // Fill the map with INSIDE/OUTSIDE and return amount of INSIDE
 size_t calculate_inside(loc_map_t& result_map, pipe_map_t const& pipe_map) {
 	size_t amount = 0;
-	for (int64_t y = 0; y < result_map.size(); ++y) {
-		for (int64_t x = 0; x < result_map[0].size(); ++x) {
-			auto& loc = result_map[y][x];
+	for (int64_t y = 0; y < result_map.height(); ++y) {
+		auto result_row = result_map.row(y);
+		auto pipe_row = pipe_map.row(y);
+		for (int64_t x = 0; x < result_map.width(); ++x) {
+			auto& loc = result_row[x];
 			size_t count = 0;
 			if (loc != NONE) {
 				continue;
 			}
-			for (size_t i = 0; i < x; ++i) {
-				char o = pipe_map[y][i];
-				if (result_map[y][i] == PATH && (o == '|' || o =='J' || o == 'L')) {
+			for (int64_t i = 0; i < x; ++i) {
+				char o = pipe_row[i];
+				if (result_row[i] == PATH && (o == '|' || o =='J' || o == 'L')) {
 					++count;
 				}
 			}
@@ -136,12 +145,15 @@ size_t calculate_inside(loc_map_t& result_map, pipe_map_t const& pipe_map) {
 	return amount;
 }
 
-void determine_start_char(pipe_map_t& pipe_map, std::vector<Vec2> const& path) {
-	assert(path.size() > 1);
-
+void determine_start_char(pipe_map_t& pipe_map) {
 	Vec2 start = find_start(pipe_map);
-	Vec2 pos_up = path[1] - start;
-	Vec2 pos_down = path[path.size() - 2] - start;
+	// the two tiles of the loop next to S
+	std::vector<Vec2> ends;
+	for_each_connection(pipe_map, start, [&](Vec2 p) { ends.push_back(p); });
+	assert(ends.size() == 2);
+
+	Vec2 pos_up = ends[0] - start;
+	Vec2 pos_down = ends[1] - start;
 
 	if (pos_up.y >= 0 && pos_down.y >= 0) {
 		return ; // Not interested
@@ -157,13 +169,13 @@ void determine_start_char(pipe_map_t& pipe_map, std::vector<Vec2> const& path) {
 	} else if (pos_down.x < 0) {
 		c = 'J';
 	}
-	pipe_map[start.y][start.x] = c;
+	pipe_map[start] = c;
 }
 
 /*
 void debug_map_draw(loc_map_t const& result_map) {
-	for (auto const& row : result_map) {
-		for (auto const& x : row) {
+	for (int64_t y = 0; y < result_map.height(); ++y) {
+		for (auto const& x : result_map.row(y)) {
 			if (x == OUTSIDE) {
 				std::cout << ' ';
 			} else if (x == INSIDE) {
@@ -177,23 +189,50 @@ void debug_map_draw(loc_map_t const& result_map) {
 }
 */
 
+size_t farthest_steps(pipe_map_t const& map) {
+	aoc::ScopedTimer timer("day10 part1");
+	return find_loop(map).farthest;
+}
+
+size_t enclosed_tiles(pipe_map_t const& map) {
+	aoc::ScopedTimer timer("day10 part2");
+
+	auto loop = find_loop(map);
+	loc_map_t result_map(map.width(), map.height(), NONE);
+	pipe_map_t pipe_map(map);
+
+	draw_path(result_map, loop.tiles);
+	determine_start_char(pipe_map);
+	size_t inside = calculate_inside(result_map, pipe_map);
+
+	// debug_map_draw(result_map);
+	return inside;
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(10, "pipes", parse_map, farthest_steps, enclosed_tiles),
+		1, aoc::save_grid<char>, aoc::load_grid<char>);
+}
+
+} // namespace day10
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day10;
 
-	auto map = parse_map(*input);
-	auto path = find_path(map);
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
 
-	std::cout << "(Part 1) Steps from start to farthest point: " << path.size() / 2 << std::endl;
+	auto input = aoc::map_input(argc, argv);
 
-	// Part 2
-	loc_map_t result_map(map.size(), std::vector<Location>(map[0].size(), NONE));
+	auto map = parse_map(input.view());
 
-	draw_path(result_map, path);
-	determine_start_char(map, path);
-	size_t inside = calculate_inside(result_map, map);
+	std::cout << "(Part 1) Steps from start to farthest point: " << farthest_steps(map) << std::endl;
 
-	// debug_map_draw(result_map);
-	std::cout << "(Part 2) Tiles enclosed by the loop: " << inside << std::endl;
+	// Part 2
+	std::cout << "(Part 2) Tiles enclosed by the loop: " << enclosed_tiles(map) << std::endl;
 
 	return (EXIT_FAILURE);
 }
+#endif // AOC_NO_MAIN
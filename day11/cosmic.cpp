@@ -1,26 +1,33 @@
 #include "common.h"
 #include "vec2.h"
+#include "grid.h"
+#include "parse_cache.h"
+#include "transpose.h"
 
 #include <vector>
 #include <set>
 
+namespace day11 {
+
 static char const GALAXY_CHAR = '#';
 
-std::set<size_t> get_empty_columns(std::vector<std::string> const& lines) {
+using image_t = Grid<char>;
+
+std::set<size_t> get_empty_columns(image_t const& image) {
 	std::set<size_t> empty;
 
+	// scanning a column of image would be a cache miss per cell, the columns
+	// of a transposed copy are contiguous
+	aoc::Columns<char> columns(image);
+
 	// lambda to check if a specifc column is empty
-	auto check_column = [&lines] (size_t i) -> bool {
-		for (auto const& l : lines) {
-			if (l[i] == GALAXY_CHAR) {
-				return false;
-			}
-		}
-		return true;
+	auto check_column = [&columns] (size_t i) -> bool {
+		auto column = columns[i];
+		return std::find(column.begin(), column.end(), GALAXY_CHAR) == column.end();
 	};
 
 	// go through columns and insert the indexes of the empty ones into a set
-	for (size_t i = 0; i < lines[0].length(); ++i) {
+	for (int64_t i = 0; i < columns.count(); ++i) {
 		if (check_column(i)) {
 			empty.insert(i);
 		}
@@ -28,28 +35,29 @@ std::set<size_t> get_empty_columns(std::vector<std::string> const& lines) {
 	return empty;
 }
 
-std::vector<std::string> parse_lines(std::istream& stream) {
-	auto lines = aoc::Lines(stream);
-	return std::vector<std::string>(lines.begin(), lines.end());
+image_t parse_image(aoc::StringView input) {
+	aoc::ScopedTimer timer("day11 parse");
+	return image_t::from_lines(input);
 }
 
 // Map the galaxies to a certain position, keeping expansion into account
-std::vector<Vec2> map_galaxies(std::vector<std::string> const& lines, int64_t const expansion = 2) {
+std::vector<Vec2> map_galaxies(image_t const& image, int64_t const expansion = 2) {
 	assert(expansion > 0);
 
-	auto empty_columns = get_empty_columns(lines);
+	auto empty_columns = get_empty_columns(image);
 
 	std::vector<Vec2> galaxies;
 	int64_t y = 0;
-	for (int64_t yi = 0; yi < lines.size(); ++yi) {
+	for (int64_t yi = 0; yi < image.height(); ++yi) {
+		auto row = image.row(yi);
 		// Vertical expansion
-		if (lines[yi].find_first_of(GALAXY_CHAR) == std::string::npos) {
+		if (std::find(row.begin(), row.end(), GALAXY_CHAR) == row.end()) {
 			y += (expansion - 1); // this -1 is important, was stuck on this for a while
 			continue;
 		}
 
 		int64_t x = 0;
-		for (int64_t xi = 0; xi < lines[0].size(); ++xi) {
+		for (int64_t xi = 0; xi < image.width(); ++xi) {
 			// Horizontal expansion
 			if (empty_columns.count(xi) > 0) {
 				x += (expansion - 1);
@@ -57,7 +65,7 @@ std::vector<Vec2> map_galaxies(std::vector<std::string> const& lines, int64_t co
 			}
 
 			// Add expanded coordinate
-			if (lines[yi][xi] == GALAXY_CHAR) {
+			if (row[xi] == GALAXY_CHAR) {
 				galaxies.push_back({x + xi, y + yi});
 			}
 		}
@@ -76,28 +84,54 @@ std::vector<std::pair<Vec2, Vec2>> get_pairs(std::vector<Vec2> const& galaxies)
 	return (pairs);
 }
 
-int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
-	auto lines = parse_lines(*input);
-
-	auto galaxies = map_galaxies(lines);
+int64_t sum_distances(image_t const& image, int64_t const expansion) {
+	auto galaxies = map_galaxies(image, expansion);
 	auto pairs = get_pairs(galaxies);
 
 	// Simple lambda for getting distance between Positions in a pair
 	auto distance = [] (std::pair<Vec2, Vec2> const& pair) {
 		return pair.first.manhattan(pair.second);
 	};
+	return aoc::sum<int64_t>(pairs, distance);
+}
+
+int64_t sum_distances_young(image_t const& image) {
+	aoc::ScopedTimer timer("day11 part1");
+	return sum_distances(image, 2);
+}
+
+int64_t sum_distances_old(image_t const& image) {
+	aoc::ScopedTimer timer("day11 part2");
+	return sum_distances(image, 1e6);
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(11, "cosmic", parse_image, sum_distances_young, sum_distances_old),
+		1, aoc::save_grid<char>, aoc::load_grid<char>);
+}
+
+} // namespace day11
+
+#ifndef AOC_NO_MAIN
+int main(int argc, char** argv) {
+	using namespace day11;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
+	auto image = parse_image(input.view());
 
 	std::cout << "(Part 1) Sum of lengths of shortest paths between galaxies: "
-		<< aoc::sum<int64_t>(pairs, distance)
+		<< sum_distances_young(image)
 		<< std::endl;
 
 	// Part 2, remap galaxies with bigger expansion
-	galaxies = map_galaxies(lines, 1e6);
-	pairs = get_pairs(galaxies);	
 	std::cout << "(Part 2) Sum of lengths of shortest paths between galaxies: "
-		<< aoc::sum<int64_t>(pairs, distance)
+		<< sum_distances_old(image)
 		<< std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
@@ -1,26 +1,29 @@
 #include "common.h"
+#include "parallel.h"
+#include "thread_pool.h"
 
+#include <algorithm>
 #include <vector>
-#include <unordered_map>
-#include <sstream>
 #include <deque>
 
+namespace day12 {
+
 struct Record {
 	std::string row;
 	std::vector<uint64_t> groups;
 };
 
-std::vector<Record> parse_records(std::istream& stream) {
+std::vector<Record> parse_chunk(aoc::StringView input) {
 	std::vector<Record> records;
-	for (auto const& line : aoc::Lines(stream)) {
+	for (auto const& line : aoc::ViewLines(input)) {
 		Record r;
 
-		std::istringstream ss(line);
+		aoc::Scanner sc(line);
 
-		ss >> r.row;
+		r.row = sc.next_word().str();
 
 		uint64_t n;
-		while (ss >> aoc::next_digit >> n) {
+		while (sc.next_int(n)) {
 			r.groups.push_back(n);
 		}
 		records.push_back(r);
@@ -28,6 +31,11 @@ std::vector<Record> parse_records(std::istream& stream) {
 	return records;
 }
 
+std::vector<Record> parse_records(aoc::StringView input) {
+	aoc::ScopedTimer timer("day12 parse");
+	return aoc::parallel_lines(input, parse_chunk, aoc::concat<Record>);
+}
+
 void unfold_records(std::vector<Record>& records, size_t repeat) {
 	for (auto& r : records) {
 		Record new_record;
@@ -43,64 +51,98 @@ void unfold_records(std::vector<Record>& records, size_t repeat) {
 	}
 }
 
-uint64_t hash(uint64_t i, uint64_t j, uint64_t k) {
-	return (i + j * 1e3 + k * 1e6);
-}
-
-uint64_t arrangements(std::string const& row, std::vector<uint64_t> const& groups) {
-	std::unordered_map<uint64_t, uint64_t> cache;
-	cache[hash(0, 0, 0)] = 1; // this hash presumes we don't go above 1000 char length rows
+// Counts of the (i, g, c) states: i chars of the row read, g groups started
+// and c the length of the current run of '#'. Only the rows i and i + 1 are
+// needed at a time, so memo keeps two of them (reused from one record to the
+// next). A run longer than every group never fits, so c stops at the longest
+// group. A count of 0 is a state that isn't reached.
+uint64_t arrangements(std::string const& row, std::vector<uint64_t> const& groups, std::vector<uint64_t>& memo) {
+	size_t const group_count = groups.size() + 2; // g + 1 past the last group is a dead end
+	size_t const run_count = (groups.empty() ? 0 : *std::max_element(groups.begin(), groups.end())) + 1;
+	size_t const layer = group_count * run_count;
+	memo.assign(2 * layer, 0);
+	auto state = [&](size_t i, size_t g, size_t c) -> uint64_t& {
+		return memo[(i & 1) * layer + g * run_count + c];
+	};
+	state(0, 0, 0) = 1;
 
 	for (size_t i = 0; i < row.length(); ++i) { // Index within string
+		std::fill(&state(i + 1, 0, 0), &state(i + 1, 0, 0) + layer, 0);
 		for (size_t g = 0; g < groups.size() + 1; ++g) { // Index within group
-			for (size_t c = 0; c < row.length() + 1; ++c) { // contiguous length
-				auto it = cache.find(hash(i, g, c));
-				if (it == cache.end()) {
+			for (size_t c = 0; c < run_count; ++c) { // contiguous length
+				uint64_t count = state(i, g, c);
+				if (count == 0) {
 					continue;
 				}
 
 				bool is_con = (c == 0 || (g > 0 && c == groups[g - 1]));
+				bool can_grow = (c + 1 < run_count);
 				switch (row[i]) {
 					case '.':
-						is_con ? cache[hash(i + 1, g, 0)] += it->second : 0;
+						is_con ? state(i + 1, g, 0) += count : 0;
 						break;
 					case '#':
-						cache[hash(i + 1, g + !c, c + 1)] += it->second;
+						can_grow ? state(i + 1, g + !c, c + 1) += count : 0;
 						break ;
 					case '?':
-						is_con ? cache[hash(i + 1, g, 0)] += it->second : 0;
-						cache[hash(i + 1, g + !c, c + 1)] += it->second;
+						is_con ? state(i + 1, g, 0) += count : 0;
+						can_grow ? state(i + 1, g + !c, c + 1) += count : 0;
 						break;
 				}
 			}
 		}
 	}
-	return cache.at(hash(row.length(), groups.size(), 0));
+	return state(row.length(), groups.size(), 0);
 }
 
+// Records are independent, but some take a lot longer than others (unfolded
+// ones with many '?'), so they are spread over the pool in small pieces that
+// idle workers can steal
 uint64_t solve(std::vector<Record> const& records) {
-	uint64_t result = 0;
-	for (auto const& r : records) {
-		auto row = r.row + '.';
-		auto groups = r.groups;
+	std::vector<uint64_t> counts(records.size());
+	aoc::parallel_for(0, records.size(), [&](size_t begin, size_t end) {
+		std::vector<uint64_t> memo;
+		for (size_t i = begin; i < end; ++i) {
+			counts[i] = arrangements(records[i].row + '.', records[i].groups, memo);
+		}
+	});
+	return aoc::sum<uint64_t>(counts);
+}
 
-		size_t r_len = row.length();
-		size_t g_len = groups.size();
+uint64_t sum_arrangements(std::vector<Record> const& records) {
+	aoc::ScopedTimer timer("day12 part1");
+	return solve(records);
+}
 
-		result += arrangements(row, r.groups);
-	}
-	return result;
+uint64_t sum_arrangements_unfolded(std::vector<Record> const& parsed) {
+	aoc::ScopedTimer timer("day12 part2");
+
+	std::vector<Record> records(parsed);
+	unfold_records(records, 5);
+	return solve(records);
+}
+
+aoc::Solution solution() {
+	return aoc::make_solution(12, "springs", parse_records, sum_arrangements, sum_arrangements_unfolded);
 }
 
+} // namespace day12
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day12;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
 
-	auto records = parse_records(*input);
+	auto input = aoc::map_input(argc, argv);
 
-	std::cout << "(Part 1) Sum of arrangements: " << solve(records) << std::endl;
+	auto records = parse_records(input.view());
 
-	unfold_records(records, 5);
-	std::cout << "(Part 2) Sum of arrangements: " << solve(records) << std::endl;
+	std::cout << "(Part 1) Sum of arrangements: " << sum_arrangements(records) << std::endl;
+	std::cout << "(Part 2) Sum of arrangements: " << sum_arrangements_unfolded(records) << std::endl;
 
 	return EXIT_SUCCESS;
 }
+#endif // AOC_NO_MAIN
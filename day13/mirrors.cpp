@@ -1,45 +1,51 @@
 #include "common.h"
+#include "grid.h"
+#include "parse_cache.h"
+#include "transpose.h"
 
 #include <vector>
-#include <sstream>
 
-using pattern_t = std::vector<std::string>;
-std::vector<pattern_t> parse_patterns(std::istream& stream) {
-	std::vector<pattern_t> patterns;
-	pattern_t p;
-	for (auto const& line : aoc::Lines(stream)) {
+namespace day13 {
 
-		if (line.length() == 0) {
-			patterns.push_back(p);
-			p = pattern_t();
-			continue;
-		}
+using pattern_t = Grid<char>;
 
-		p.push_back(line);
-	}
-	patterns.push_back(p);
-	return patterns;
-}
+// A reflection across a column is one across a row of the transposed pattern,
+// both parts look for those as row compares instead of column walks
+struct Pattern {
+	pattern_t rows;
+	pattern_t columns; // transposed
+};
 
-int64_t horizontal_difference(pattern_t const& p, size_t col) {
-	int64_t d = std::min(col, p[0].length() - col);
-	int64_t sum = 0;
-	for (size_t y = 0; y < p.size(); ++y) {
-		for (size_t x = 0; x < d; ++x) {
-			if (p[y][col + x] != p[y][col - x - 1]) {
-				++sum;
-			}
+std::vector<Pattern> parse_patterns(aoc::StringView input) {
+	aoc::ScopedTimer timer("day13 parse");
+
+	std::vector<Pattern> patterns;
+	auto add_pattern = [&patterns](aoc::StringView lines) {
+		pattern_t rows = pattern_t::from_lines(lines);
+		pattern_t columns = aoc::transpose(rows);
+		patterns.push_back({std::move(rows), std::move(columns)});
+	};
+
+	// patterns are separated by an empty line, every pattern is a grid on its own
+	char const* pattern_begin = input.data();
+	for (auto const& line : aoc::ViewLines(input)) {
+		if (line.length() == 0) {
+			add_pattern(aoc::StringView(pattern_begin, line.data()));
+			pattern_begin = line.data() + 1;
 		}
 	}
-	return sum;
+	add_pattern(aoc::StringView(pattern_begin, input.end()));
+	return patterns;
 }
 
 int64_t vertical_difference(pattern_t const& p, size_t row) {
-	int64_t d = std::min(row, p.size() - row);
+	int64_t d = std::min<int64_t>(row, p.height() - row);
 	int64_t sum = 0;
-	for (size_t y = 0; y < d; ++y) {
-		for (size_t x = 0; x < p[0].length(); ++x) {
-			if (p[row + y][x] != p[row - y - 1][x]) {
+	for (int64_t y = 0; y < d; ++y) {
+		auto a = p.row(row + y);
+		auto b = p.row(row - y - 1);
+		for (int64_t x = 0; x < p.width(); ++x) {
+			if (a[x] != b[x]) {
 				++sum;
 			}
 		}
@@ -48,35 +54,84 @@ int64_t vertical_difference(pattern_t const& p, size_t row) {
 }
 
 template <int64_t MAX_DIFF = 0>
-size_t pattern_reflection(pattern_t const& p) {
+size_t pattern_reflection(Pattern const& p) {
 	static size_t const VERTICAL_MOD = 100;
 	size_t reflection = 0;
-	for (size_t col = 0; col < p[0].length(); ++col) {
-		if (horizontal_difference(p, col) == MAX_DIFF) {
+	for (int64_t col = 0; col < p.columns.height(); ++col) {
+		if (vertical_difference(p.columns, col) == MAX_DIFF) {
 			reflection += col;
 		}
 	}
 
-	for (size_t row = 0; row < p.size(); ++row) {
-		if (vertical_difference(p, row) == MAX_DIFF) {
+	for (int64_t row = 0; row < p.rows.height(); ++row) {
+		if (vertical_difference(p.rows, row) == MAX_DIFF) {
 			reflection += row * VERTICAL_MOD;
 		}
 	}
 	return reflection;
 }
 
+size_t summarize(std::vector<Pattern> const& patterns) {
+	aoc::ScopedTimer timer("day13 part1");
+	return aoc::sum<size_t>(patterns, pattern_reflection<0>);
+}
+
+size_t summarize_smudged(std::vector<Pattern> const& patterns) {
+	aoc::ScopedTimer timer("day13 part2");
+	return aoc::sum<size_t>(patterns, pattern_reflection<1>);
+}
+
+// both grids of every pattern, loading doesn't transpose anything again
+void save_patterns(aoc::BinaryWriter& out, std::vector<Pattern> const& patterns) {
+	out.write<uint64_t>(patterns.size());
+	for (auto const& pattern : patterns) {
+		out.write(pattern.rows);
+		out.write(pattern.columns);
+	}
+}
+
+std::vector<Pattern> load_patterns(aoc::BinaryReader& in) {
+	// one at a time, a bad count runs out of data instead of allocating it
+	std::vector<Pattern> patterns;
+	for (uint64_t n = in.read<uint64_t>(); n > 0; --n) {
+		Pattern pattern;
+		in.read(pattern.rows);
+		in.read(pattern.columns);
+		if (pattern.columns.width() != pattern.rows.height() || pattern.columns.height() != pattern.rows.width()) {
+			throw std::runtime_error("Bad cached patterns");
+		}
+		patterns.push_back(std::move(pattern));
+	}
+	return patterns;
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(13, "mirrors", parse_patterns, summarize, summarize_smudged),
+		1, save_patterns, load_patterns);
+}
+
+} // namespace day13
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day13;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
-	auto patterns = parse_patterns(*input);
+	auto patterns = parse_patterns(input.view());
 
 	std::cout << "(Part 1) Summary of notes: "
-		<< aoc::sum<size_t>(patterns, pattern_reflection<0>)
+		<< summarize(patterns)
 		<< std::endl;
 
 	std::cout << "(Part 2) Summary of notes: "
-		<< aoc::sum<size_t>(patterns, pattern_reflection<1>)
+		<< summarize_smudged(patterns)
 		<< std::endl;
 
 	return EXIT_SUCCESS;
 }
+#endif // AOC_NO_MAIN
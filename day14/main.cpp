@@ -1,95 +1,184 @@
 #include "common.h"
+#include "grid.h"
+#include "parse_cache.h"
+#include "transpose.h"
+#include "cycle.h"
+#include "hash.h"
 
 #include <vector>
-#include <sstream>
-#include <unordered_map>
 
-using grid_t = std::vector<std::string>;
+namespace day14 {
 
-grid_t parse_rocks(std::istream& stream) {
-	auto lines = aoc::Lines(stream);
-	return grid_t(lines.begin(), lines.end());
+// Bordered with cube rocks, so rolling rocks stop at the edge by themselves
+using grid_t = Grid<char>;
+
+grid_t parse_rocks(aoc::StringView input) {
+	aoc::ScopedTimer timer("day14 parse");
+	return grid_t::from_lines(input, 1, '#');
 }
 
-int64_t move_rock(grid_t& rocks, int64_t x, int64_t y, int64_t dx, int64_t dy) {
-	while (x + dx >= 0 && y + dy >= 0 && x + dx < rocks[0].length() && y + dy < rocks.size()) {
-		if (rocks[y + dy][x + dx] == '.') {
-			rocks[y][x] = '.';
-			rocks[y + dy][x + dx] = 'O';
-		} else {
-			break ;
+// Zobrist keys of the cells, xored along every row from its west border up to
+// the cell: the keys of a stretch [a, b) of a row xor to prefix[b - 1] ^
+// prefix[a - 1]
+using keys_t = Grid<uint64_t>;
+
+keys_t key_prefixes(keys_t keys) {
+	for (int64_t y = 0; y < keys.height(); ++y) {
+		uint64_t* row = keys.data() + keys.index(-1, y);
+		for (int64_t x = 1; x < keys.width() + 2; ++x) {
+			row[x] ^= row[x - 1];
 		}
-		x += dx;
-		y += dy;
 	}
-	return (rocks.size() - y);
+	return keys;
 }
 
-int64_t move_rocks_dir(grid_t& rocks, int64_t dx, int64_t dy) {
-	int64_t load = 0;
-
-	int64_t xstart = dx <= 0 ? 0 : rocks[0].length() - 1;
-	int64_t ystart = dy <= 0 ? 0 : rocks.size() - 1;
-	int64_t xinc = dx <= 0 ? 1 : -1;
-	int64_t yinc = dy <= 0 ? 1 : -1;
-
-	for (int64_t y = ystart; y >= 0 && y < rocks.size(); y += yinc) {
-		for (int64_t x = xstart; x >= 0 && x < rocks[0].length(); x += xinc) {
-			if (rocks[y][x] == 'O') {
-				load += move_rock(rocks, x, y, dx, dy);
+// Roll every round rock of every row as far west (or east) as it goes. Rocks
+// stop at cube rocks (and the border), so every stretch between two cubes ends
+// up with all of its rocks packed against one end of it.
+// Given the key prefixes of the grid, returns the Zobrist hash of the round
+// rocks afterwards: packed rocks take a single range of keys per stretch.
+uint64_t roll_rows(grid_t& rocks, bool east, keys_t const* prefixes = nullptr) {
+	uint64_t hash = 0;
+	for (int64_t y = 0; y < rocks.height(); ++y) {
+		// the border cubes on both sides are part of the row
+		char* row = rocks.data() + rocks.index(-1, y);
+		uint64_t const* keys = prefixes ? prefixes->data() + prefixes->index(-1, y) : nullptr;
+		int64_t end = rocks.width() + 1;
+		int64_t x = 1;
+		while (x < end) {
+			int64_t stretch = x;
+			int64_t round = 0;
+			for (; row[x] != '#'; ++x) {
+				round += (row[x] == 'O');
+			}
+			int64_t empty = (x - stretch) - round;
+			if (east) {
+				std::fill_n(row + stretch, empty, '.');
+				std::fill_n(row + stretch + empty, round, 'O');
+				if (keys) {
+					hash ^= keys[x - 1] ^ keys[x - round - 1];
+				}
+			} else {
+				std::fill_n(row + stretch, round, 'O');
+				std::fill_n(row + stretch + round, empty, '.');
+				if (keys) {
+					hash ^= keys[stretch + round - 1] ^ keys[stretch - 1];
+				}
 			}
+			++x;
 		}
 	}
-	return load;
+	return hash;
 }
 
-// For hashing the grid
-std::string grid_to_string(grid_t const& g) {
-	std::string str;
-	for (auto const& row : g) {
-		str += row;
+// Load on the north support beams
+int64_t beam_load(grid_t const& rocks) {
+	int64_t load = 0;
+	for (int64_t y = 0; y < rocks.height(); ++y) {
+		auto row = rocks.row(y);
+		load += std::count(row.begin(), row.end(), 'O') * (rocks.height() - y);
 	}
-	return str;
+	return load;
 }
 
-int64_t do_cycles(grid_t& rocks) {
-	static size_t const CYCLES = 1000000000;
+// Rolling north and south walks columns, those roll west and east along the
+// rows of the transposed grid instead. transposed is only scratch space, kept
+// by the caller so a cycle doesn't allocate.
+void roll_north(grid_t& rocks, grid_t& transposed) {
+	aoc::transpose(rocks, transposed);
+	roll_rows(transposed, false);
+	aoc::transpose(transposed, rocks);
+}
 
-	int64_t load = 0;
-	std::unordered_map<std::string, size_t> cache;
-
-	size_t i = 0;
-	bool found = false;
-	while (i++ < CYCLES) {
-		// Do the cycle
-		move_rocks_dir(rocks, 0, -1); // N
-		move_rocks_dir(rocks, -1, 0); // W
-		move_rocks_dir(rocks, 0, 1); // S
-		load = move_rocks_dir(rocks, 1, 0); // E
-
-		std::string grid_hash = grid_to_string(rocks);
-		// Check if we have cached this cycle
-		if (cache.find(grid_hash) != cache.end()) {
-			size_t diff = i - cache[grid_hash]; // How many cycles can we jump forward?
-			i += ((CYCLES - i) / diff) * diff; // Jump forward as 'many' times as we can
-		} else {
-			cache[grid_hash] = i; // cache the result
+// The round rocks and their Zobrist hash (the xor of the keys of their cells)
+struct Dish {
+	grid_t rocks;
+	uint64_t hash;
+
+	bool operator==(Dish const& rhs) const { return rocks == rhs.rocks; }
+};
+
+// A spin cycle: north, west, south and east. North and south roll along the
+// rows of the transposed grid. Only the last roll hashes: with every rock
+// packed east, the new hash is a xor per stretch instead of per rock.
+struct SpinCycle {
+	keys_t prefixes;
+	grid_t transposed; // scratch space, so a cycle doesn't allocate
+
+	void operator()(Dish& dish) {
+		aoc::ScopedTimer timer("day14 cycle");
+
+		aoc::transpose(dish.rocks, transposed);
+		roll_rows(transposed, false); // N
+		aoc::transpose(transposed, dish.rocks);
+		roll_rows(dish.rocks, false); // W
+		aoc::transpose(dish.rocks, transposed);
+		roll_rows(transposed, true); // S
+		aoc::transpose(transposed, dish.rocks);
+		dish.hash = roll_rows(dish.rocks, true, &prefixes); // E
+	}
+};
+
+// The cycles repeat after a few hundred at most. Dishes are told apart by their
+// hash alone: with 64 bits the odds of a collision among that few are nil, and
+// comparing whole grids on a match (aoc::CompareStates) costs a replay of the
+// cycles before the loop for nothing.
+int64_t do_cycles(grid_t const& parsed) {
+	static uint64_t const CYCLES = 1000000000;
+
+	keys_t keys(parsed.width(), parsed.height(), 0, parsed.border(), 0);
+	auto random = aoc::zobrist_keys(keys.size());
+	std::copy(random.begin(), random.end(), keys.data());
+
+	Dish dish {parsed, 0};
+	for (size_t i = 0; i < parsed.size(); ++i) {
+		if (parsed.data()[i] == 'O') {
+			dish.hash ^= keys.data()[i];
 		}
-
 	}
-	return load;
+
+	SpinCycle spin {key_prefixes(keys), grid_t()};
+	dish = aoc::state_after(dish, CYCLES, spin, [](Dish const& d) { return d.hash; });
+	return beam_load(dish.rocks);
 }
 
+int64_t north_load(grid_t const& parsed) {
+	aoc::ScopedTimer timer("day14 part1");
+
+	grid_t rocks(parsed);
+	grid_t transposed;
+	roll_north(rocks, transposed);
+	return beam_load(rocks);
+}
+
+int64_t north_load_cycled(grid_t const& parsed) {
+	aoc::ScopedTimer timer("day14 part2");
+
+	return do_cycles(parsed);
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(14, "main", parse_rocks, north_load, north_load_cycled),
+		1, aoc::save_grid<char>, aoc::load_grid<char>);
+}
+
+} // namespace day14
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day14;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
 
-	auto rocks = parse_rocks(*input);
+	auto input = aoc::map_input(argc, argv);
 
-	int64_t load = move_rocks_dir(rocks, 0, -1); // NORTH
-	std::cout << "(Part 1) Load on north support beam: " << load << std::endl;
+	auto rocks = parse_rocks(input.view());
 
-	load = do_cycles(rocks);
-	std::cout << "(Part 2) Load on north support beam: " << load << std::endl;
+	std::cout << "(Part 1) Load on north support beam: " << north_load(rocks) << std::endl;
+	std::cout << "(Part 2) Load on north support beam: " << north_load_cycled(rocks) << std::endl;
 
 	return EXIT_SUCCESS;
 }
+#endif // AOC_NO_MAIN
@@ -4,7 +4,9 @@
 #include <list>
 #include <algorithm>
 
-static auto const LOCALE = aoc::create_delimitor_locale<',', '=', '-'>();
+namespace day15 {
+
+static aoc::Charset const DELIMITERS(",=- \n");
 
 int64_t hash(std::string const& str) {
 	int64_t const MULTIPLIER = 17;
@@ -30,21 +32,21 @@ struct Instruction {
 	Lens lens;
 	char op;
 };
-std::vector<Instruction> parse_instructions(std::istream& stream) {
+std::vector<Instruction> parse_instructions(aoc::StringView input) {
+	aoc::ScopedTimer timer("day15 parse");
+
 	std::vector<Instruction> instructions;
 
-	stream.imbue(LOCALE);
-	std::string s;
-	int64_t x;
+	aoc::Scanner sc(input);
 
-	while (stream >> s) {
+	for (auto s = sc.next_token(DELIMITERS); !s.empty(); s = sc.next_token(DELIMITERS)) {
 		Instruction in;
 
-		in.lens.key = s;
-		in.op = stream.get();
+		in.lens.key = s.str();
+		in.op = sc.get();
 
 		if (in.op == '=') {
-			stream >> in.lens.value;
+			sc.next_int(in.lens.value);
 		}
 
 		instructions.push_back(in);
@@ -87,29 +89,52 @@ int64_t calculate_focus_power(std::vector<box_t> const& boxes) {
 	return sum;
 }
 
+int64_t sum_hashes(std::vector<Instruction> const& instructions) {
+	aoc::ScopedTimer timer("day15 part1");
+	return aoc::sum(instructions, [](Instruction const& i) {
+		std::string v;
+		if (i.op == '=') {
+			v = std::to_string(i.lens.value);
+		}
+		return hash(i.lens.key + i.op + v);
+	});
+}
+
+int64_t focus_power(std::vector<Instruction> const& instructions) {
+	aoc::ScopedTimer timer("day15 part2");
 
+	std::vector<box_t> boxes(256, box_t());
+	insert_lenses(boxes, instructions);
+	return calculate_focus_power(boxes);
+}
+
+aoc::Solution solution() {
+	return aoc::make_solution(15, "lens", parse_instructions, sum_hashes, focus_power);
+}
+
+} // namespace day15
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day15;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
-	auto instructions = parse_instructions(*input);
+	auto instructions = parse_instructions(input.view());
 
 	std::cout << "(Part 1) Sum of results: "
-		<< aoc::sum(instructions, [](Instruction const& i) {
-			std::string v;
-			if (i.op == '=') {
-				v = std::to_string(i.lens.value);
-			}
-			return hash(i.lens.key + i.op + v);
-		})
+		<< sum_hashes(instructions)
 		<< std::endl;
 
 	// Part 2
-	std::vector<box_t> boxes(256, box_t());
-	insert_lenses(boxes, instructions);
-
 	std::cout << "(Part 2) Resulting focus power: "
-		<< calculate_focus_power(boxes)
+		<< focus_power(instructions)
 		<< std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
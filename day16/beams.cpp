@@ -1,126 +1,171 @@
 #include "common.h"
 #include "vec2.h"
+#include "grid.h"
+#include "parse_cache.h"
+#include "search.h"
+#include "thread_pool.h"
 
 #include <vector>
-#include <unordered_set>
-#include <set>
-#include <stack>
 
-using grid_t = std::vector<std::string>;
+namespace day16 {
 
-grid_t parse_grid(std::istream& stream) {
-	auto lines = aoc::Lines(stream);
-	return grid_t(lines.begin(), lines.end());
-}
+// Bordered with '\0', a beam on the border has left the contraption
+using grid_t = Grid<char>;
+static char const OUTSIDE = '\0';
 
-// For set
-template <>
-bool Vec2::operator<(Vec2 const& rhs) const {
-	if (y == rhs.y) {
-		return (x < rhs.x);
-	}
-	return (y < rhs.y);
+grid_t parse_grid(aoc::StringView input) {
+	aoc::ScopedTimer timer("day16 parse");
+	return grid_t::from_lines(input, 1, OUTSIDE);
 }
 
 struct Beam {
 	Vec2 p, d;
+};
+
+// Directions in turning order
+static Vec2 const DIRS[4] = {Vec2::right(), Vec2::up(), Vec2::left(), Vec2::down()};
+
+size_t dir_index(Vec2 d) {
+	return d.x == 1 ? 0 : d.y == -1 ? 1 : d.x == -1 ? 2 : 3;
+}
+
+// A state is a beam: the cell it's on (index into the bordered grid) and the
+// direction it's going
+struct Contraption {
+	grid_t const& grid;
+	aoc::DenseStates states;
+	std::ptrdiff_t offsets[4];
 
-	bool operator==(Beam const& rhs) const {
-		return (p == rhs.p && d == rhs.d);
+	explicit Contraption(grid_t const& grid) : grid(grid), states({grid.size(), 4}) {
+		for (size_t d = 0; d < 4; ++d) {
+			offsets[d] = grid.offset(DIRS[d]);
+		}
 	}
-};
 
-// For unordered_set
-template <>
-struct std::hash<Beam> {
-	size_t operator()(Beam const& b) const {
-		return std::hash<std::string>()(b.p.to_string() + b.d.to_string());
+	uint32_t encode(Beam const& b) const {
+		return states.encode({grid.index(b.p), dir_index(b.d)});
 	}
-};
 
-std::vector<Beam> move_beam(Beam curr, char c) {
-	switch (c) {
-		case '-': {
-			if (curr.d.y != 0) {
-				// split beam
-				return { { curr.p, Vec2::left() }, { curr.p, Vec2::right() } };
+	size_t cell(uint32_t s) const { return states.decode(s, 0); }
+
+	// The beam(s) a beam turns into after passing its tile
+	template <typename Emit>
+	void operator()(uint32_t s, Emit const& emit) const {
+		size_t cell = states.decode(s, 0);
+		Vec2 d = DIRS[states.decode(s, 1)];
+		switch (grid[cell]) {
+			case '-': {
+				if (d.y != 0) {
+					// split beam
+					emit(states.encode({cell, dir_index(Vec2::left())}), 1);
+					emit(states.encode({cell, dir_index(Vec2::right())}), 1);
+					return ;
+				}
+				break ;
 			}
-			break ;
-		}
-		case '|': {
-			if (curr.d.x != 0) {
-				// split beam
-				return { { curr.p, Vec2::up() }, { curr.p, Vec2::down() } };
+			case '|': {
+				if (d.x != 0) {
+					// split beam
+					emit(states.encode({cell, dir_index(Vec2::up())}), 1);
+					emit(states.encode({cell, dir_index(Vec2::down())}), 1);
+					return ;
+				}
+				break ;
+			}
+			case '/': {
+				// rotate self
+				d = { -d.y, -d.x };
+				break ;
+			}
+			case '\\': {
+				d = { d.y, d.x };
+				break ;
 			}
-			break ;
-		}
-		case '/': {
-			// rotate self
-			curr.d = { -curr.d.y, -curr.d.x };
-			break ;
 		}
-		case '\\': {
-			curr.d = { curr.d.y, curr.d.x };
-			break ;
+		size_t dir = dir_index(d);
+		size_t next = cell + offsets[dir];
+		if (grid[next] != OUTSIDE) {
+			emit(states.encode({next, dir}), 1);
 		}
 	}
-	curr.p = curr.p + curr.d;
-	return { curr };
-}
+};
 
-int64_t solve(grid_t & grid, Beam start) {
-	std::unordered_set<Beam> energized;
-	energized.insert(start);
-
-	std::stack<Beam> beams;
-	beams.push(start);
-	while (!beams.empty()) {
-		Beam curr = beams.top(); beams.pop();
-		energized.insert(curr);
-
-		auto new_beams = move_beam(curr, grid[curr.p.y][curr.p.x]);
-		for (auto b : new_beams) {
-			if (energized.count(b) > 0 ||
-			    !b.p.is_within_bounds({}, Vec2(grid[0].length() - 1, grid.size() - 1))) {
-				continue ;
-			}
-			beams.push(b);
-		}
-	}
+// Cells energized by a beam entering at start. search and lit are only scratch
+// space, passed in so part 2 reuses them for every start instead of allocating
+// them again.
+int64_t solve(Contraption const& contraption, Beam start, aoc::Traversal& search, std::vector<char>& lit) {
+	lit.assign(contraption.grid.size(), 0);
+	uint32_t const sources[] = {contraption.encode(start)};
 
-	// Only take unique positions
-	std::set<Vec2> unique;
-	for (auto const& e : energized) {
-		unique.insert(e.p);
-	}
-	return unique.size();
+	int64_t energized = 0;
+	search.depth_first(contraption.states.count(), sources, contraption, [&](uint32_t s) {
+		char& l = lit[contraption.cell(s)];
+		energized += !l;
+		l = 1;
+	});
+	return energized;
 }
 
-int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+int64_t energized_top_left(grid_t const& grid) {
+	aoc::ScopedTimer timer("day16 part1");
 
-	auto grid = parse_grid(*input);
+	Contraption contraption(grid);
+	aoc::Traversal search;
+	std::vector<char> lit;
+	return solve(contraption, {{0, 0}, Vec2::right()}, search, lit);
+}
 
-	std::cout << "(Part 1) Energized tiles: " << solve(grid, {{0, 0}, Vec2::right()}) << std::endl;
+int64_t energized_max(grid_t const& grid) {
+	aoc::ScopedTimer timer("day16 part2");
 
-	// Part 2
 	// Do the same but for every column/row and then get the max
-	int64_t energized = 0;
-	for (int64_t y = 0; y < grid.size(); ++y) {
-		int64_t maxy = std::max(
-			solve(grid, {{0, y}, Vec2::right()}),
-			solve(grid, {Vec2(grid[0].length() - 1, y), Vec2::left()}));
-		energized = std::max(energized, maxy);
+	std::vector<Beam> starts;
+	for (int64_t y = 0; y < grid.height(); ++y) {
+		starts.push_back({{0, y}, Vec2::right()});
+		starts.push_back({Vec2(grid.width() - 1, y), Vec2::left()});
+	}
+	for (int64_t x = 0; x < grid.width(); ++x) {
+		starts.push_back({{x, 0}, Vec2::down()});
+		starts.push_back({Vec2(x, grid.height() - 1), Vec2::up()});
 	}
 
-	for (int64_t x = 0; x < grid[0].length(); ++x) {
-		int64_t maxx = std::max(
-			solve(grid, {{x, 0}, Vec2::down()}),
-			solve(grid, {Vec2(x, grid.size() - 1), Vec2::up()}));
-		energized = std::max(energized, maxx);
+	// Every start is on its own, every piece of them reuses its own search
+	Contraption contraption(grid);
+	std::vector<int64_t> energized(starts.size());
+	aoc::parallel_for(0, starts.size(), [&](size_t begin, size_t end) {
+		aoc::Traversal search;
+		std::vector<char> lit;
+		for (size_t i = begin; i < end; ++i) {
+			energized[i] = solve(contraption, starts[i], search, lit);
+		}
+	});
+	return energized.empty() ? 0 : *std::max_element(energized.begin(), energized.end());
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(16, "beams", parse_grid, energized_top_left, energized_max),
+		1, aoc::save_grid<char>, aoc::load_grid<char>);
+}
+
+} // namespace day16
+
+#ifndef AOC_NO_MAIN
+int main(int argc, char** argv) {
+	using namespace day16;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
 	}
 
-	std::cout << "(Part 2) Energized tiles: " << energized << std::endl;
+	auto input = aoc::map_input(argc, argv);
+
+	auto grid = parse_grid(input.view());
+
+	std::cout << "(Part 1) Energized tiles: " << energized_top_left(grid) << std::endl;
+
+	// Part 2
+	std::cout << "(Part 2) Energized tiles: " << energized_max(grid) << std::endl;
 
 	return EXIT_SUCCESS;
 }
+#endif // AOC_NO_MAIN
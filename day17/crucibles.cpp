@@ -1,128 +1,120 @@
 #include "common.h"
 #include "vec2.h"
+#include "grid.h"
+#include "parse_cache.h"
+#include "search.h"
 
 #include <vector>
-#include <queue>
-#include <unordered_map>
 
-using grid_t = std::vector<std::string>;
+namespace day17 {
 
-grid_t parse_grid(std::istream& stream) {
-	auto lines = aoc::Lines(stream);
-	return grid_t(lines.begin(), lines.end());
-}
-
-struct Permutation {
-	Vec2 pos;
-	Vec2 dir;
-	int64_t count;
-
-	bool operator==(Permutation const& rhs) const {
-		return (pos == rhs.pos && dir == rhs.dir && count == rhs.count);
-	}
-
-	std::string to_string() const {
-		return (pos.to_string() + dir.to_string() + std::to_string(count));
-	}
-
-	size_t hash() const {
-		return std::hash<std::string>()(to_string());
-	}
-};
-
-// Hash permutations for the distance map
-template <>
-struct std::hash<Permutation> {
-	size_t operator()(Permutation const& d) const {
-		return d.hash();
-	}
-};
-
-struct Data {
-	size_t cost;
-	Permutation data;
-
-	bool operator<(Data const& rhs) const {
-		return cost > rhs.cost; // needs to be sorted based on cost being higher
-	}
-
-	bool operator==(Data const& rhs) const {
-		return (cost == rhs.cost && data == rhs.data);
-	}
+// Bordered with '\0', which is never a valid cost
+using grid_t = Grid<char>;
+static char const OUTSIDE = '\0';
 
-};
-
-int64_t get_min(std::unordered_map<Permutation, int64_t> const& distances, Vec2 const end) {
-	int64_t min_distance = INT64_MAX;
-	for (auto const& p : distances) {
-		if (p.first.pos == end) {
-			min_distance = std::min(min_distance, p.second);
-		}
-	}
-	return min_distance;
+grid_t parse_grid(aoc::StringView input) {
+	aoc::ScopedTimer timer("day17 parse");
+	return grid_t::from_lines(input, 1, OUTSIDE);
 }
 
-template <bool PART2>
-int64_t solve(grid_t const& grid) {
-	Vec2 const END_POS (grid[0].length() - 1, grid.size() - 1);
-
-	std::priority_queue<Data> q;
-	q.push({0, {{}, Vec2::right(), 0}}); // RIGHT
-	q.push({0, {{}, Vec2::down(), 0}}); // DOWN
-
-	std::unordered_map<Permutation, int64_t> distances;
-
-	while (!q.empty()) {
-		Data q_current = q.top(); q.pop();
-		Permutation& curr = q_current.data;
-
-		if (curr.pos == END_POS) {
-			return q_current.cost;
-		}
-		
-		if (distances.find(curr) != distances.end()) {
-			continue;
+// Directions in turning order, the opposite of d is (d + 2) % 4
+static Vec2 const DIRS[4] = {Vec2::right(), Vec2::up(), Vec2::left(), Vec2::down()};
+static size_t const RIGHT = 0, DOWN = 3;
+// steps in the same direction, 0 only at the start
+static size_t const MAX_COUNT = 10;
+
+// A state is a cell (index into the bordered grid), the direction the crucible
+// came in with and how many steps it's been going that way
+struct Crucibles {
+	grid_t const& grid;
+	aoc::DenseStates states;
+	bool ultra;
+	std::ptrdiff_t offsets[4];
+
+	Crucibles(grid_t const& grid, bool ultra) : grid(grid), states({grid.size(), 4, MAX_COUNT + 1}), ultra(ultra) {
+		for (size_t d = 0; d < 4; ++d) {
+			offsets[d] = grid.offset(DIRS[d]);
 		}
+	}
 
-		distances[curr] = q_current.cost;
+	size_t cell(uint32_t s) const { return states.decode(s, 0); }
 
-		std::initializer_list<Vec2> DIRS {Vec2::right(), Vec2::up(), Vec2::left(), Vec2::down()};
-		for (auto const& new_dir : DIRS) {
+	template <typename Emit>
+	void operator()(uint32_t s, Emit const& emit) const {
+		size_t cell = states.decode(s, 0);
+		size_t dir = states.decode(s, 1);
+		size_t count = states.decode(s, 2);
+		for (size_t new_dir = 0; new_dir < 4; ++new_dir) {
 			// Can't reverse
-			if (curr.dir == -new_dir) {
+			if (new_dir == (dir + 2) % 4) {
 				continue ;
 			}
 
-			Vec2 new_pos = curr.pos + new_dir;
+			size_t new_cell = cell + offsets[new_dir];
 			// bounds check
-			if (!new_pos.is_within_bounds({0, 0}, END_POS)) {
+			char c = grid[new_cell];
+			if (c == OUTSIDE) {
 				continue ;
 			}
 
-			int64_t new_count = (new_dir != curr.dir) ? 1 : curr.count + 1;
+			size_t new_count = (new_dir != dir) ? 1 : count + 1;
 
 			// max of 3 in same direction
-			if (!PART2 && new_count > 3) {
+			if (!ultra && new_count > 3) {
 				continue ;
-			} else if (PART2 && !(new_count <= 10 && (new_dir == curr.dir || curr.count >= 4))) {
+			} else if (ultra && !(new_count <= MAX_COUNT && (new_dir == dir || count >= 4))) {
 				continue ;
 			}
 
-			char cost = grid[new_pos.y][new_pos.x] - '0';
-			q.push({q_current.cost + cost, {new_pos, new_dir, new_count}});
+			emit(states.encode({new_cell, new_dir, new_count}), uint64_t(c - '0'));
 		}
-
 	}
-	return get_min(distances, END_POS);
+};
+
+// Costs are single digits, so Dial's buckets beat a heap
+using search_t = aoc::ShortestPaths<aoc::BucketQueue>;
+
+template <bool PART2>
+int64_t solve(grid_t const& grid) {
+	aoc::ScopedTimer timer(PART2 ? "day17 part2" : "day17 part1");
+
+	Crucibles crucibles(grid, PART2);
+	size_t start = grid.index(0, 0);
+	size_t end = grid.index(grid.width() - 1, grid.height() - 1);
+
+	uint32_t const sources[] = {crucibles.states.encode({start, RIGHT, 0}), crucibles.states.encode({start, DOWN, 0})};
+
+	aoc::Counter pops("day17 pops");
+	aoc::Counter stale_pops("day17 stale pops");
+	search_t search(aoc::BucketQueue(9));
+	search.count_pops(pops, stale_pops);
+	uint32_t found = search.dijkstra(crucibles.states.count(), sources, crucibles,
+		[&](uint32_t s) { return crucibles.cell(s) == end; });
+	return found == search_t::NONE ? INT64_MAX : int64_t(search.distance(found));
 }
 
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(17, "crucibles", parse_grid, solve<false>, solve<true>),
+		1, aoc::save_grid<char>, aoc::load_grid<char>);
+}
+
+} // namespace day17
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char**argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day17;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
-	auto grid = parse_grid(*input);
+	auto grid = parse_grid(input.view());
 
 	std::cout << "(Part 1) Least heat loss: " << solve<false>(grid) << std::endl;
 	std::cout << "(Part 2) Least heat loss: " << solve<true>(grid) << std::endl;
 
 	return EXIT_SUCCESS;
 }
+#endif // AOC_NO_MAIN
@@ -2,7 +2,8 @@
 #include "vec2.h"
 
 #include <vector>
-#include <sstream>
+
+namespace day18 {
 
 struct Instruction {
 	char direction;
@@ -11,23 +12,27 @@ struct Instruction {
 	uint64_t true_count;
 };
 
-std::vector<Instruction> parse_instructions(std::istream& stream) {
+std::vector<Instruction> parse_instructions(aoc::StringView input) {
+	aoc::ScopedTimer timer("day18 parse");
+
 	std::vector<Instruction> instructions;
-	for (auto const& l : aoc::Lines(stream)) {
+	for (auto const& l : aoc::ViewLines(input)) {
 
 		Instruction inst;
 
-		std::istringstream ss(l);
-		std::string hex;
-		ss >> inst.direction >> inst.count >> hex;
-
-		inst.true_count = std::stoull(hex.substr(2, 5), 0, 16);
-		char c = hex[hex.length() - 2];
-		switch (c) {
-			case '0': c = 'R'; break;
-			case '1': c = 'D'; break;
-			case '2': c = 'L'; break;
-			case '3': c = 'U'; break;
+		aoc::Scanner sc(l);
+		inst.direction = sc.get();
+		sc.next_int(inst.count);
+
+		// (#70c710): first 5 hex digits are the count, the last the direction
+		uint64_t hex = sc.next_hex<uint64_t>();
+		inst.true_count = hex >> 4;
+		char c = 0;
+		switch (hex & 0xF) {
+			case 0: c = 'R'; break;
+			case 1: c = 'D'; break;
+			case 2: c = 'L'; break;
+			case 3: c = 'U'; break;
 		}
 		inst.true_dir = c;
 
@@ -60,6 +65,8 @@ int64_t polygonal_area(std::vector<Vec2> const& lines) {
 
 template <bool PART2 = false>
 int64_t calculate_area(std::vector<Instruction> const& instructions) {
+	aoc::ScopedTimer timer(PART2 ? "day18 part2" : "day18 part1");
+
 	std::vector<Vec2> lines;
 	int64_t total_length = 0;
 
@@ -80,13 +87,27 @@ int64_t calculate_area(std::vector<Instruction> const& instructions) {
 	return polygonal_area(lines) + total_length / 2 + 1;
 }
 
+aoc::Solution solution() {
+	return aoc::make_solution(18, "lavaduct", parse_instructions, calculate_area<false>, calculate_area<true>);
+}
+
+} // namespace day18
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day18;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
-	auto instructions = parse_instructions(*input);
+	auto instructions = parse_instructions(input.view());
 
 	std::cout << "(Part 1) Area: " << calculate_area(instructions) << std::endl;
 	std::cout << "(Part 1) Area: " << calculate_area<true>(instructions) << std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
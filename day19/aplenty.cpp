@@ -1,11 +1,15 @@
 #include "common.h"
 #include "range.h"
+#include "arena.h"
+#include "interner.h"
+#include "parse_cache.h"
 
+#include <array>
 #include <vector>
-#include <unordered_map>
-#include <sstream>
 
-static auto const LOCALE = aoc::create_delimitor_locale<'{','}', ',', '='>();
+namespace day19 {
+
+static aoc::Charset const DELIMITERS("{},=");
 
 enum RatingEnum {
 	X = 0,
@@ -25,49 +29,76 @@ RatingEnum rating_from_c(char c) {
 	return X;
 }
 
+using workflow_id = aoc::Interner::id_t;
+
+// Interned first, so they are always these ids
+static workflow_id const ACCEPTED = 0, REJECTED = 1;
+
 struct Rule {
 	RatingEnum c;
 	char op;
 	int64_t value;
-	std::string key;
+	workflow_id key;
 
-	void parse(std::string const& str) {
+	void parse(aoc::StringView str, aoc::Interner& names) {
 		c = rating_from_c(str[0]);
 		op = str[1];
-		value = std::stoll(str.substr(2, str.find_first_of(':') - 2));
-		key = str.substr(str.find_first_of(':') + 1);
+		aoc::Scanner sc(str.substr(2));
+		sc.next_int(value);
+		key = names.intern(sc.expect(":").rest());
 	}
 };
 
-using workflows_t = std::unordered_map<std::string, std::vector<Rule>>;
-workflows_t parse_workflows(std::istream& stream) {
+// Workflow names are only looked at while parsing, following a rule is
+// indexing into rules by id
+struct Workflows {
+	aoc::Interner names;
+	std::vector<std::vector<Rule>> rules; // by id
+
+	std::vector<Rule> const& at(workflow_id id) const {
+		if (id >= rules.size() || rules[id].empty()) {
+			throw std::runtime_error("Unknown workflow " + (id < names.size() ? names.name(id) : "?"));
+		}
+		return rules[id];
+	}
+};
+
+using workflows_t = Workflows;
+// consumes the workflows and the empty line after them from input
+workflows_t parse_workflows(aoc::StringView& input) {
 	workflows_t workflows;
-	for (auto const& l : aoc::Lines(stream)) {
+	workflows.names.intern("A");
+	workflows.names.intern("R");
+
+	while (!input.empty()) {
+		auto l = aoc::next_line(input);
 
 		if (l.empty()) {
-			return workflows;
+			break ;
 		}
 
-		std::istringstream ss(l); ss.imbue(LOCALE);
-
-		std::string key, tmp;
-		ss >> key;
+		aoc::Scanner sc(l);
 
-		workflows.insert({key, {}});
-		auto& rules = workflows.at(key);
-		while (ss >> tmp) {
+		workflow_id id = workflows.names.intern(sc.next_token(DELIMITERS));
+		std::vector<Rule> rules;
+		for (auto tmp = sc.next_token(DELIMITERS); !tmp.empty(); tmp = sc.next_token(DELIMITERS)) {
 			Rule r;
-			if (tmp.find(':') != std::string::npos) {
-				r.parse(tmp);
+			if (tmp.find(':') != aoc::StringView::npos) {
+				r.parse(tmp, workflows.names);
 			} else {
 				r.c = NONE;
 				r.op = 0;
 				r.value = 0;
-				r.key = tmp;
+				r.key = workflows.names.intern(tmp);
 			}
 			rules.push_back(r);
 		}
+		if (workflows.rules.size() <= id) {
+			workflows.rules.resize(id + 1);
+		}
+		workflows.rules[id].swap(rules);
 	}
+	workflows.rules.resize(workflows.names.size());
 	return workflows;
 }
 
@@ -79,15 +110,18 @@ struct Rating {
 	}
 };
 
-std::vector<Rating> parse_ratings(std::istream& stream) {
+std::vector<Rating> parse_ratings(aoc::StringView input) {
 	std::vector<Rating> ratings;
-	for (auto const& l : aoc::Lines(stream)) {
+	for (auto const& l : aoc::ViewLines(input)) {
 		Rating r;
 
-		std::istringstream ss(l); ss.imbue(LOCALE);
+		aoc::Scanner sc(l);
 
-		char tmp;
-		ss >> tmp >> r.r[X] >> tmp >> r.r[M] >> tmp >> r.r[A] >> tmp >> r.r[S];
+		// {x=787,m=2655,a=1222,s=2876}
+		sc.next_int(r.r[X]);
+		sc.next_int(r.r[M]);
+		sc.next_int(r.r[A]);
+		sc.next_int(r.r[S]);
 
 		ratings.push_back(r);
 	}
@@ -102,7 +136,7 @@ bool greater_then(int64_t x, int64_t n) {
 	return x > n;
 }
 
-std::string next_key(std::vector<Rule> const& rules, Rating const& r) {
+workflow_id next_key(std::vector<Rule> const& rules, Rating const& r) {
 	for (auto const& rule : rules) {
 		if (rule.c == NONE) {
 			return rule.key;
@@ -117,19 +151,19 @@ std::string next_key(std::vector<Rule> const& rules, Rating const& r) {
 			return rule.key;
 		}
 	}
-	return {};
+	return aoc::Interner::NONE;
 }
 
 std::vector<Rating> trace_ratings(workflows_t const& workflows, std::vector<Rating> const& ratings) {
-	static std::string const START_KEY = "in";
+	workflow_id start = workflows.names.find("in");
 
 	std::vector<Rating> accepted;
 	for (auto const& r : ratings) {
-		std::string key = START_KEY;
-		while (key != "A" && key != "R") {
+		workflow_id key = start;
+		while (key != ACCEPTED && key != REJECTED) {
 			key = next_key(workflows.at(key), r);
 		}
-		if (key == "A") {
+		if (key == ACCEPTED) {
 			accepted.push_back(r);
 			continue ;
 		}
@@ -137,77 +171,171 @@ std::vector<Rating> trace_ratings(workflows_t const& workflows, std::vector<Rati
 	return accepted;
 }
 
-using ranges_t = std::unordered_map<RatingEnum, Range>;
+// Values every rating can still have, indexed by RatingEnum
+using rating_set_t = BasicIntervalSet<aoc::ArenaAllocator<Range>>;
+using ranges_t = std::array<rating_set_t, NONE>;
+using accepted_ranges_t = aoc::arena_vector<ranges_t>;
+
+// Every combination of ranges that ends up accepted starting at key, appended
+// to accepted. The sets live in the scratch arena, copying them for a branch
+// doesn't touch the heap.
+void trace_ranges(workflows_t const& workflows, ranges_t ranges, workflow_id key, accepted_ranges_t& accepted) {
+	if (key == REJECTED) return ;
+	if (key == ACCEPTED) {
+		accepted.push_back(ranges);
+		return ;
+	}
+
+	auto const& rules = workflows.at(key);
+	for (auto const& rule : rules) {
+		if (rule.c == NONE) {
+			trace_ranges(workflows, ranges, rules.back().key, accepted);
+			continue ;
+		}
 
-void merge_ranges(ranges_t& merge, ranges_t const& other) {
-	for (auto const& pair : other) {
-		merge[pair.first] = pair.second;
+		// values sent to rule.key and the rest, going on to the next rule
+		bool less = (rule.op == '<');
+		auto halves = ranges[rule.c].split(less ? rule.value : rule.value + 1);
+		rating_set_t& sent = less ? halves.first : halves.second;
+		rating_set_t& rest = less ? halves.second : halves.first;
+		if (!sent.empty()) {
+			ranges_t copy(ranges);
+			copy[rule.c] = sent;
+			trace_ranges(workflows, copy, rule.key, accepted);
+		}
+		if (rest.empty()) {
+			return ;
+		}
+		ranges[rule.c] = rest;
 	}
 }
 
-std::vector<ranges_t> trace_ranges(workflows_t const& workflows, ranges_t ranges, std::string key) {
-	if (key == "R") return {};
-	if (key == "A") return {ranges};
+struct System {
+	workflows_t workflows;
+	std::vector<Rating> ratings;
+};
 
-	std::vector<ranges_t> accepted {};
-	for (auto const& rule : workflows.at(key)) {
-		if (rule.c == NONE) {
-			auto add = trace_ranges(workflows, ranges, workflows.at(key).back().key);
-			accepted.insert(accepted.end(), add.begin(), add.end());
-			continue ;
+System parse_system(aoc::StringView input) {
+	aoc::ScopedTimer timer("day19 parse");
+
+	System system;
+	system.workflows = parse_workflows(input);
+	system.ratings = parse_ratings(input);
+	return system;
+}
+
+// For the parse cache: every rule in one array, workflow id i owns
+// rules [ends[i - 1], ends[i]). Rules go field by field, a raw Rule would
+// take its padding along and the same input wouldn't always give the same file.
+void save_system(aoc::BinaryWriter& out, System const& system) {
+	std::vector<uint32_t> ends;
+	uint32_t count = 0;
+	for (auto const& workflow : system.workflows.rules) {
+		count += uint32_t(workflow.size());
+		ends.push_back(count);
+	}
+	out.write(system.workflows.names);
+	out.write<uint64_t>(count);
+	for (auto const& workflow : system.workflows.rules) {
+		for (auto const& r : workflow) {
+			out.write(r.c);
+			out.write(r.op);
+			out.write(r.value);
+			out.write(r.key);
 		}
+	}
+	out.write(ends);
+	out.write(system.ratings);
+}
 
-		Range r = ranges[rule.c];
-		switch (rule.op) {
-			case '<': {
-				ranges_t copy(ranges);
-				copy[rule.c] = Range(r.begin, rule.value - 1);
-				auto add = trace_ranges(workflows, copy, rule.key);
-				accepted.insert(accepted.end(), add.begin(), add.end());
-				ranges[rule.c]= Range(rule.value, r.end);
-			} break ;
-			case '>': {
-				ranges_t copy(ranges);
-				copy[rule.c] = Range(rule.value + 1, r.end);
-				auto add = trace_ranges(workflows, copy, rule.key);
-				accepted.insert(accepted.end(), add.begin(), add.end());
-				ranges[rule.c] = Range(r.begin, rule.value);
-			} break ;
+System load_system(aoc::BinaryReader& in) {
+	System system;
+	std::vector<Rule> rules;
+	std::vector<uint32_t> ends;
+	in.read(system.workflows.names);
+	for (uint64_t n = in.read<uint64_t>(); n > 0; --n) {
+		Rule r;
+		r.c = in.read<RatingEnum>();
+		r.op = in.read<char>();
+		r.value = in.read<int64_t>();
+		r.key = in.read<workflow_id>();
+		rules.push_back(r);
+	}
+	in.read(ends);
+	in.read(system.ratings);
+
+	size_t n = system.workflows.names.size();
+	if (ends.size() != n || (n > 0 && ends.back() != rules.size())) {
+		throw std::runtime_error("Bad cached workflows");
+	}
+	for (auto const& r : rules) {
+		if (r.key >= n || r.c < X || r.c > NONE) {
+			throw std::runtime_error("Bad cached workflows");
 		}
 	}
-	return accepted;
+	system.workflows.rules.resize(n);
+	uint32_t begin = 0;
+	for (size_t id = 0; id < n; ++id) {
+		if (ends[id] < begin || ends[id] > rules.size()) {
+			throw std::runtime_error("Bad cached workflows");
+		}
+		system.workflows.rules[id].assign(rules.begin() + begin, rules.begin() + ends[id]);
+		begin = ends[id];
+	}
+	return system;
+}
+
+int64_t sum_accepted(System const& system) {
+	aoc::ScopedTimer timer("day19 part1");
+
+	auto accepted = trace_ratings(system.workflows, system.ratings);
+	return aoc::sum(accepted, &Rating::sum);
 }
 
+int64_t combinations_accepted(System const& system) {
+	aoc::ScopedTimer timer("day19 part2");
+
+	static uint64_t const MIN = 1, MAX = 4000;
+
+	aoc::ArenaScope scope(aoc::scratch_arena());
+	rating_set_t all(Range(MIN, MAX + 1), scope.arena());
+	ranges_t ranges = {{all, all, all, all}};
+	accepted_ranges_t accepted_ranges(scope.arena());
+	trace_ranges(system.workflows, ranges, system.workflows.names.find("in"), accepted_ranges);
+	return aoc::sum(accepted_ranges, [](ranges_t const& ranges) {
+		return aoc::product(ranges, &rating_set_t::size);
+	});
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(19, "aplenty", parse_system, sum_accepted, combinations_accepted),
+		2, save_system, load_system);
+}
+
+} // namespace day19
+
+#ifndef AOC_NO_MAIN
 int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+	using namespace day19;
+
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
 
-	auto workflows = parse_workflows(*input);
-	auto ratings = parse_ratings(*input);
+	auto system = parse_system(input.view());
 
 	// PART 1
-	auto accepted = trace_ratings(workflows, ratings);
 	std::cout << "(Part 1) Sum of ratings of accepted parts: "
-		<< aoc::sum(accepted, &Rating::sum)
+		<< sum_accepted(system)
 		<< std::endl;
 	
 	// PART 2
-	static std::string const START_KEY = "in";
-	static uint64_t const MIN = 1, MAX = 4000;
-	ranges_t ranges {
-		{X, {MIN, MAX}},
-		{M, {MIN, MAX}},
-		{A, {MIN, MAX}},
-		{S, {MIN, MAX}}
-	};
-
-	auto accepted_ranges = trace_ranges(workflows, ranges, START_KEY);
 	std::cout << "(Part 2) Distinct combinations of ratings accepted: "
-		<< aoc::sum(accepted_ranges, [](ranges_t const& ranges) {
-			return aoc::product(ranges, [](ranges_t::value_type const& pair) {
-				return pair.second.end - pair.second.begin + 1;
-			});
-		})
+		<< combinations_accepted(system)
 		<< std::endl;
 
 	return EXIT_SUCCESS;
 }
+#endif // AOC_NO_MAIN
@@ -1,11 +1,16 @@
 #include "common.h"
+#include "arena.h"
+#include "interner.h"
+#include "flat_map.h"
+#include "parse_cache.h"
 
 #include <vector>
 #include <unordered_map>
-#include <sstream>
 #include <numeric>
 
-static auto const LOCALE = aoc::create_delimitor_locale<',', '-', '>'>();
+namespace day20 {
+
+static aoc::Charset const DELIMITERS(",-> ");
 
 enum Signal {
 	LOW,
@@ -18,17 +23,37 @@ enum ModuleType {
 	CONJUNCTION
 };
 
+// Module names are interned while parsing, everything after that works on ids
+using module_id = aoc::Interner::id_t;
+
+struct SignalSend {
+	Signal sig;
+	module_id to;
+	module_id from;
+};
+
+using signals_t = aoc::arena_vector<SignalSend>;
+
 struct Module {
-	using signals_t = std::vector<std::pair<Signal, std::string>>;
 
 	Module(ModuleType t) : type(t) {}
 
 	virtual ~Module() {}
 
-	std::vector<std::string> destination;
+	std::vector<module_id> destination;
 	ModuleType type;
 
-	virtual signals_t on_signal_recv(std::string const& from, Signal sig) = 0;
+	// Receive sig sent by from (this module is self) and queue what it sends
+	virtual void on_signal_recv(module_id from, module_id self, Signal sig, signals_t& out) = 0;
+	virtual Module* clone() const = 0;
+	// Append what this module remembers, to compare states
+	virtual void save_state(std::vector<char>& out) const { (void)out; }
+
+	void send(module_id self, Signal sig, signals_t& out) const {
+		for (module_id d : destination) {
+			out.push_back({sig, d, self});
+		}
+	}
 
 };
 
@@ -36,27 +61,32 @@ struct FlipFlop : public Module {
 	FlipFlop() : Module(FLIPFLOP), is_on(false) {}
 	bool is_on;
 
-	signals_t on_signal_recv(std::string const& from, Signal sig) {
+	Module* clone() const { return new FlipFlop(*this); }
+	void save_state(std::vector<char>& out) const { out.push_back(is_on); }
+
+	void on_signal_recv(module_id from, module_id self, Signal sig, signals_t& out) {
 		(void)from;
 		// update when receiving LOW signal, HIGH is ignored
-		if (sig == HIGH) return {};
+		if (sig == HIGH) return ;
 
 		sig = is_on ? LOW : HIGH;
 		is_on = !is_on;
-
-		signals_t send;
-		for (auto const& d : destination) {
-			send.emplace_back(sig, d);
-		}
-		return send;
+		send(self, sig, out);
 	}
 };
 
 struct Conjunction : public Module {
 	Conjunction() : Module(CONJUNCTION) {}
-	std::unordered_map<std::string, Signal> inputs;
+	aoc::FlatMap<module_id, Signal> inputs;
+
+	Module* clone() const { return new Conjunction(*this); }
+	void save_state(std::vector<char>& out) const {
+		for (auto const& pair : inputs) {
+			out.push_back(char(pair.second));
+		}
+	}
 
-	signals_t on_signal_recv(std::string const& from, Signal sig) {
+	void on_signal_recv(module_id from, module_id self, Signal sig, signals_t& out) {
 		// Update inputs and send signal if all are high
 		inputs[from] = sig;
 		sig = LOW;
@@ -65,93 +95,215 @@ struct Conjunction : public Module {
 				sig = HIGH;
 			}
 		}
-
-		signals_t send;
-		for (auto const& d : destination) {
-			send.emplace_back(sig, d);
-		}
-		return send;
+		send(self, sig, out);
 	}
 };
 
 // Class purely to capture signals for the conjunction to RX
 struct ConjunctionToRX : public Conjunction {
-	ConjunctionToRX() : Conjunction() {}
+	ConjunctionToRX() : Conjunction(), count(0) {}
 
-	std::unordered_map<std::string, size_t> cycle_counts;
-	static size_t count;
+	// the first two presses during which each input sent HIGH
+	std::unordered_map<module_id, std::vector<size_t>> high_presses;
+	size_t count; // button presses so far, kept up to date by the caller
 
-	signals_t on_signal_recv(std::string const& from, Signal sig) {
-		signals_t r = this->Conjunction::on_signal_recv(from, sig);
+	Module* clone() const { return new ConjunctionToRX(*this); }
 
-		if (sig == HIGH && cycle_counts.find(from) == cycle_counts.end()) {
-			cycle_counts[from] = count;
+	void on_signal_recv(module_id from, module_id self, Signal sig, signals_t& out) {
+		this->Conjunction::on_signal_recv(from, self, sig, out);
+
+		if (sig == HIGH) {
+			auto& presses = high_presses[from];
+			if (presses.size() < 2 && (presses.empty() || presses.back() != count)) {
+				presses.push_back(count);
+			}
 		}
+	}
 
-		return r;
+	// whether every input has been seen sending HIGH twice
+	bool has_cycles(void) const {
+		if (high_presses.size() != inputs.size()) {
+			return false;
+		}
+		for (auto const& pair : high_presses) {
+			if (pair.second.size() < 2) {
+				return false;
+			}
+		}
+		return true;
 	}
 };
 
-size_t ConjunctionToRX::count = 0;
-static ConjunctionToRX* cj_to_rx = nullptr;
-
 struct Broadcaster : public Module {
 	Broadcaster() : Module(BROADCASTER) {}
-	signals_t on_signal_recv(std::string const& from, Signal sig) {
+
+	Module* clone() const { return new Broadcaster(*this); }
+	void on_signal_recv(module_id from, module_id self, Signal sig, signals_t& out) {
 		(void)from;
 		// Send same signal to all connected destination modules
-		signals_t send;
-		for (auto const& d : destination) {
-			send.emplace_back(sig, d);
-		}
-		return send;
+		send(self, sig, out);
 	}
 };
 
-using modules_t = std::unordered_map<std::string, std::unique_ptr<Module>>;
-modules_t parse_modules(std::istream& stream) {
+struct Modules {
+	aoc::Interner names;
+	std::vector<std::unique_ptr<Module>> by_id; // nullptr for outputs like rx
+	module_id broadcaster;
+};
+
+using modules_t = Modules;
+modules_t parse_modules(aoc::StringView input) {
+	aoc::ScopedTimer timer("day20 parse");
+
 	modules_t modules;
 
-	for (auto const& line : aoc::Lines(stream)) {
-		std::istringstream ss(line); ss.imbue(LOCALE);
+	for (auto const& line : aoc::ViewLines(input)) {
+		aoc::Scanner sc(line);
 
-		std::string key, str;
-		ss >> key;
+		aoc::StringView key = sc.next_token(DELIMITERS), last;
 
-		std::vector<std::string> destination;
-		while (ss >> str) {
-			destination.push_back(str);
+		std::vector<module_id> destination;
+		for (auto d = sc.next_token(DELIMITERS); !d.empty(); d = sc.next_token(DELIMITERS)) {
+			destination.push_back(modules.names.intern(d));
+			last = d;
 		}
 
-		// special case for conjunction to rx
-		if (str == "rx") {
-			cj_to_rx = new ConjunctionToRX();
-			modules.emplace(key.substr(1), std::unique_ptr<Module>(cj_to_rx));
-			cj_to_rx->destination = destination;
-			continue;
+		Module* mod = nullptr;
+		if (last == "rx") {
+			// special case for conjunction to rx
+			mod = new ConjunctionToRX();
+		} else {
+			switch (key[0]) {
+				case '%': mod = new FlipFlop(); break;
+				case '&': mod = new Conjunction(); break;
+				default : mod = new Broadcaster(); break;
+			}
 		}
+		mod->destination = destination;
 
-		modules_t::iterator it;
-		switch (key[0]) {
-			case '%': it = modules.emplace(key.substr(1), std::unique_ptr<Module>(new FlipFlop())).first; break;
-			case '&': it = modules.emplace(key.substr(1),std::unique_ptr<Module>(new Conjunction())).first; break;
-			default : it = modules.emplace(key,std::unique_ptr<Module>(new Broadcaster())).first; break;
+		module_id id = modules.names.intern(mod->type == BROADCASTER ? key : key.substr(1));
+		if (modules.by_id.size() <= id) {
+			modules.by_id.resize(id + 1);
 		}
-		it->second->destination = destination;
+		modules.by_id[id].reset(mod);
+	}
+	modules.by_id.resize(modules.names.size());
+
+	modules.broadcaster = modules.names.find("broadcaster");
+	if (modules.broadcaster == aoc::Interner::NONE || modules.by_id[modules.broadcaster] == nullptr) {
+		throw std::runtime_error("No broadcaster");
 	}
 
 	// Setup Conjunction modules
-	for (auto& p1 : modules) {
-		if (p1.second->type == CONJUNCTION) {
-			for (auto const& p2 : modules) {
-				auto const& dst = p2.second->destination;
-				if (std::find(dst.begin(), dst.end(), p1.first) != dst.end()) {
-					static_cast<Conjunction*>(p1.second.get())->inputs[p2.first] = LOW;
-				}
+	for (module_id to = 0; to < modules.by_id.size(); ++to) {
+		auto* conj = modules.by_id[to].get();
+		if (conj == nullptr || conj->type != CONJUNCTION) {
+			continue ;
+		}
+		for (module_id from = 0; from < modules.by_id.size(); ++from) {
+			if (modules.by_id[from] == nullptr) {
+				continue ;
+			}
+			auto const& dst = modules.by_id[from]->destination;
+			if (std::find(dst.begin(), dst.end(), to) != dst.end()) {
+				static_cast<Conjunction*>(conj)->inputs[from] = LOW;
+			}
+		}
+	}
+	return modules;
+}
+
+// For the parse cache, what is behind every id
+enum CachedKind : uint8_t {
+	CACHED_NONE,
+	CACHED_FLIPFLOP,
+	CACHED_CONJUNCTION,
+	CACHED_CONJUNCTION_TO_RX,
+	CACHED_BROADCASTER
+};
+
+void save_modules(aoc::BinaryWriter& out, modules_t const& modules) {
+	out.write(modules.names);
+	out.write(modules.broadcaster);
+	for (auto const& mod : modules.by_id) {
+		CachedKind kind = CACHED_NONE;
+		if (mod != nullptr) {
+			switch (mod->type) {
+				case FLIPFLOP: kind = CACHED_FLIPFLOP; break;
+				case BROADCASTER: kind = CACHED_BROADCASTER; break;
+				case CONJUNCTION:
+					kind = dynamic_cast<ConjunctionToRX const*>(mod.get()) ? CACHED_CONJUNCTION_TO_RX : CACHED_CONJUNCTION;
+					break;
 			}
 		}
+		out.write(kind);
+		if (kind == CACHED_NONE) {
+			continue ;
+		}
+		out.write(mod->destination);
+		if (kind == CACHED_FLIPFLOP) {
+			out.write(static_cast<FlipFlop const&>(*mod).is_on);
+		} else if (kind == CACHED_CONJUNCTION || kind == CACHED_CONJUNCTION_TO_RX) {
+			std::vector<module_id> from;
+			std::vector<Signal> last;
+			for (auto const& pair : static_cast<Conjunction const&>(*mod).inputs) {
+				from.push_back(pair.first);
+				last.push_back(pair.second);
+			}
+			out.write(from);
+			out.write(last);
+		}
 	}
-	return std::move(modules);
+}
+
+modules_t load_modules(aoc::BinaryReader& in) {
+	modules_t modules;
+	in.read(modules.names);
+	modules.broadcaster = in.read<module_id>();
+
+	size_t n = modules.names.size();
+	auto check_ids = [n](std::vector<module_id> const& ids) {
+		for (module_id id : ids) {
+			if (id >= n) {
+				throw std::runtime_error("Bad cached modules");
+			}
+		}
+	};
+
+	modules.by_id.resize(n);
+	for (auto& mod : modules.by_id) {
+		CachedKind kind = in.read<CachedKind>();
+		switch (kind) {
+			case CACHED_NONE: continue ;
+			case CACHED_FLIPFLOP: mod.reset(new FlipFlop()); break;
+			case CACHED_CONJUNCTION: mod.reset(new Conjunction()); break;
+			case CACHED_CONJUNCTION_TO_RX: mod.reset(new ConjunctionToRX()); break;
+			case CACHED_BROADCASTER: mod.reset(new Broadcaster()); break;
+			default: throw std::runtime_error("Bad cached modules");
+		}
+		in.read(mod->destination);
+		check_ids(mod->destination);
+		if (kind == CACHED_FLIPFLOP) {
+			static_cast<FlipFlop&>(*mod).is_on = in.read<bool>();
+		} else if (kind == CACHED_CONJUNCTION || kind == CACHED_CONJUNCTION_TO_RX) {
+			std::vector<module_id> from;
+			std::vector<Signal> last;
+			in.read(from);
+			in.read(last);
+			check_ids(from);
+			if (from.size() != last.size()) {
+				throw std::runtime_error("Bad cached modules");
+			}
+			auto& inputs = static_cast<Conjunction&>(*mod).inputs;
+			for (size_t i = 0; i < from.size(); ++i) {
+				inputs[from[i]] = last[i];
+			}
+		}
+	}
+	if (modules.broadcaster >= n || modules.by_id[modules.broadcaster] == nullptr) {
+		throw std::runtime_error("Bad cached modules");
+	}
+	return modules;
 }
 
 struct Result {
@@ -160,75 +312,183 @@ struct Result {
 };
 
 Result press_button(modules_t& modules) {
-	struct SignalSend {
-		Signal sig;
-		std::string to;
-		std::string from;
-	};
-	static SignalSend const INITIAL_SIGNAL = {LOW, "broadcaster", "button"};
+	aoc::ScopedTimer timer("day20 press_button");
+
+	// Both rounds of signals are reused for the whole press
+	aoc::ArenaScope scope(aoc::scratch_arena());
+	signals_t signals(scope.arena()), new_signals(scope.arena());
 
 	int64_t low = 0, high = 0;
-	std::vector<SignalSend> signals = { INITIAL_SIGNAL };
+	// from the button, which isn't a module
+	signals.push_back({LOW, modules.broadcaster, aoc::Interner::NONE});
 	while (!signals.empty()) {
-		std::vector<SignalSend> new_signals;
+		new_signals.clear();
 		for (auto const& send : signals) {
 			// count signals
 			low += (send.sig == LOW);
 			high += (send.sig == HIGH);
 
-			// std::cout << send.from << " --" << send.sig << "--> " << send.to << std::endl;
-
 			// Signal destination doesn't exist
-			if (modules.find(send.to) == modules.end()) {
+			Module* mod = modules.by_id[send.to].get();
+			if (mod == nullptr) {
 				continue ;
 			}
 
-			// Notify the module of the signal
-			auto& mod = modules[send.to];
-			auto to_insert = mod->on_signal_recv(send.from, send.sig);
-			
-			// Insert newly received signals
-			for (auto const& pair : to_insert) {
-				new_signals.push_back({pair.first, pair.second, send.to});
-			}
+			// Notify the module of the signal, it queues what it sends
+			mod->on_signal_recv(send.from, send.to, send.sig, new_signals);
 		}
 		signals.swap(new_signals);
 	}
 	return {low, high};
 }
 
-int main(int argc, char** argv) {
-	auto input = aoc::get_input(argc, argv);
+// Pressing the button changes the state of the modules, so every part works
+// on a fresh copy of the parsed modules
+modules_t clone_modules(modules_t const& modules) {
+	modules_t copy;
+	copy.names = modules.names;
+	copy.broadcaster = modules.broadcaster;
+	for (auto const& mod : modules.by_id) {
+		copy.by_id.emplace_back(mod ? mod->clone() : nullptr);
+	}
+	return copy;
+}
 
-	auto modules = parse_modules(*input);
+ConjunctionToRX* find_conjunction_to_rx(modules_t const& modules) {
+	for (auto const& mod : modules.by_id) {
+		if (auto* to_rx = dynamic_cast<ConjunctionToRX*>(mod.get())) {
+			return to_rx;
+		}
+	}
+	throw std::runtime_error("No conjunction connected to rx");
+}
+
+// The modules that send to id, directly or through others, and id itself:
+// their state after a press decides everything id sends from then on
+std::vector<module_id> upstream_of(modules_t const& modules, module_id id) {
+	std::vector<std::vector<module_id>> senders(modules.by_id.size());
+	for (module_id m = 0; m < modules.by_id.size(); ++m) {
+		if (modules.by_id[m]) {
+			for (module_id d : modules.by_id[m]->destination) {
+				senders[d].push_back(m);
+			}
+		}
+	}
+	std::vector<char> seen(modules.by_id.size(), 0);
+	std::vector<module_id> found = {id};
+	seen[id] = 1;
+	for (size_t i = 0; i < found.size(); ++i) {
+		for (module_id s : senders[found[i]]) {
+			if (!seen[s]) {
+				seen[s] = 1;
+				found.push_back(s);
+			}
+		}
+	}
+	return found;
+}
+
+std::vector<char> save_state(modules_t const& modules, std::vector<module_id> const& ids) {
+	std::vector<char> state;
+	for (module_id id : ids) {
+		if (modules.by_id[id]) {
+			modules.by_id[id]->save_state(state);
+		}
+	}
+	return state;
+}
+
+int64_t pulses_product(modules_t const& parsed) {
+	aoc::ScopedTimer timer("day20 part1");
+
+	modules_t modules = clone_modules(parsed);
 
 	int64_t low = 0, high = 0;
 	for (size_t i = 0; i < 1000; ++i) {
-		ConjunctionToRX::count += 1;
 		auto r = press_button(modules);
 		low += r.low;
 		high += r.high;
 	}
+	return low * high;
+}
 
-	std::cout << "(Part 1) LOW * HIGH after 1000 button presses: " << low * high << std::endl;
+size_t fewest_presses(modules_t const& parsed) {
+	aoc::ScopedTimer timer("day20 part2");
+
+	modules_t modules = clone_modules(parsed);
+	ConjunctionToRX* cj_to_rx = find_conjunction_to_rx(modules);
 
-	// PART 2
 	// There is a Conjunction connected to rx, so if all inputs to that
 	// conjunction are HIGH, then LOW will be send to rx.
 
-	// Track how many presses it takes for each individual input to do a cycle
-	while (cj_to_rx->cycle_counts.size() != cj_to_rx->inputs.size()) {
-		ConjunctionToRX::count += 1;
+	// Track how many presses it takes for each individual input to do a cycle,
+	// with the state of everything feeding the input after the presses it
+	// sent HIGH on
+	struct Input {
+		module_id id;
+		std::vector<module_id> upstream;
+		std::vector<std::vector<char>> states;
+	};
+	std::vector<Input> inputs;
+	for (auto const& pair : cj_to_rx->inputs) {
+		inputs.push_back({pair.first, upstream_of(modules, pair.first), {}});
+	}
+	while (!cj_to_rx->has_cycles()) {
+		cj_to_rx->count += 1;
 		press_button(modules);
+		for (auto& input : inputs) {
+			auto it = cj_to_rx->high_presses.find(input.id);
+			if (it != cj_to_rx->high_presses.end() && it->second.size() > input.states.size()) {
+				input.states.push_back(save_state(modules, input.upstream));
+			}
+		}
 	}
 
-	// Now perfrom lcm on these cycle counts
-	size_t lcm = 1;
-	for (auto const& c : cj_to_rx->cycle_counts) {
-		lcm = aoc::least_common_multiple(lcm, c.second);
+	// Every input sends HIGH first after 'offset' presses and then every
+	// 'period' presses, find the first press where they all do. That only
+	// holds if the modules feeding it are back in the same state, otherwise
+	// the next HIGH may come at any other time.
+	// (For the real input offset == period, so that's just their lcm)
+	std::vector<aoc::Cycle> cycles;
+	for (auto const& input : inputs) {
+		if (input.states[0] != input.states[1]) {
+			throw std::runtime_error("The modules sending to " + modules.names.name(input.id) +
+				" don't repeat between its HIGH presses");
+		}
+		auto const& presses = cj_to_rx->high_presses.at(input.id);
+		cycles.push_back({presses[0], presses[1] - presses[0]});
+	}
+	aoc::Cycle all;
+	if (!aoc::combine_cycles(cycles, all)) {
+		throw std::runtime_error("The inputs to rx are never all HIGH");
 	}
+	return all.offset;
+}
+
+aoc::Solution solution() {
+	return aoc::with_parse_cache(aoc::make_solution(20, "pulse", parse_modules, pulses_product, fewest_presses),
+		1, save_modules, load_modules);
+}
+
+} // namespace day20
+
+#ifndef AOC_NO_MAIN
+int main(int argc, char** argv) {
+	using namespace day20;
 
-	std::cout << "(Part 2) Fewest button presses for LOW to rx:  " << lcm << std::endl;
+	if (aoc::is_batch(argc, argv)) {
+		return aoc::batch_main(argc, argv, solution());
+	}
+
+	auto input = aoc::map_input(argc, argv);
+
+	auto modules = parse_modules(input.view());
+
+	std::cout << "(Part 1) LOW * HIGH after 1000 button presses: " << pulses_product(modules) << std::endl;
+
+	// PART 2
+	std::cout << "(Part 2) Fewest button presses for LOW to rx:  " << fewest_presses(modules) << std::endl;
 
 	return (EXIT_SUCCESS);
 }
+#endif // AOC_NO_MAIN
@@ -0,0 +1,113 @@
+#include "generators.h"
+#include "scanner.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace aoc;
+
+static char const* const USAGE =
+	"usage: gen [options] DAY       write an input for DAY to stdout (or -o FILE)\n"
+	"       gen [options] --all DIR write an input for every day to DIR/dayNN.txt\n"
+	"       gen --list              show what --scale means for every day\n"
+	"options:\n"
+	"  --seed N       seed of the random generator (default 0)\n"
+	"  --scale N      size of the input, see --list (default: about a real input)\n"
+	"  -o FILE        write to FILE instead of stdout\n";
+
+struct Arguments {
+	uint64_t seed = 0;
+	uint64_t scale = 0; // 0: the generator's default
+	int day = 0;
+	bool all = false;
+	bool list = false;
+	std::string path;
+};
+
+static uint64_t parse_number(char const* str) {
+	uint64_t n = 0;
+	Scanner sc(str);
+	if (!sc.next_int(n) || !sc.done()) {
+		throw std::runtime_error(std::string("bad number \"") + str + "\"\n" + USAGE);
+	}
+	return n;
+}
+
+static Arguments parse_arguments(int argc, char** argv) {
+	Arguments args;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (arg == "--seed" && has_value) {
+			args.seed = parse_number(argv[++i]);
+		} else if (arg == "--scale" && has_value) {
+			args.scale = parse_number(argv[++i]);
+		} else if (arg == "-o" && has_value) {
+			args.path = argv[++i];
+		} else if (arg == "--all" && has_value) {
+			args.all = true;
+			args.path = argv[++i];
+		} else if (arg == "--list") {
+			args.list = true;
+		} else if (arg[0] != '-' && args.day == 0) {
+			args.day = parse_number(arg.c_str());
+		} else {
+			throw std::runtime_error("bad argument \"" + arg + "\"\n" + USAGE);
+		}
+	}
+	if (!args.list && (args.all == (args.day != 0))) {
+		throw std::runtime_error(USAGE);
+	}
+	return args;
+}
+
+static void generate(gen::Generator const& generator, uint64_t seed, uint64_t scale, std::string const& path) {
+	std::FILE* file = path.empty() ? stdout : std::fopen(path.c_str(), "wb");
+	if (file == nullptr) {
+		throw std::runtime_error("Can't open \"" + path + "\": " + std::strerror(errno));
+	}
+	{
+		gen::Random rng(seed);
+		gen::Writer out(file);
+		generator.generate(out, rng, scale == 0 ? generator.default_scale : scale);
+	}
+	if (file != stdout) {
+		std::fclose(file);
+	}
+}
+
+int main(int argc, char** argv) {
+	try {
+		Arguments args = parse_arguments(argc, argv);
+
+		if (args.list) {
+			for (auto const& g : gen::generators()) {
+				std::cout << "day " << g.day << " (" << g.name << "): " << g.scale_doc
+					<< ", default " << g.default_scale << '\n';
+			}
+		} else if (args.all) {
+			// every day gets its own seed, so they don't all share a stream
+			for (auto const& g : gen::generators()) {
+				std::string path = args.path + "/day" + (g.day < 10 ? "0" : "") + std::to_string(g.day) + ".txt";
+				generate(g, args.seed + g.day, args.scale, path);
+			}
+		} else {
+			auto const* g = gen::find_generator(args.day);
+			if (g == nullptr) {
+				throw std::runtime_error("No generator for day " + std::to_string(args.day));
+			}
+			generate(*g, args.seed, args.scale, args.path);
+		}
+	} catch (std::exception const& e) {
+		std::cerr << e.what();
+		if (e.what()[std::strlen(e.what()) - 1] != '\n') {
+			std::cerr << '\n';
+		}
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
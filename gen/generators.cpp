@@ -0,0 +1,874 @@
+#include "generators.h"
+#include "flat_map.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace aoc {
+namespace gen {
+
+/* -------------------------------------------------------------------------- */
+/*                                   Helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+static StringView const LOWERCASE = "abcdefghijklmnopqrstuvwxyz";
+
+// Unique lowercase name for every index, at least min_length long
+static std::string lowercase_name(uint64_t index, size_t min_length) {
+	std::string name;
+	do {
+		name.push_back(char('a' + index % 26));
+		index /= 26;
+	} while (index != 0 || name.length() < min_length);
+	return name;
+}
+
+// Write grid (rows of width characters) line by line
+static void write_rows(Writer& out, std::vector<std::string> const& rows) {
+	for (auto const& row : rows) {
+		out << row << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                           Day 01: Trebuchet?!                              */
+/* -------------------------------------------------------------------------- */
+// Every line has at least one real digit, part 1 needs it
+static void calibration(Writer& out, Random& rng, uint64_t lines) {
+	static char const* const WORDS[] = {
+		"one", "two", "three", "four", "five", "six", "seven", "eight", "nine"
+	};
+
+	std::string line;
+	for (uint64_t i = 0; i < lines; ++i) {
+		line.clear();
+		int64_t pieces = rng.between(2, 12);
+		for (int64_t p = 0; p < pieces; ++p) {
+			uint64_t r = rng.below(10);
+			if (r < 5) {
+				line.push_back(rng.pick(LOWERCASE));
+			} else if (r < 7) {
+				line.push_back(char('1' + rng.below(9)));
+			} else {
+				line += WORDS[rng.below(9)];
+			}
+		}
+		line.insert(line.begin() + rng.below(line.length() + 1), char('1' + rng.below(9)));
+		out << line << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                            Day 02: Cube Conundrum                          */
+/* -------------------------------------------------------------------------- */
+static void cubes(Writer& out, Random& rng, uint64_t games) {
+	static char const* const COLORS[] = { "red", "green", "blue" };
+
+	for (uint64_t id = 1; id <= games; ++id) {
+		out << "Game " << id << ": ";
+		int64_t sets = rng.between(1, 6);
+		for (int64_t s = 0; s < sets; ++s) {
+			int order[] = {0, 1, 2};
+			for (int i = 2; i > 0; --i) {
+				std::swap(order[i], order[rng.below(i + 1)]);
+			}
+			int64_t colors = rng.between(1, 3);
+			for (int64_t c = 0; c < colors; ++c) {
+				out << rng.between(1, 20) << ' ' << COLORS[order[c]] << (c + 1 < colors ? ", " : "");
+			}
+			out << (s + 1 < sets ? "; " : "\n");
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                            Day 03: Gear Ratios                             */
+/* -------------------------------------------------------------------------- */
+static void engine(Writer& out, Random& rng, uint64_t n) {
+	static StringView const SYMBOLS = "*#+$/@%=&-";
+
+	std::string row;
+	for (uint64_t y = 0; y < n; ++y) {
+		row.clear();
+		while (row.length() < n) {
+			uint64_t r = rng.below(20);
+			if (r < 5) {
+				// number of 1-3 digits, always followed by a '.' or a symbol
+				size_t len = std::min<size_t>(rng.between(1, 3), n - row.length());
+				row.push_back(char('1' + rng.below(9)));
+				for (size_t i = 1; i < len; ++i) {
+					row.push_back(char('0' + rng.below(10)));
+				}
+				if (row.length() < n) {
+					row.push_back(rng.chance(1, 6) ? rng.pick(SYMBOLS) : '.');
+				}
+			} else if (r < 7) {
+				row.push_back(rng.chance(1, 2) ? '*' : rng.pick(SYMBOLS));
+			} else {
+				row.push_back('.');
+			}
+		}
+		out << row << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                            Day 04: Scratchcards                            */
+/* -------------------------------------------------------------------------- */
+static void scratchcard(Writer& out, Random& rng, uint64_t cards) {
+	static size_t const WINNING = 10, OWNED = 25;
+
+	size_t id_width = std::to_string(cards).length();
+	std::vector<int> numbers(99);
+	std::iota(numbers.begin(), numbers.end(), 1);
+	for (uint64_t id = 1; id <= cards; ++id) {
+		// the first WINNING numbers are the winning ones, the owned numbers
+		// are taken from a window overlapping them by a random amount
+		rng.shuffle(numbers);
+		// mostly losing cards, or the copies of part 2 grow exponentially
+		size_t overlap = rng.chance(3, 4) ? 0 : rng.between(1, 5);
+		std::vector<int> owned(numbers.begin() + WINNING - overlap, numbers.begin() + WINNING - overlap + OWNED);
+		rng.shuffle(owned);
+
+		out << "Card ";
+		out.padded(id, id_width) << ':';
+		for (size_t i = 0; i < WINNING; ++i) {
+			out << ' ';
+			out.padded(numbers[i], 2);
+		}
+		out << " |";
+		for (int n : owned) {
+			out << ' ';
+			out.padded(n, 2);
+		}
+		out << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                 Day 05: If You Give A Seed A Fertilizer                    */
+/* -------------------------------------------------------------------------- */
+// Every map moves around disjoint source ranges without overlapping
+// destinations, like the real almanac. Numbers stay below 2^32.
+static void seed(Writer& out, Random& rng, uint64_t entries) {
+	static char const* const MAPS[] = {
+		"seed-to-soil", "soil-to-fertilizer", "fertilizer-to-water", "water-to-light",
+		"light-to-temperature", "temperature-to-humidity", "humidity-to-location"
+	};
+	static uint64_t const LIMIT = uint64_t(1) << 32;
+
+	entries = std::max<uint64_t>(entries, 1);
+	out << "seeds:";
+	uint64_t seeds = std::max<uint64_t>(entries / 3, 1);
+	for (uint64_t i = 0; i < seeds; ++i) {
+		uint64_t length = rng.between(1, LIMIT >> 5);
+		out << ' ' << rng.below(LIMIT - length) << ' ' << length;
+	}
+	out << "\n";
+
+	for (auto const* name : MAPS) {
+		out << '\n' << name << " map:\n";
+
+		// cut [0, LIMIT) into entries + 1 pieces and drop one to leave a gap
+		std::vector<uint64_t> cuts = {0, LIMIT};
+		for (uint64_t i = 0; i < entries; ++i) {
+			cuts.push_back(rng.between(1, LIMIT - 1));
+		}
+		std::sort(cuts.begin(), cuts.end());
+		cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+		std::vector<size_t> order(cuts.size() - 1);
+		std::iota(order.begin(), order.end(), 0);
+		rng.shuffle(order);
+
+		// lay out the shuffled pieces back to back as the destinations
+		std::vector<uint64_t> destination(order.size());
+		uint64_t at = 0;
+		for (size_t i : order) {
+			destination[i] = at;
+			at += cuts[i + 1] - cuts[i];
+		}
+		size_t dropped = rng.below(order.size());
+		for (size_t i : order) {
+			if (i != dropped || order.size() == 1) {
+				out << destination[i] << ' ' << cuts[i] << ' ' << (cuts[i + 1] - cuts[i]) << '\n';
+			}
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                            Day 06: Wait For It                             */
+/* -------------------------------------------------------------------------- */
+// Part 2 concatenates all numbers into a single race that has to fit in 64
+// bits, so this can't grow beyond 4 races of two digit times.
+static void race(Writer& out, Random& rng, uint64_t races) {
+	races = std::min<uint64_t>(std::max<uint64_t>(races, 1), 4);
+
+	auto concat = [](uint64_t a, uint64_t b) {
+		return std::stoull(std::to_string(a) + std::to_string(b));
+	};
+	auto record = [](uint64_t t) {
+		return (t / 2) * (t - t / 2);
+	};
+
+	std::vector<uint64_t> times, distances;
+	for (;;) {
+		times.clear();
+		distances.clear();
+		uint64_t big_time = 0, big_distance = 0;
+		for (uint64_t i = 0; i < races; ++i) {
+			uint64_t t = rng.between(7, 99);
+			uint64_t d = rng.between(record(t) / 2, record(t) - 1);
+			times.push_back(t);
+			distances.push_back(d);
+			big_time = concat(big_time, t);
+			big_distance = concat(big_distance, d);
+		}
+		// the big race has to be winnable as well
+		if (big_distance < record(big_time)) {
+			break ;
+		}
+	}
+
+	out << "Time:    ";
+	for (auto t : times) {
+		out << ' ';
+		out.padded(t, 4);
+	}
+	out << "\nDistance:";
+	for (auto d : distances) {
+		out << ' ';
+		out.padded(d, 4);
+	}
+	out << '\n';
+}
+
+/* -------------------------------------------------------------------------- */
+/*                            Day 07: Camel Cards                             */
+/* -------------------------------------------------------------------------- */
+// Every hand is different: the ranking of equal hands would depend on the
+// order of the lines
+static void camel(Writer& out, Random& rng, uint64_t hands) {
+	static StringView const CARDS = "AKQJT98765432";
+	static uint64_t const DISTINCT_HANDS = 13 * 13 * 13 * 13 * 13;
+
+	hands = std::min(hands, DISTINCT_HANDS);
+	FlatSet<std::string> seen;
+	for (uint64_t i = 0; i < hands; ++i) {
+		std::string hand;
+		do {
+			hand.clear();
+			for (int c = 0; c < 5; ++c) {
+				hand += rng.pick(CARDS);
+			}
+		} while (!seen.insert(hand).second);
+		out << hand << ' ' << rng.between(1, 1000) << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                           Day 08: Haunted Wasteland                        */
+/* -------------------------------------------------------------------------- */
+// Up to 6 ghosts, each on its own chain xxA -> ... -> xxZ -> (back to the
+// node after xxA). A chain is (distinct prime) * (instruction count) steps and
+// every node on it has the next node on the side the instruction at that step
+// picks, so every ghost cycles with exactly the steps it took to reach xxZ.
+// The first ghost is AAA -> ZZZ for part 1.
+static void haunted(Writer& out, Random& rng, uint64_t nodes) {
+	static uint64_t const PRIMES[] = {43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97};
+	static size_t const PRIME_COUNT = sizeof(PRIMES) / sizeof(*PRIMES);
+
+	std::vector<uint64_t> primes(PRIMES, PRIMES + PRIME_COUNT);
+	rng.shuffle(primes);
+	size_t ghosts = std::max<size_t>(1, std::min<size_t>(6, nodes / 100));
+	primes.resize(ghosts);
+	uint64_t prime_sum = std::accumulate(primes.begin(), primes.end(), uint64_t(0));
+	uint64_t instruction_count = std::max<uint64_t>(1, nodes / prime_sum);
+
+	std::string instructions;
+	for (uint64_t i = 0; i < instruction_count; ++i) {
+		instructions.push_back(rng.chance(1, 2) ? 'L' : 'R');
+	}
+
+	// names are uppercase, plain nodes never end in 'A' or 'Z'
+	uint64_t plain_count = instruction_count * prime_sum;
+	size_t length = 3;
+	for (uint64_t capacity = 26 * 26 * 24; capacity < plain_count; capacity *= 26) {
+		++length;
+	}
+	auto plain_name = [length](uint64_t i) {
+		std::string name(length, 'A');
+		name[length - 1] = char('B' + i % 24);
+		i /= 24;
+		for (size_t c = length - 1; c-- > 0; i /= 26) {
+			name[c] = char('A' + i % 26);
+		}
+		return name;
+	};
+	auto ghost_name = [length](size_t ghost, char end) {
+		if (ghost == 0) {
+			return std::string(3, end); // AAA and ZZZ
+		}
+		std::string name(length, 'A');
+		name[length - 2] = char('A' + ghost);
+		name[length - 1] = end;
+		return name;
+	};
+
+	struct Node {
+		std::string name;
+		std::string left;
+		std::string right;
+	};
+	std::vector<Node> network;
+	uint64_t next_plain = 0;
+	for (size_t g = 0; g < ghosts; ++g) {
+		// chain[0] is xxA, chain[steps] is xxZ
+		uint64_t steps = primes[g] * instruction_count;
+		std::vector<std::string> chain;
+		chain.push_back(ghost_name(g, 'A'));
+		for (uint64_t i = 1; i < steps; ++i) {
+			chain.push_back(plain_name(next_plain++));
+		}
+		chain.push_back(ghost_name(g, 'Z'));
+
+		for (uint64_t i = 0; i <= steps; ++i) {
+			std::string const& next = (i == steps) ? chain[1] : chain[i + 1];
+			std::string const& other = chain[rng.between(1, steps)];
+			bool left = instructions[i % instruction_count] == 'L';
+			network.push_back({chain[i], left ? next : other, left ? other : next});
+		}
+	}
+	rng.shuffle(network);
+
+	out << instructions << "\n\n";
+	for (auto const& n : network) {
+		out << n.name << " = (" << n.left << ", " << n.right << ")\n";
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                            Day 09: Mirage Maintenance                      */
+/* -------------------------------------------------------------------------- */
+// Polynomials of a low degree, so the differences always end in zeroes
+static void oasis(Writer& out, Random& rng, uint64_t lines) {
+	static int64_t const LENGTH = 21;
+
+	for (uint64_t i = 0; i < lines; ++i) {
+		int64_t degree = rng.between(1, 6);
+		std::vector<int64_t> coefficients;
+		for (int64_t d = 0; d <= degree; ++d) {
+			coefficients.push_back(rng.between(-9, 9));
+		}
+		if (coefficients.back() == 0) {
+			coefficients.back() = 1;
+		}
+		for (int64_t x = 0; x < LENGTH; ++x) {
+			int64_t y = 0;
+			for (auto it = coefficients.rbegin(); it != coefficients.rend(); ++it) {
+				y = y * x + *it;
+			}
+			out << y << (x + 1 < LENGTH ? ' ' : '\n');
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Day 10: Pipe Maze                            */
+/* -------------------------------------------------------------------------- */
+// A single loop starting at S in the top-left corner: straight along the top,
+// down the right side and back left along a random staircase. Every other
+// tile is random junk that never connects to S.
+static void pipes(Writer& out, Random& rng, uint64_t n) {
+	int64_t size = std::max<int64_t>(n, 6);
+	std::vector<std::string> rows(size, std::string(size, '.'));
+	for (int64_t y = 0; y < size; ++y) {
+		for (int64_t x = 0; x < size; ++x) {
+			if (rng.chance(1, 2)) {
+				rows[y][x] = rng.pick("|-LJ7F");
+			}
+		}
+	}
+
+	// tiles of the loop in order, starting at S
+	int64_t const left = 1, right = size - 2, top = 1, bottom = size - 2;
+	std::vector<std::pair<int64_t, int64_t>> loop;
+	for (int64_t x = left; x <= right; ++x) {
+		loop.emplace_back(x, top);
+	}
+	int64_t depth = rng.between(top + 2, bottom);
+	for (int64_t y = top + 1; y <= depth; ++y) {
+		loop.emplace_back(right, y);
+	}
+	for (int64_t x = right - 1; x > left; --x) {
+		int64_t next = std::min(bottom, std::max(top + 2, depth + rng.between(-3, 3)));
+		int64_t step = (next > depth) ? 1 : -1;
+		loop.emplace_back(x, depth);
+		for (int64_t y = depth; y != next; ) {
+			y += step;
+			loop.emplace_back(x, y);
+		}
+		depth = next;
+	}
+	for (int64_t y = depth; y > top; --y) {
+		loop.emplace_back(left, y);
+	}
+
+	for (size_t i = 0; i < loop.size(); ++i) {
+		auto const& p = loop[i];
+		auto const& prev = loop[(i + loop.size() - 1) % loop.size()];
+		auto const& next = loop[(i + 1) % loop.size()];
+		bool up = (prev.second < p.second || next.second < p.second);
+		bool down = (prev.second > p.second || next.second > p.second);
+		bool west = (prev.first < p.first || next.first < p.first);
+		char c = '-';
+		if (up && down) c = '|';
+		else if (up) c = west ? 'J' : 'L';
+		else if (down) c = west ? '7' : 'F';
+		rows[p.second][p.first] = c;
+	}
+	// S and the tiles next to it that are not on the loop
+	rows[top][left] = 'S';
+	rows[top - 1][left] = '.';
+	rows[top][left - 1] = '.';
+	write_rows(out, rows);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                            Day 11: Cosmic Expansion                        */
+/* -------------------------------------------------------------------------- */
+static void cosmic(Writer& out, Random& rng, uint64_t n) {
+	std::vector<bool> empty_column(n);
+	for (uint64_t x = 0; x < n; ++x) {
+		empty_column[x] = rng.chance(1, 12);
+	}
+	std::string row;
+	for (uint64_t y = 0; y < n; ++y) {
+		bool empty_row = rng.chance(1, 12);
+		row.assign(n, '.');
+		for (uint64_t x = 0; x < n; ++x) {
+			if (!empty_row && !empty_column[x] && rng.chance(1, 45)) {
+				row[x] = '#';
+			}
+		}
+		out << row << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                             Day 12: Hot Springs                            */
+/* -------------------------------------------------------------------------- */
+// Take a random row, write down its groups and then forget part of it
+static void springs(Writer& out, Random& rng, uint64_t lines) {
+	std::string row;
+	std::vector<size_t> groups;
+	for (uint64_t i = 0; i < lines; ++i) {
+		row.assign(rng.between(6, 20), '.');
+		for (auto& c : row) {
+			c = rng.chance(2, 5) ? '#' : '.';
+		}
+		row[rng.below(row.length())] = '#';
+
+		groups.clear();
+		size_t run = 0;
+		for (char c : row) {
+			if (c == '#') {
+				++run;
+			} else if (run > 0) {
+				groups.push_back(run);
+				run = 0;
+			}
+		}
+		if (run > 0) {
+			groups.push_back(run);
+		}
+
+		for (auto& c : row) {
+			if (rng.chance(2, 5)) {
+				c = '?';
+			}
+		}
+
+		out << row << ' ';
+		for (size_t g = 0; g < groups.size(); ++g) {
+			out << groups[g] << (g + 1 < groups.size() ? ',' : '\n');
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                           Day 13: Point of Incidence                       */
+/* -------------------------------------------------------------------------- */
+// Every pattern gets two planted reflections at opposite ends: a perfect one
+// (part 1) and one that is off by a single smudge (part 2)
+static void mirrors(Writer& out, Random& rng, uint64_t patterns) {
+	for (uint64_t p = 0; p < patterns; ++p) {
+		int64_t height = rng.between(7, 17);
+		int64_t width = rng.between(5, 17);
+		std::vector<std::string> rows(height, std::string(width, '.'));
+		for (auto& row : rows) {
+			for (auto& c : row) {
+				c = rng.chance(1, 2) ? '#' : '.';
+			}
+		}
+
+		// the perfect reflection covers the last 2 * perfect rows, the
+		// smudged one the first 2 * smudged rows
+		int64_t perfect = rng.between(1, height / 4);
+		int64_t smudged = rng.between(1, height / 4);
+		for (int64_t i = 0; i < perfect; ++i) {
+			rows[height - perfect + i] = rows[height - perfect - 1 - i];
+		}
+		for (int64_t i = 0; i < smudged; ++i) {
+			rows[smudged + i] = rows[smudged - 1 - i];
+		}
+		char& smudge = rows[smudged + rng.below(smudged)][rng.below(width)];
+		smudge = (smudge == '#') ? '.' : '#';
+
+		if (rng.chance(1, 2)) {
+			std::reverse(rows.begin(), rows.end());
+		}
+		if (rng.chance(1, 2)) {
+			std::vector<std::string> transposed(width, std::string(height, '.'));
+			for (int64_t y = 0; y < height; ++y) {
+				for (int64_t x = 0; x < width; ++x) {
+					transposed[x][y] = rows[y][x];
+				}
+			}
+			rows.swap(transposed);
+		}
+
+		if (p > 0) {
+			out << '\n';
+		}
+		write_rows(out, rows);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                      Day 14: Parabolic Reflector Dish                      */
+/* -------------------------------------------------------------------------- */
+static void dish(Writer& out, Random& rng, uint64_t n) {
+	std::string row;
+	for (uint64_t y = 0; y < n; ++y) {
+		row.assign(n, '.');
+		for (auto& c : row) {
+			uint64_t r = rng.below(40);
+			c = (r < 8) ? 'O' : (r < 13) ? '#' : '.';
+		}
+		out << row << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                            Day 15: Lens Library                            */
+/* -------------------------------------------------------------------------- */
+// Labels come from a limited pool, so lenses get replaced and removed
+static void lens(Writer& out, Random& rng, uint64_t steps) {
+	std::vector<std::string> labels(std::max<uint64_t>(steps / 8, 1));
+	for (auto& label : labels) {
+		int64_t length = rng.between(2, 6);
+		for (int64_t i = 0; i < length; ++i) {
+			label.push_back(rng.pick(LOWERCASE));
+		}
+	}
+
+	for (uint64_t i = 0; i < steps; ++i) {
+		out << labels[rng.below(labels.size())];
+		if (rng.chance(3, 10)) {
+			out << '-';
+		} else {
+			out << '=' << rng.between(1, 9);
+		}
+		out << (i + 1 < steps ? ',' : '\n');
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                       Day 16: The Floor Will Be Lava                       */
+/* -------------------------------------------------------------------------- */
+static void beams(Writer& out, Random& rng, uint64_t n) {
+	std::string row;
+	for (uint64_t y = 0; y < n; ++y) {
+		row.assign(n, '.');
+		for (auto& c : row) {
+			if (rng.chance(1, 9)) {
+				c = rng.pick("|-/\\");
+			}
+		}
+		out << row << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                          Day 17: Clumsy Crucible                           */
+/* -------------------------------------------------------------------------- */
+static void crucibles(Writer& out, Random& rng, uint64_t n) {
+	n = std::max<uint64_t>(n, 5); // the ultra crucible needs room to move
+	std::string row;
+	for (uint64_t y = 0; y < n; ++y) {
+		row.assign(n, '.');
+		for (auto& c : row) {
+			c = char('1' + rng.below(9));
+		}
+		out << row << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                          Day 18: Lavaduct Lagoon                           */
+/* -------------------------------------------------------------------------- */
+// Both plans (part 1 and the hex colors of part 2) are the outline of a
+// histogram: a flat top and a staircase bottom of columns with different
+// heights. Simple polygons, so the shoelace formula holds for both.
+// Part 2 distances have 5 hex digits, so the whole top edge has to fit in them.
+static void lavaduct(Writer& out, Random& rng, uint64_t columns) {
+	static int64_t const HEX_LIMIT = 0xFFFFF;
+	static char const DIRECTIONS[] = "RDLU";
+
+	int64_t m = std::min<int64_t>(std::max<uint64_t>(columns, 1), HEX_LIMIT / 2);
+
+	// edges as (direction index, length)
+	auto outline = [&](int64_t max_width, int64_t max_height) {
+		std::vector<int64_t> widths, heights;
+		for (int64_t i = 0; i < m; ++i) {
+			widths.push_back(rng.between(1, max_width));
+			int64_t h = rng.between(1, max_height);
+			if (!heights.empty() && h == heights.back()) {
+				h = (h == max_height) ? h - 1 : h + 1;
+			}
+			heights.push_back(h);
+		}
+
+		std::vector<std::pair<int, int64_t>> edges;
+		edges.emplace_back(0, std::accumulate(widths.begin(), widths.end(), int64_t(0)));
+		edges.emplace_back(1, heights.back());
+		for (int64_t i = m - 1; i >= 0; --i) {
+			edges.emplace_back(2, widths[i]);
+			if (i > 0) {
+				int64_t dy = heights[i - 1] - heights[i];
+				edges.emplace_back(dy > 0 ? 1 : 3, dy > 0 ? dy : -dy);
+			}
+		}
+		edges.emplace_back(3, heights.front());
+		return edges;
+	};
+
+	auto plan = outline(10, 20);
+	auto colors = outline(std::max<int64_t>(1, HEX_LIMIT / m), HEX_LIMIT);
+
+	static char const HEX[] = "0123456789abcdef";
+	for (size_t i = 0; i < plan.size(); ++i) {
+		out << DIRECTIONS[plan[i].first] << ' ' << plan[i].second << " (#";
+		int64_t distance = colors[i].second;
+		for (int shift = 16; shift >= 0; shift -= 4) {
+			out << HEX[(distance >> shift) & 0xF];
+		}
+		out << HEX[colors[i].first] << ")\n";
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              Day 19: Aplenty                               */
+/* -------------------------------------------------------------------------- */
+// Workflows form a tree rooted at "in", every workflow is sent to by exactly
+// one rule, so there are no cycles. Every rule splits the ratings that can
+// still reach it into two non-empty halves, like in the real input, the range
+// tracing of part 2 relies on that. Built breadth first, so it stays shallow
+// enough for the recursive range tracing at any size, until it has as many
+// workflows as asked for. At least one rule sends to A.
+static void aplenty(Writer& out, Random& rng, uint64_t workflows) {
+	static char const RATINGS[] = "xmas";
+
+	// inclusive [lo, hi] of x, m, a and s
+	struct Box {
+		int64_t lo[4];
+		int64_t hi[4];
+	};
+	struct Pending {
+		std::string name;
+		Box box;
+	};
+
+	workflows = std::max<uint64_t>(workflows, 1);
+	uint64_t created = 1;
+	auto new_name = [&created]() {
+		return lowercase_name(created++ + 26 * 26, 3);
+	};
+
+	std::vector<std::string> lines;
+	bool accepted = false; // some rule sends to A
+	std::vector<Pending> pending = {{"in", {{1, 1, 1, 1}, {4000, 4000, 4000, 4000}}}};
+	for (size_t w = 0; w < pending.size(); ++w) {
+		Box box = pending[w].box;
+		std::string line = pending[w].name + '{';
+
+		auto target = [&](Box const& reaching, bool fallback) {
+			// the last workflow left always spawns, so the tree reaches the
+			// scale instead of stopping early
+			bool last = (w + 1 == pending.size());
+			if (created < workflows && (last || rng.chance(2, 3))) {
+				pending.push_back({new_name(), reaching});
+				return pending.back().name;
+			}
+			// the very last target accepts if none did yet, otherwise both
+			// answers are 0
+			bool accept = rng.chance(1, 2) || (last && fallback && !accepted);
+			accepted = accepted || accept;
+			return std::string(accept ? "A" : "R");
+		};
+
+		int64_t rules = rng.between(1, 3);
+		for (int64_t r = 0; r < rules; ++r) {
+			int c = rng.below(4);
+			if (box.lo[c] == box.hi[c]) {
+				break ; // can't split this one any further
+			}
+			Box taken = box;
+			int64_t value;
+			char op = rng.chance(1, 2) ? '<' : '>';
+			if (op == '<') {
+				value = rng.between(box.lo[c] + 1, box.hi[c]);
+				taken.hi[c] = value - 1;
+				box.lo[c] = value;
+			} else {
+				value = rng.between(box.lo[c], box.hi[c] - 1);
+				taken.lo[c] = value + 1;
+				box.hi[c] = value;
+			}
+			line += RATINGS[c];
+			line += op;
+			line += std::to_string(value) + ':' + target(taken, false) + ',';
+		}
+		lines.push_back(line + target(box, true) + '}');
+	}
+	rng.shuffle(lines);
+
+	for (auto const& line : lines) {
+		out << line << '\n';
+	}
+	out << '\n';
+	uint64_t parts = std::max<uint64_t>(workflows * 2 / 5, 1);
+	for (uint64_t p = 0; p < parts; ++p) {
+		out << "{x=" << rng.between(1, 4000) << ",m=" << rng.between(1, 4000)
+			<< ",a=" << rng.between(1, 4000) << ",s=" << rng.between(1, 4000) << "}\n";
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                           Day 20: Pulse Propagation                        */
+/* -------------------------------------------------------------------------- */
+// The circuit of the real input: every counter is a chain of 12 flip-flops
+// (a binary counter) with a conjunction that resets it after a prime amount of
+// presses. That conjunction sends through an inverter to the single
+// conjunction feeding rx. At most 5 different primes are used, so the answer
+// (their product) always fits in 64 bits, no matter how many counters.
+static void pulse(Writer& out, Random& rng, uint64_t counters) {
+	static int const BITS = 12;
+	static uint64_t const PRIMES[] = {
+		3803, 3821, 3823, 3833, 3847, 3851, 3853, 3863, 3877, 3881, 3889, 3907,
+		3911, 3917, 3919, 3923, 3929, 3931, 3943, 3947, 3967, 3989, 4001, 4003,
+		4007, 4013, 4019, 4021, 4027, 4049, 4051, 4057, 4073, 4079, 4091, 4093
+	};
+	static size_t const DISTINCT = 5;
+
+	counters = std::max<uint64_t>(counters, 1);
+	std::vector<uint64_t> primes(PRIMES, PRIMES + sizeof(PRIMES) / sizeof(*PRIMES));
+	rng.shuffle(primes);
+	primes.resize(DISTINCT);
+
+	uint64_t next_name = 0;
+	auto new_name = [&next_name]() {
+		return lowercase_name(next_name++, 3);
+	};
+
+	std::string hub = new_name();
+	std::vector<std::string> lines;
+	std::string broadcaster = "broadcaster ->";
+	for (uint64_t c = 0; c < counters; ++c) {
+		uint64_t prime = primes[c % DISTINCT];
+		std::vector<std::string> flip_flops;
+		for (int b = 0; b < BITS; ++b) {
+			flip_flops.push_back(new_name());
+		}
+		std::string reset = new_name(), inverter = new_name();
+
+		broadcaster += (c > 0 ? ", " : " ") + flip_flops[0];
+		std::string reset_line = '&' + reset + " ->";
+		for (int b = 0; b < BITS; ++b) {
+			bool one = (prime >> b) & 1;
+			std::string line = '%' + flip_flops[b] + " ->";
+			std::vector<std::string> destinations;
+			if (b + 1 < BITS) {
+				destinations.push_back(flip_flops[b + 1]);
+			}
+			if (one) {
+				destinations.push_back(reset);
+			}
+			rng.shuffle(destinations);
+			for (size_t d = 0; d < destinations.size(); ++d) {
+				line += (d > 0 ? ", " : " ") + destinations[d];
+			}
+			lines.push_back(line);
+
+			// the reset clears every zero bit and the lowest one
+			if (!one || b == 0) {
+				reset_line += ' ' + flip_flops[b] + ',';
+			}
+		}
+		lines.push_back(reset_line + ' ' + inverter);
+		lines.push_back('&' + inverter + " -> " + hub);
+	}
+	lines.push_back(broadcaster);
+	lines.push_back('&' + hub + " -> rx");
+	rng.shuffle(lines);
+
+	for (auto const& line : lines) {
+		out << line << '\n';
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Registry                                  */
+/* -------------------------------------------------------------------------- */
+
+std::vector<Generator> const& generators(void) {
+	static std::vector<Generator> const GENERATORS {
+		{ 1, "calibration", "lines", 1000, calibration },
+		{ 2, "cubes", "games", 100, cubes },
+		{ 3, "engine", "grid width and height", 140, engine },
+		{ 4, "scratchcard", "cards", 200, scratchcard },
+		{ 5, "seed", "entries per map", 30, seed },
+		{ 6, "race", "races (at most 4)", 4, race },
+		{ 7, "camel", "hands", 1000, camel },
+		{ 8, "haunted", "nodes", 750, haunted },
+		{ 9, "oasis", "lines", 200, oasis },
+		{ 10, "pipes", "grid width and height", 140, pipes },
+		{ 11, "cosmic", "grid width and height", 140, cosmic },
+		{ 12, "springs", "lines", 1000, springs },
+		{ 13, "mirrors", "patterns", 100, mirrors },
+		{ 14, "main", "grid width and height", 100, dish },
+		{ 15, "lens", "steps", 4000, lens },
+		{ 16, "beams", "grid width and height", 110, beams },
+		{ 17, "crucibles", "grid width and height", 141, crucibles },
+		{ 18, "lavaduct", "columns of the lagoon (lines = 2 * columns + 2)", 350, lavaduct },
+		{ 19, "aplenty", "workflows (parts = 2/5 of that)", 550, aplenty },
+		{ 20, "pulse", "counters of 12 flip-flops", 4, pulse },
+	};
+	return GENERATORS;
+}
+
+Generator const* find_generator(int day) {
+	for (auto const& g : generators()) {
+		if (g.day == day) {
+			return &g;
+		}
+	}
+	return nullptr;
+}
+
+} // namespace gen
+} // namespace aoc
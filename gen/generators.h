@@ -0,0 +1,175 @@
+#ifndef GENERATORS_H
+# define GENERATORS_H
+
+# include "view.h"
+
+# include <cstdint>
+# include <cstdio>
+# include <string>
+# include <type_traits>
+# include <utility>
+# include <vector>
+
+namespace aoc {
+namespace gen {
+
+/* -------------------------------------------------------------------------- */
+/*                                   Random                                   */
+/* -------------------------------------------------------------------------- */
+// splitmix64 seeded xorshift64*. Only integer arithmetic on our own state,
+// so a seed produces the exact same input on every platform and standard
+// library (std::uniform_int_distribution gives no such guarantee).
+struct Random {
+	explicit Random(uint64_t seed) : state(0) {
+		// splitmix64 so that seeds 0, 1, 2, ... still give unrelated streams
+		uint64_t z = seed + 0x9E3779B97F4A7C15;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+		state = (z ^ (z >> 31)) | 1;
+	}
+
+	uint64_t next(void) {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1D;
+	}
+
+	// [0, n)
+	uint64_t below(uint64_t n) {
+		return n == 0 ? 0 : next() % n;
+	}
+
+	// [lo, hi]
+	int64_t between(int64_t lo, int64_t hi) {
+		return lo + int64_t(below(uint64_t(hi - lo) + 1));
+	}
+
+	// true with a chance of num / den
+	bool chance(uint64_t num, uint64_t den) {
+		return below(den) < num;
+	}
+
+	char pick(StringView chars) {
+		return chars[below(chars.size())];
+	}
+
+	// Fisher-Yates
+	template <typename T>
+	void shuffle(std::vector<T>& v) {
+		for (size_t i = v.size(); i > 1; --i) {
+			std::swap(v[i - 1], v[below(i)]);
+		}
+	}
+
+	private:
+	uint64_t state;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                   Writer                                   */
+/* -------------------------------------------------------------------------- */
+// Buffered output, inputs can be gigabytes so no iostreams
+struct Writer {
+	explicit Writer(std::FILE* out) : out(out) {
+		buffer.reserve(CAPACITY);
+	}
+
+	~Writer() {
+		flush();
+	}
+
+	Writer(Writer const&) = delete;
+	Writer& operator=(Writer const&) = delete;
+
+	Writer& operator<<(char c) {
+		buffer.push_back(c);
+		if (buffer.size() >= CAPACITY) {
+			flush();
+		}
+		return *this;
+	}
+
+	Writer& operator<<(StringView s) {
+		buffer.append(s.data(), s.size());
+		if (buffer.size() >= CAPACITY) {
+			flush();
+		}
+		return *this;
+	}
+
+	Writer& operator<<(char const* s) {
+		return *this << StringView(s);
+	}
+
+	Writer& operator<<(std::string const& s) {
+		return *this << StringView(s);
+	}
+
+	template <typename T>
+	typename std::enable_if<std::is_integral<T>::value, Writer&>::type operator<<(T n) {
+		char digits[24];
+		char* p = digits + sizeof(digits);
+		bool negative = n < 0;
+		typedef typename std::make_unsigned<T>::type unsigned_t;
+		unsigned_t u = negative ? unsigned_t(0) - unsigned_t(n) : unsigned_t(n);
+		do {
+			*--p = char('0' + u % 10);
+			u /= 10;
+		} while (u != 0);
+		if (negative) {
+			*--p = '-';
+		}
+		return *this << StringView(p, digits + sizeof(digits));
+	}
+
+	// n right aligned in a field of width characters
+	template <typename T>
+	Writer& padded(T n, size_t width) {
+		size_t len = 1;
+		for (T m = n; m >= 10; m /= 10) {
+			++len;
+		}
+		for (; len < width; ++len) {
+			*this << ' ';
+		}
+		return *this << n;
+	}
+
+	void flush(void) {
+		if (!buffer.empty()) {
+			std::fwrite(buffer.data(), 1, buffer.size(), out);
+			buffer.clear();
+		}
+	}
+
+	private:
+	static size_t const CAPACITY = 1 << 16;
+
+	std::FILE* out;
+	std::string buffer;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                 Generators                                 */
+/* -------------------------------------------------------------------------- */
+// Every generator produces an input its day solves end to end, for any scale.
+// What scale means depends on the day (lines, grid size, ...), see scale_doc.
+struct Generator {
+	int day;
+	char const* name;
+	char const* scale_doc;
+	uint64_t default_scale; // about the size of a real puzzle input
+	void (*generate)(Writer& out, Random& rng, uint64_t scale);
+};
+
+// Generators of every day, ordered by day
+std::vector<Generator> const& generators(void);
+
+// Generator of a specific day or nullptr if there is none
+Generator const* find_generator(int day);
+
+} // namespace gen
+} // namespace aoc
+
+#endif // GENERATORS_H
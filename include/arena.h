@@ -0,0 +1,205 @@
+#ifndef ARENA_H
+# define ARENA_H
+
+# include <cstddef>
+# include <cstdint>
+# include <new>
+# include <utility>
+# include <vector>
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                    Arena                                   */
+/* -------------------------------------------------------------------------- */
+// Monotonic bump allocator: allocating is a pointer increment, deallocating
+// does nothing. Memory is handed back all at once with rewind() (to a mark())
+// or reset(). Blocks are kept around, so once an arena has grown to what a
+// solve needs, reusing it never touches the heap again.
+//
+//     ArenaScope scope(scratch_arena()); // everything below is freed at '}'
+//     arena_vector<Vec2> next(scope.arena());
+//
+// Nothing allocated in it is destroyed, only put trivially destructible things
+// (or containers whose destructor doesn't matter) in it.
+struct Arena {
+	struct Marker {
+		size_t block;
+		size_t used;
+	};
+
+	explicit Arena(size_t block_size = 64 * 1024);
+	~Arena();
+
+	Arena(Arena const&) = delete;
+	Arena& operator=(Arena const&) = delete;
+
+	void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+		if (!blocks.empty()) {
+			Block& b = blocks[current];
+			size_t offset = (used + align - 1) & ~(align - 1);
+			if (offset + size <= b.size) {
+				used = offset + size;
+				return b.data + offset;
+			}
+		}
+		return allocate_slow(size, align);
+	}
+
+	template <typename T>
+	T* allocate(size_t n) {
+		return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+	}
+
+	Marker mark(void) const { return {current, used}; }
+	// free everything allocated since m
+	void rewind(Marker m) { current = m.block; used = m.used; }
+	// free everything, keeps the blocks
+	void reset(void) { current = 0; used = 0; }
+
+	// bytes handed out since the last reset (including alignment padding)
+	size_t bytes_used(void) const;
+	// bytes owned, all blocks together
+	size_t capacity(void) const;
+
+	private:
+	struct Block {
+		char* data;
+		size_t size;
+	};
+
+	void* allocate_slow(size_t size, size_t align);
+
+	std::vector<Block> blocks;
+	size_t current; // block being allocated from
+	size_t used;    // bytes used in the current block
+	size_t block_size;
+};
+
+// Rewinds the arena to where it was when the scope started
+struct ArenaScope {
+	explicit ArenaScope(Arena& a) : a(a), m(a.mark()) {}
+	~ArenaScope() { a.rewind(m); }
+
+	ArenaScope(ArenaScope const&) = delete;
+	ArenaScope& operator=(ArenaScope const&) = delete;
+
+	Arena& arena(void) const { return a; }
+
+	private:
+	Arena& a;
+	Arena::Marker m;
+};
+
+// Per thread arena for temporaries of a solve. Use it inside of an ArenaScope
+// so every solve starts from (and leaves) the same state.
+Arena& scratch_arena(void);
+
+// std allocator on top of an arena, deallocate is a no-op
+template <typename T>
+struct ArenaAllocator {
+	typedef T value_type;
+
+	ArenaAllocator(Arena& arena) : arena(&arena) {}
+	template <typename U>
+	ArenaAllocator(ArenaAllocator<U> const& other) : arena(other.arena) {}
+
+	T* allocate(size_t n) { return arena->allocate<T>(n); }
+	void deallocate(T*, size_t) {}
+
+	Arena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b) {
+	return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+bool operator!=(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b) {
+	return a.arena != b.arena;
+}
+
+template <typename T>
+using arena_vector = std::vector<T, ArenaAllocator<T>>;
+
+/* -------------------------------------------------------------------------- */
+/*                                    Pool                                    */
+/* -------------------------------------------------------------------------- */
+// Free list of fixed size slots for T, allocated in chunks of chunk_size.
+// Freed slots are reused first, chunks are only released by the destructor
+// (which doesn't destroy objects that are still alive).
+template <typename T>
+struct Pool {
+	explicit Pool(size_t chunk_size = 256) : free_list(nullptr), chunk_size(chunk_size), live_count(0) {}
+
+	~Pool() {
+		for (auto* c : chunks) {
+			::operator delete(c);
+		}
+	}
+
+	Pool(Pool const&) = delete;
+	Pool& operator=(Pool const&) = delete;
+
+	// uninitialized storage for one T
+	void* allocate(void) {
+		if (free_list == nullptr) {
+			grow();
+		}
+		Slot* s = free_list;
+		free_list = s->next;
+		++live_count;
+		return s;
+	}
+
+	void deallocate(void* p) {
+		Slot* s = static_cast<Slot*>(p);
+		s->next = free_list;
+		free_list = s;
+		--live_count;
+	}
+
+	template <typename... Args>
+	T* create(Args&&... args) {
+		void* p = allocate();
+		try {
+			return new (p) T(std::forward<Args>(args)...);
+		} catch (...) {
+			deallocate(p);
+			throw;
+		}
+	}
+
+	void destroy(T* p) {
+		p->~T();
+		deallocate(p);
+	}
+
+	// slots handed out and not returned
+	size_t live(void) const { return live_count; }
+
+	private:
+	union Slot {
+		Slot* next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	void grow(void) {
+		Slot* chunk = static_cast<Slot*>(::operator new(chunk_size * sizeof(Slot)));
+		chunks.push_back(chunk);
+		for (size_t i = chunk_size; i-- > 0;) {
+			chunk[i].next = free_list;
+			free_list = &chunk[i];
+		}
+	}
+
+	std::vector<Slot*> chunks;
+	Slot* free_list;
+	size_t chunk_size;
+	size_t live_count;
+};
+
+} // namespace aoc
+
+#endif // ARENA_H
@@ -0,0 +1,60 @@
+#ifndef BATCH_H
+# define BATCH_H
+
+# include <functional>
+# include <ostream>
+# include <string>
+# include <vector>
+
+# include "parse_cache.h"
+# include "solution.h"
+# include "thread_pool.h"
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                 Batch mode                                 */
+/* -------------------------------------------------------------------------- */
+// Many inputs solved in one process instead of one process per input, for
+// sweeps over generated inputs. Inputs run concurrently on a thread pool, the
+// results come out in the order the inputs were given. Inputs with the same
+// day and content are parsed and solved once, and every worker keeps its
+// scratch arenas from one input to the next.
+
+struct BatchItem {
+	int day;          // 0 if it's up to the program (a day's own main)
+	std::string path;
+};
+
+// One line per input, "PATH" or "DAY PATH". Empty lines and lines starting
+// with '#' are skipped.
+std::vector<BatchItem> read_manifest(std::string const& path);
+
+struct BatchResult {
+	std::string part1;
+	std::string part2; // empty if the day only has one answer
+	double ns;         // parse and both parts, 0 for a copy of another input
+	bool duplicate;    // same day and content as an earlier input
+	std::string error; // empty on success
+};
+
+// Solve every item with the solution find() returns for its day (nullptr if
+// there's none), results[i] is the one of items[i]. Parsed inputs go through
+// cache (off by default).
+std::vector<BatchResult> run_batch(std::vector<BatchItem> const& items,
+								   std::function<Solution const*(int)> const& find,
+								   ParseCache const& cache = ParseCache(),
+								   ThreadPool& pool = ThreadPool::global());
+
+// "[DAY\t]PATH\tPART1\tPART2\tMS" per item ("error: ..." instead of the answers)
+void print_batch(std::ostream& out, std::vector<BatchItem> const& items,
+				 std::vector<BatchResult> const& results, bool with_day);
+
+// For the main() of a day: more than one input, --manifest FILE or --threads N
+bool is_batch(int argc, char** argv);
+// solve the inputs of the command line with solution, EXIT_FAILURE if one failed
+int batch_main(int argc, char** argv, Solution const& solution);
+
+} // namespace aoc
+
+#endif // BATCH_H
@@ -9,6 +9,13 @@
 # include <memory>
 # include <cassert>
 
+# include "batch.h"
+# include "input.h"
+# include "number_theory.h"
+# include "scanner.h"
+# include "solution.h"
+# include "trace.h"
+
 namespace aoc {
 
 /* -------------------------------------------------------------------------- */
@@ -20,25 +27,15 @@ int sign(T const& x) {
 	return int((x > 0) - (x < 0));
 }
 
+// see number_theory.h, kept for the days that still call them by these names
 template <typename T>
 T greatest_common_devisor(T a, T b) {
-	static_assert(std::is_integral<T>(), "Type has to be integral");
-	T gcd = std::min<T>(a, b);
-	while (gcd > 0) {
-		if (a % gcd == 0 && b % gcd == 0) {
-			break ;
-		}
-		--gcd;
-	}
-	return gcd;
+	return gcd(a, b);
 }
 
 template <typename T>
 T least_common_multiple(T a, T b) {
-	static_assert(std::is_integral<T>(), "Type has to be integral");
-	// first find greatest common devisor
-	T gcd = greatest_common_devisor(a, b);
-	return ((a / gcd) * b);
+	return lcm(a, b);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -0,0 +1,168 @@
+#ifndef CYCLE_H
+# define CYCLE_H
+
+# include <cstdint>
+# include <limits>
+# include <utility>
+# include <vector>
+
+# include "flat_map.h"
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                              Cycle detection                               */
+/* -------------------------------------------------------------------------- */
+// For a state that's stepped over and over, x[0] = start, x[i + 1] = step(x[i]),
+// with finitely many states: the sequence ends up repeating, x[mu + lambda] ==
+// x[mu]. Knowing mu and lambda, the state after any number of steps (10^9 rock
+// tilts) takes at most mu + lambda steps.
+//
+// States are told apart by a 64 bit hash(state), ideally kept up to date by
+// step() itself (a Zobrist hash) instead of going over the whole state. A hash
+// match is either trusted (TrustHash) or confirmed with a full compare
+// (CompareStates), a collision is then skipped as if nothing matched.
+//
+// step(state) changes state in place, State has to be copyable.
+
+struct CycleInfo {
+	uint64_t mu;     // steps before the cycle starts
+	uint64_t lambda; // length of the cycle, 0 if none was found (within the limit)
+
+	bool found(void) const { return lambda != 0; }
+
+	// the earliest step whose state is the same as the one after n steps
+	uint64_t equivalent(uint64_t n) const {
+		return (!found() || n < mu) ? n : mu + (n - mu) % lambda;
+	}
+};
+
+// a hash match is a match, fine for 64 bit hashes of up to millions of states
+struct TrustHash {
+	template <typename State>
+	bool operator()(State const&, State const&) const { return true; }
+};
+
+// a hash match is confirmed with ==
+struct CompareStates {
+	template <typename State>
+	bool operator()(State const& a, State const& b) const { return a == b; }
+};
+
+// Brent's algorithm: only ever keeps two states around (O(1) memory) for about
+// 2 (mu + lambda) + lambda steps. Stops without a cycle after limit steps.
+template <typename State, typename Step, typename Hash, typename Verify = TrustHash>
+CycleInfo brent_cycle(State const& start, Step&& step, Hash const& hash, Verify const& verify = Verify(),
+					  uint64_t limit = std::numeric_limits<uint64_t>::max()) {
+	auto same = [&](State const& a, State const& b) {
+		return hash(a) == hash(b) && verify(a, b);
+	};
+
+	// lambda: the hare runs ahead in powers of two, the tortoise teleports to
+	// it at every one, until the hare meets it
+	uint64_t power = 1, lambda = 1;
+	State tortoise(start);
+	State hare(start);
+	step(hare);
+	for (uint64_t steps = 1; !same(tortoise, hare); ++steps) {
+		if (steps >= limit) {
+			return CycleInfo {steps, 0};
+		}
+		if (power == lambda) {
+			tortoise = hare;
+			power *= 2;
+			lambda = 0;
+		}
+		step(hare);
+		++lambda;
+	}
+
+	// mu: with the hare lambda steps ahead, they first meet at the cycle start
+	tortoise = start;
+	hare = start;
+	for (uint64_t i = 0; i < lambda; ++i) {
+		step(hare);
+	}
+	uint64_t mu = 0;
+	while (!same(tortoise, hare)) {
+		step(tortoise);
+		step(hare);
+		++mu;
+	}
+	return CycleInfo {mu, lambda};
+}
+
+// History: remembers the hash of every state (O(mu + lambda) memory, 24 bytes
+// per state) and finds the cycle in exactly mu + lambda steps, the fewest
+// possible. state is left at x[mu + lambda] (the same as x[mu]), or at
+// x[limit] if no cycle showed up before that. A hash match is confirmed by
+// stepping a copy of start up to the earlier state, once per earlier state
+// with that hash: a single time unless there are collisions.
+template <typename State, typename Step, typename Hash, typename Verify = TrustHash>
+CycleInfo history_cycle(State& state, Step&& step, Hash const& hash, Verify const& verify = Verify(),
+						uint64_t limit = std::numeric_limits<uint64_t>::max()) {
+	static uint64_t const NONE = std::numeric_limits<uint64_t>::max();
+
+	State start(state);
+	FlatMap<uint64_t, uint64_t> seen; // hash -> latest step with it
+	std::vector<uint64_t> previous;   // step -> the one before it with the same hash
+
+	for (uint64_t i = 0; ; ++i) {
+		auto inserted = seen.insert({hash(state), i});
+		previous.push_back(NONE);
+		if (!inserted.second) {
+			for (uint64_t earlier = inserted.first->second; earlier != NONE; earlier = previous[earlier]) {
+				State replay(start);
+				for (uint64_t j = 0; j < earlier; ++j) {
+					step(replay);
+				}
+				if (verify(replay, state)) {
+					return CycleInfo {earlier, i - earlier};
+				}
+			}
+			// a collision, chained in front of the others
+			previous[i] = inserted.first->second;
+			inserted.first->second = i;
+		}
+		if (i == limit) {
+			return CycleInfo {i, 0};
+		}
+		step(state);
+	}
+}
+
+// TrustHash needs no replay to confirm a match, nor a copy of start
+template <typename State, typename Step, typename Hash>
+CycleInfo history_cycle(State& state, Step&& step, Hash const& hash, TrustHash const&,
+						uint64_t limit = std::numeric_limits<uint64_t>::max()) {
+	FlatMap<uint64_t, uint64_t> seen;
+	for (uint64_t i = 0; ; ++i) {
+		auto inserted = seen.insert({hash(state), i});
+		if (!inserted.second) {
+			uint64_t earlier = inserted.first->second;
+			return CycleInfo {earlier, i - earlier};
+		}
+		if (i == limit) {
+			return CycleInfo {i, 0};
+		}
+		step(state);
+	}
+}
+
+// The state after n steps from start, with history_cycle(): at most
+// mu + lambda steps, plus less than lambda to get from x[mu] to the answer
+template <typename State, typename Step, typename Hash, typename Verify = TrustHash>
+State state_after(State state, uint64_t n, Step&& step, Hash const& hash, Verify const& verify = Verify()) {
+	CycleInfo cycle = history_cycle(state, step, hash, verify, n);
+	if (cycle.found()) {
+		// state is x[mu + lambda], which is x[mu]
+		for (uint64_t i = cycle.mu; i < cycle.equivalent(n); ++i) {
+			step(state);
+		}
+	}
+	return state;
+}
+
+} // namespace aoc
+
+#endif // CYCLE_H
@@ -0,0 +1,284 @@
+#ifndef FLAT_MAP_H
+# define FLAT_MAP_H
+
+# include <cstddef>
+# include <cstdint>
+# include <functional>
+# include <iterator>
+# include <stdexcept>
+# include <type_traits>
+# include <utility>
+# include <vector>
+
+# include "hash.h"
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                FlatMap/FlatSet                             */
+/* -------------------------------------------------------------------------- */
+// Open addressing hash map/set with linear probing: every entry lives in one
+// contiguous array, so inserting doesn't allocate (unless it has to grow) and
+// a lookup is a few neighbouring slots instead of a chain of nodes.
+// clear() keeps the slots, so a table reused in a loop only allocates once.
+//
+// Drop in for the parts of std::unordered_map/set the days use (find, count,
+// insert, operator[], at, erase, iteration) with a few differences:
+//   - every insert (or grow) invalidates iterators and references
+//   - the value_type of a map is std::pair<K, V>, don't change the key
+//   - K and V have to be default constructible
+//
+// Hash is anything std::hash like, the result is mixed again so hashes that
+// are the identity (std::hash<int>) or only differ in their high bits don't
+// pile up in one spot of the power of two table.
+
+namespace detail {
+
+template <typename K, typename V>
+struct FirstOf {
+	static K const& key(std::pair<K, V> const& p) { return p.first; }
+};
+
+template <typename K>
+struct Identity {
+	static K const& key(K const& k) { return k; }
+};
+
+template <typename Value, typename Key, typename KeyOf, typename Hash, typename Eq>
+struct FlatTable {
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef size_t size_type;
+
+	template <bool Const>
+	struct Iterator {
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Value value_type;
+		typedef ptrdiff_t difference_type;
+		typedef typename std::conditional<Const, value_type const*, value_type*>::type pointer;
+		typedef typename std::conditional<Const, value_type const&, value_type&>::type reference;
+		typedef typename std::conditional<Const, FlatTable const*, FlatTable*>::type table_pointer;
+
+		Iterator() : table(nullptr), i(0) {}
+		Iterator(table_pointer table, size_t i) : table(table), i(i) { skip(); }
+		// iterator to const_iterator
+		template <bool C, typename = typename std::enable_if<Const && !C>::type>
+		Iterator(Iterator<C> const& other) : table(other.table), i(other.i) {}
+
+		reference operator*() const { return table->slots[i]; }
+		pointer operator->() const { return &table->slots[i]; }
+
+		Iterator& operator++() { ++i; skip(); return *this; }
+		Iterator operator++(int) { Iterator tmp(*this); ++*this; return tmp; }
+
+		bool operator==(Iterator const& rhs) const { return i == rhs.i; }
+		bool operator!=(Iterator const& rhs) const { return i != rhs.i; }
+
+		table_pointer table;
+		size_t i;
+
+		private:
+		void skip(void) {
+			while (i < table->used.size() && !table->used[i]) {
+				++i;
+			}
+		}
+	};
+
+	typedef Iterator<false> iterator;
+	typedef Iterator<true> const_iterator;
+
+	explicit FlatTable(Hash const& hash = Hash(), Eq const& eq = Eq()) : entries(0), hasher(hash), equal(eq) {}
+
+	iterator begin(void) { return iterator(this, 0); }
+	iterator end(void) { return iterator(this, used.size()); }
+	const_iterator begin(void) const { return const_iterator(this, 0); }
+	const_iterator end(void) const { return const_iterator(this, used.size()); }
+
+	size_t size(void) const { return entries; }
+	bool empty(void) const { return entries == 0; }
+	// slots, the table grows when it gets 3/4 full
+	size_t capacity(void) const { return used.size(); }
+
+	// room for n entries without growing
+	void reserve(size_t n) {
+		size_t slot_count = used.empty() ? 16 : used.size();
+		while (n * 4 > slot_count * 3) {
+			slot_count *= 2;
+		}
+		if (slot_count != used.size()) {
+			rehash(slot_count);
+		}
+	}
+
+	// remove everything, keeps the slots
+	void clear(void) {
+		for (size_t i = 0; i < used.size(); ++i) {
+			if (used[i]) {
+				slots[i] = value_type();
+				used[i] = 0;
+			}
+		}
+		entries = 0;
+	}
+
+	iterator find(key_type const& key) {
+		size_t i = locate(key);
+		return (i == NOT_FOUND) ? end() : iterator(this, i);
+	}
+
+	const_iterator find(key_type const& key) const {
+		size_t i = locate(key);
+		return (i == NOT_FOUND) ? end() : const_iterator(this, i);
+	}
+
+	size_t count(key_type const& key) const { return locate(key) != NOT_FOUND; }
+
+	std::pair<iterator, bool> insert(value_type const& value) {
+		auto slot = find_or_prepare(KeyOf::key(value));
+		if (slot.second) {
+			slots[slot.first] = value;
+		}
+		return {iterator(this, slot.first), slot.second};
+	}
+
+	std::pair<iterator, bool> insert(value_type&& value) {
+		auto slot = find_or_prepare(KeyOf::key(value));
+		if (slot.second) {
+			slots[slot.first] = std::move(value);
+		}
+		return {iterator(this, slot.first), slot.second};
+	}
+
+	// 1 if key was removed. Later entries of its probe sequence are shifted
+	// back, so there are no tombstones.
+	size_t erase(key_type const& key) {
+		size_t hole = locate(key);
+		if (hole == NOT_FOUND) {
+			return 0;
+		}
+		size_t mask = used.size() - 1;
+		for (size_t j = (hole + 1) & mask; used[j]; j = (j + 1) & mask) {
+			size_t home = home_of(KeyOf::key(slots[j]));
+			// j can move to the hole if its home isn't between the hole and j
+			if (((j - home) & mask) >= ((j - hole) & mask)) {
+				slots[hole] = std::move(slots[j]);
+				hole = j;
+			}
+		}
+		slots[hole] = value_type();
+		used[hole] = 0;
+		--entries;
+		return 1;
+	}
+
+	protected:
+	static size_t const NOT_FOUND = size_t(-1);
+
+	size_t home_of(key_type const& key) const {
+		return size_t(mix64(hasher(key))) & (used.size() - 1);
+	}
+
+	size_t locate(key_type const& key) const {
+		if (entries == 0) {
+			return NOT_FOUND;
+		}
+		size_t mask = used.size() - 1;
+		for (size_t i = home_of(key); used[i]; i = (i + 1) & mask) {
+			if (equal(KeyOf::key(slots[i]), key)) {
+				return i;
+			}
+		}
+		return NOT_FOUND;
+	}
+
+	// Slot of key and false, or a free slot for it (already counted) and true.
+	// The caller has to put the key in a new slot.
+	std::pair<size_t, bool> find_or_prepare(key_type const& key) {
+		if ((entries + 1) * 4 > used.size() * 3) {
+			rehash(used.empty() ? 16 : used.size() * 2);
+		}
+		size_t mask = used.size() - 1;
+		size_t i = home_of(key);
+		for (; used[i]; i = (i + 1) & mask) {
+			if (equal(KeyOf::key(slots[i]), key)) {
+				return {i, false};
+			}
+		}
+		used[i] = 1;
+		++entries;
+		return {i, true};
+	}
+
+	void rehash(size_t slot_count) {
+		std::vector<value_type> old_slots(slot_count);
+		std::vector<uint8_t> old_used(slot_count, 0);
+		old_slots.swap(slots);
+		old_used.swap(used);
+
+		size_t mask = slot_count - 1;
+		for (size_t j = 0; j < old_used.size(); ++j) {
+			if (!old_used[j]) {
+				continue ;
+			}
+			size_t i = home_of(KeyOf::key(old_slots[j]));
+			while (used[i]) {
+				i = (i + 1) & mask;
+			}
+			slots[i] = std::move(old_slots[j]);
+			used[i] = 1;
+		}
+	}
+
+	std::vector<value_type> slots;
+	std::vector<uint8_t> used; // separate, so probing doesn't drag whole entries through the cache
+	size_t entries;
+	Hash hasher;
+	Eq equal;
+};
+
+} // namespace detail
+
+template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+struct FlatMap : public detail::FlatTable<std::pair<K, V>, K, detail::FirstOf<K, V>, Hash, Eq> {
+	typedef detail::FlatTable<std::pair<K, V>, K, detail::FirstOf<K, V>, Hash, Eq> table_t;
+	typedef V mapped_type;
+
+	explicit FlatMap(Hash const& hash = Hash(), Eq const& eq = Eq()) : table_t(hash, eq) {}
+
+	// value of key, default constructed first if it isn't there
+	V& operator[](K const& key) {
+		auto slot = this->find_or_prepare(key);
+		if (slot.second) {
+			this->slots[slot.first].first = key;
+		}
+		return this->slots[slot.first].second;
+	}
+
+	V& at(K const& key) {
+		size_t i = this->locate(key);
+		if (i == table_t::NOT_FOUND) {
+			throw std::out_of_range("FlatMap::at");
+		}
+		return this->slots[i].second;
+	}
+
+	V const& at(K const& key) const {
+		size_t i = this->locate(key);
+		if (i == table_t::NOT_FOUND) {
+			throw std::out_of_range("FlatMap::at");
+		}
+		return this->slots[i].second;
+	}
+};
+
+template <typename K, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+struct FlatSet : public detail::FlatTable<K, K, detail::Identity<K>, Hash, Eq> {
+	typedef detail::FlatTable<K, K, detail::Identity<K>, Hash, Eq> table_t;
+
+	explicit FlatSet(Hash const& hash = Hash(), Eq const& eq = Eq()) : table_t(hash, eq) {}
+};
+
+} // namespace aoc
+
+#endif // FLAT_MAP_H
@@ -0,0 +1,204 @@
+#ifndef GRID_H
+# define GRID_H
+
+# include "vec2.h"
+# include "view.h"
+
+# include <algorithm>
+# include <vector>
+# include <iterator>
+# include <utility>
+# include <stdexcept>
+
+/* -------------------------------------------------------------------------- */
+/*                                    Grid                                    */
+/* -------------------------------------------------------------------------- */
+// 2D grid stored in a single contiguous buffer (row-major).
+// Optionally surrounded by a border of sentinel cells, so looking at the
+// neighbours of any cell inside the grid never needs a bounds check:
+//
+//     border = 1      ########
+//                     #......#   <- width x height cells
+//                     #......#
+//                     ########
+//
+// Coordinates (x, y) and Vec2's are always relative to the inner grid,
+// (0, 0) being the top-left cell that is not part of the border.
+// Linear indices point into the whole buffer, border included.
+template <typename T>
+struct Grid {
+	using value_t = T;
+	using reference = typename std::vector<T>::reference;
+	using const_reference = typename std::vector<T>::const_reference;
+
+/* -------------------------------------------------------------------------- */
+/*                                    Views                                   */
+/* -------------------------------------------------------------------------- */
+
+	// Contiguous row (or any other span of cells)
+	template <typename PtrT>
+	struct RowView {
+		using reference = decltype(*std::declval<PtrT>());
+
+		PtrT first;
+		int64_t count;
+
+		PtrT begin(void) const { return first; }
+		PtrT end(void) const { return first + count; }
+		int64_t size(void) const { return count; }
+		reference operator[](int64_t i) const { return first[i]; }
+	};
+
+	// Column, every element is stride apart
+	template <typename PtrT>
+	struct ColumnView {
+		using reference = decltype(*std::declval<PtrT>());
+
+		struct iterator {
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using reference = decltype(*std::declval<PtrT>());
+			using pointer = PtrT;
+
+			PtrT p;
+			int64_t stride;
+
+			reference operator*() const { return *p; }
+			iterator& operator++() { p += stride; return *this; }
+			iterator& operator--() { p -= stride; return *this; }
+			iterator operator++(int) { iterator copy(*this); p += stride; return copy; }
+			iterator operator--(int) { iterator copy(*this); p -= stride; return copy; }
+			bool operator==(iterator const& rhs) const { return p == rhs.p; }
+			bool operator!=(iterator const& rhs) const { return p != rhs.p; }
+		};
+
+		PtrT first;
+		int64_t stride;
+		int64_t count;
+
+		iterator begin(void) const { return {first, stride}; }
+		iterator end(void) const { return {first + stride * count, stride}; }
+		int64_t size(void) const { return count; }
+		reference operator[](int64_t i) const { return first[i * stride]; }
+	};
+
+	using row_t = RowView<T*>;
+	using const_row_t = RowView<T const*>;
+	using column_t = ColumnView<T*>;
+	using const_column_t = ColumnView<T const*>;
+
+/* -------------------------------------------------------------------------- */
+/*                          Constructors/Destructors                          */
+/* -------------------------------------------------------------------------- */
+
+	Grid() : w(0), h(0), b(0), s(0) {}
+
+	Grid(int64_t width, int64_t height, T const& fill = T(), int64_t border = 0, T const& sentinel = T())
+		: w(width), h(height), b(border), s(width + 2 * border),
+		  cells((width + 2 * border) * (height + 2 * border), sentinel) {
+		for (int64_t y = 0; y < h; ++y) {
+			std::fill_n(cells.data() + index(0, y), w, fill);
+		}
+	}
+
+	// Build a grid from the lines in input, every line has to be equally long
+	static Grid from_lines(aoc::StringView input, int64_t border = 0, T const& sentinel = T()) {
+		int64_t width = input.find('\n');
+		if (width == int64_t(aoc::StringView::npos)) {
+			width = input.length();
+		}
+		// count lines without making a pass per line
+		int64_t height = std::count(input.begin(), input.end(), '\n');
+		if (!input.empty() && input.back() != '\n') {
+			++height;
+		}
+
+		Grid grid(width, height, sentinel, border, sentinel);
+		for (int64_t y = 0; y < height; ++y) {
+			aoc::StringView line = input.substr(y * (width + 1), width);
+			if (int64_t(line.length()) != width ||
+				(y * (width + 1) + width < int64_t(input.length()) && input[y * (width + 1) + width] != '\n')) {
+				throw std::runtime_error("bad grid");
+			}
+			std::copy(line.begin(), line.end(), grid.cells.data() + grid.index(0, y));
+		}
+		return grid;
+	}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Accessors                                 */
+/* -------------------------------------------------------------------------- */
+
+	int64_t width(void) const { return w; }
+	int64_t height(void) const { return h; }
+	int64_t border(void) const { return b; }
+	int64_t stride(void) const { return s; }
+	bool empty(void) const { return w == 0 || h == 0; }
+
+	T* data(void) { return cells.data(); }
+	T const* data(void) const { return cells.data(); }
+	// size of the whole buffer, border included
+	size_t size(void) const { return cells.size(); }
+
+	size_t index(int64_t x, int64_t y) const {
+		return (y + b) * s + (x + b);
+	}
+
+	size_t index(Vec2 const& p) const {
+		return index(p.x, p.y);
+	}
+
+	Vec2 position(size_t i) const {
+		return Vec2(int64_t(i) % s - b, int64_t(i) / s - b);
+	}
+
+	bool is_within_bounds(Vec2 const& p) const {
+		return (p.x >= 0 && p.x < w && p.y >= 0 && p.y < h);
+	}
+
+	reference operator[](size_t i) { return cells[i]; }
+	const_reference operator[](size_t i) const { return cells[i]; }
+
+	reference operator[](Vec2 const& p) { return cells[index(p)]; }
+	const_reference operator[](Vec2 const& p) const { return cells[index(p)]; }
+
+	reference at(int64_t x, int64_t y) { return cells[index(x, y)]; }
+	const_reference at(int64_t x, int64_t y) const { return cells[index(x, y)]; }
+
+	// the (inner) cells of row y
+	row_t row(int64_t y) { return {cells.data() + index(0, y), w}; }
+	const_row_t row(int64_t y) const { return {cells.data() + index(0, y), w}; }
+
+	// the (inner) cells of column x
+	column_t column(int64_t x) { return {cells.data() + index(x, 0), s, h}; }
+	const_column_t column(int64_t x) const { return {cells.data() + index(x, 0), s, h}; }
+
+/* -------------------------------------------------------------------------- */
+/*                              Neighbour Offsets                             */
+/* -------------------------------------------------------------------------- */
+	// Add these to a linear index to get to a neighbour.
+	// Only safe without bounds checks when border >= 1.
+
+	std::ptrdiff_t up(void) const { return -s; }
+	std::ptrdiff_t down(void) const { return s; }
+	std::ptrdiff_t left(void) const { return -1; }
+	std::ptrdiff_t right(void) const { return 1; }
+
+	std::ptrdiff_t offset(Vec2 const& d) const {
+		return d.y * s + d.x;
+	}
+
+	bool operator==(Grid const& rhs) const {
+		return (w == rhs.w && h == rhs.h && b == rhs.b && cells == rhs.cells);
+	}
+
+	private:
+	int64_t w;
+	int64_t h;
+	int64_t b;
+	int64_t s;
+	std::vector<T> cells;
+};
+
+#endif // GRID_H
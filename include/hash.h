@@ -0,0 +1,80 @@
+#ifndef HASH_H
+# define HASH_H
+
+# include <cstddef>
+# include <cstdint>
+# include <cstring>
+# include <functional>
+# include <vector>
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                   Hashing                                  */
+/* -------------------------------------------------------------------------- */
+// std::hash of the integers is the identity, fine for std::unordered_map (which
+// takes it modulo a prime) but not for power of two tables or for keys built
+// from small numbers (grid positions). mix64 spreads every input bit over the
+// whole result, it's a bijection so distinct keys never collide.
+
+// murmur3 finalizer
+inline uint64_t mix64(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+// Fold the hash of value into seed (order matters: (a, b) and (b, a) differ)
+template <typename T>
+void hash_combine(size_t& seed, T const& value) {
+	seed = size_t(mix64(seed + 0x9e3779b97f4a7c15ULL + std::hash<T>()(value)));
+}
+
+inline size_t hash_values(void) {
+	return 0;
+}
+
+// One hash for several values, for the std::hash of small structs:
+//     return aoc::hash_values(s.pos, s.dir, s.count);
+template <typename T, typename... Rest>
+size_t hash_values(T const& first, Rest const&... rest) {
+	size_t seed = hash_values(rest...);
+	hash_combine(seed, first);
+	return seed;
+}
+
+// Hash of a whole buffer, 8 bytes per round (like a round of xxHash64), for
+// keying things by content. Not for hash tables of short keys.
+inline uint64_t hash_bytes(void const* data, size_t n, uint64_t seed = 0) {
+	static uint64_t const K1 = 0x9e3779b185ebca87ULL, K2 = 0xc2b2ae3d27d4eb4fULL;
+	unsigned char const* p = static_cast<unsigned char const*>(data);
+	uint64_t h = seed + K1 * n;
+	for (; n >= 8; p += 8, n -= 8) {
+		uint64_t word;
+		std::memcpy(&word, p, 8);
+		h ^= word * K2;
+		h = ((h << 31) | (h >> 33)) * K1;
+	}
+	uint64_t tail = 0;
+	std::memcpy(&tail, p, n);
+	return mix64(h ^ (tail * K2));
+}
+
+// count random 64 bit keys (a counter through mix64, like splitmix64) for
+// Zobrist hashing: the hash of a set of things (rocks on cells, ...) is the xor
+// of their keys, so adding or removing one is a single xor instead of hashing
+// the whole state again
+inline std::vector<uint64_t> zobrist_keys(size_t count, uint64_t seed = 0) {
+	std::vector<uint64_t> keys(count);
+	for (size_t i = 0; i < count; ++i) {
+		keys[i] = mix64(seed += 0x9e3779b97f4a7c15ULL);
+	}
+	return keys;
+}
+
+} // namespace aoc
+
+#endif // HASH_H
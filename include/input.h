@@ -0,0 +1,141 @@
+#ifndef INPUT_H
+# define INPUT_H
+
+# include "view.h"
+
+# include <istream>
+# include <streambuf>
+# include <iterator>
+# include <string>
+# include <vector>
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                    Input                                   */
+/* -------------------------------------------------------------------------- */
+// Owns the bytes of an input. Regular files are memory-mapped, anything else
+// (stdin, pipes, fifo's) is read in bulk into a single buffer.
+// The whole input stays valid for the lifetime of this object, so views
+// handed out by it don't need to copy anything.
+struct Input {
+	Input();
+	Input(Input&& other);
+	Input& operator=(Input&& other);
+	~Input();
+
+	Input(Input const&) = delete;
+	Input& operator=(Input const&) = delete;
+
+	// map the file at path (or read it if it can't be mapped)
+	static Input from_file(std::string const& path);
+	// map or read everything from an open file descriptor
+	static Input from_fd(int fd);
+
+	char const* data(void) const { return ptr; }
+	size_t size(void) const { return len; }
+	bool is_mapped(void) const { return mapped; }
+
+	StringView view(void) const {
+		return StringView(ptr, len);
+	}
+
+	private:
+	void release(void);
+
+	char const* ptr;
+	size_t len;
+	bool mapped;
+	std::vector<char> buffer;
+};
+
+// return the mapped input file if there's a file or the contents of stdin if there's none
+Input map_input(int argc, char** argv);
+
+/* -------------------------------------------------------------------------- */
+/*                                 View Lines                                 */
+/* -------------------------------------------------------------------------- */
+
+// pop the first line (without '\n') off of input
+StringView next_line(StringView& input);
+
+// Same as LineIterator, but hands out views into the input instead of copies
+struct ViewLineIterator {
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = StringView;
+	using difference_type = std::ptrdiff_t;
+	using reference = value_type const&;
+	using pointer = value_type const*;
+
+	ViewLineIterator() : rest(), line(), at_end(true) {}
+	ViewLineIterator(StringView input) : rest(input), line(), at_end(false) {
+		++(*this);
+	}
+
+	reference operator*() const { return line; }
+	pointer operator->() const { return &line; }
+
+	ViewLineIterator& operator++() {
+		if (rest.empty()) {
+			at_end = true;
+			line = StringView();
+		} else {
+			line = next_line(rest);
+		}
+		return *this;
+	}
+
+	ViewLineIterator operator++(int) {
+		ViewLineIterator copy(*this);
+		++(*this);
+		return copy;
+	}
+
+	bool operator==(ViewLineIterator const& rhs) const {
+		return (at_end == rhs.at_end && (at_end || line.data() == rhs.line.data()));
+	}
+
+	bool operator!=(ViewLineIterator const& rhs) const {
+		return !(*this == rhs);
+	}
+
+	// everything after the current line
+	StringView remaining(void) const { return rest; }
+
+	private:
+	StringView rest;
+	StringView line;
+	bool at_end;
+};
+
+// handy for range-based loops, zero-copy counterpart of Lines
+struct ViewLines {
+	ViewLines(StringView input) : input(input) {}
+	ViewLineIterator begin() const { return ViewLineIterator(input); }
+	ViewLineIterator end() const { return ViewLineIterator(); }
+
+	private:
+	StringView input;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                 View Stream                                */
+/* -------------------------------------------------------------------------- */
+// Read-only streambuf directly on top of a view, no copy is made
+struct ViewStreamBuf : public std::streambuf {
+	ViewStreamBuf(StringView view) {
+		char* p = const_cast<char*>(view.data());
+		setg(p, p, p + view.size());
+	}
+};
+
+// std::istream over a view, for the parsers that still like operator>>
+struct ViewStream : private ViewStreamBuf, public std::istream {
+	ViewStream(StringView view) : ViewStreamBuf(view), std::istream(this) {}
+
+	using std::istream::imbue;
+};
+
+} // namespace aoc
+
+#endif // INPUT_H
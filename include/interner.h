@@ -0,0 +1,56 @@
+#ifndef INTERNER_H
+# define INTERNER_H
+
+# include <cstdint>
+# include <string>
+# include <vector>
+
+# include "view.h"
+
+namespace aoc {
+
+struct BinaryWriter;
+struct BinaryReader;
+
+/* -------------------------------------------------------------------------- */
+/*                                  Interner                                  */
+/* -------------------------------------------------------------------------- */
+// Symbol table handing out dense ids (0, 1, 2...) in order of first sight, so
+// string keyed graphs can be stored in plain vectors indexed by id and the
+// strings only get hashed once, at parse time.
+//
+//     Interner names;
+//     auto aaa = names.intern("AAA"); // 0
+//     names.intern("AAA");            // 0 again
+//     names.name(aaa);                // "AAA"
+struct Interner {
+	typedef uint32_t id_t;
+	static id_t const NONE = UINT32_MAX;
+
+	// id of label, a new one if it hasn't been seen before
+	id_t intern(StringView label);
+	// id of label or NONE, never adds it
+	id_t find(StringView label) const;
+
+	// reverse lookup, id has to come from this interner
+	std::string const& name(id_t id) const { return names[id]; }
+
+	size_t size(void) const { return names.size(); }
+	void reserve(size_t n);
+
+	private:
+	// the parse cache saves and restores the tables as they are (parse_cache.h)
+	friend struct BinaryWriter;
+	friend struct BinaryReader;
+
+	size_t slot_of(StringView label, size_t hash) const;
+	void rehash(size_t slot_count);
+
+	std::vector<std::string> names; // by id
+	std::vector<size_t> hashes;     // by id, to rehash without hashing again
+	std::vector<id_t> slots;        // open addressing (linear probing), NONE is empty
+};
+
+} // namespace aoc
+
+#endif // INTERNER_H
@@ -0,0 +1,81 @@
+#ifndef MEMORY_H
+# define MEMORY_H
+
+# include <cstddef>
+# include <cstdint>
+# include <ostream>
+# include <vector>
+
+namespace aoc {
+namespace memory {
+
+/* -------------------------------------------------------------------------- */
+/*                             Memory accounting                              */
+/* -------------------------------------------------------------------------- */
+// Counts of every operator new/delete, in total and per phase, when the binary
+// links the memory_hook library (which replaces the global operator new and
+// delete). Without it everything here reads 0 and hooked() is false.
+//
+// Only built with -DAOC_MEMORY=ON (common links it then), every program prints
+// report() to stderr at exit and aoc_bench fills its allocs column. Without the
+// sanitizer, whose runtime brings its own operator new.
+//
+// A phase is whatever ScopedPhase (or ScopedTimer, which opens one) is
+// innermost on the allocating thread, "dayNN parse" and so on. Names are not
+// copied, they have to outlive the program (string literals).
+
+struct Totals {
+	uint64_t allocations;
+	uint64_t frees;
+	uint64_t bytes;           // allocated so far, freed or not
+	uint64_t live_bytes;      // allocated and not freed yet
+	uint64_t peak_live_bytes;
+};
+
+struct PhaseStats {
+	char const* name;
+	uint64_t allocations;
+	uint64_t bytes;
+	// highest live_bytes (of the whole process) while an allocation of the
+	// phase happened, other threads allocating at the same time count too
+	uint64_t peak_live_bytes;
+};
+
+// whether operator new is counted at all (memory_hook is linked)
+bool hooked(void);
+
+Totals totals(void);
+// every phase that allocated, in the order they were first entered
+std::vector<PhaseStats> phases(void);
+
+// VmHWM of /proc/self/status (peak resident set size) in kB, 0 if unknown
+size_t peak_rss_kb(void);
+
+// one line per phase with totals and the peak RSS
+void report(std::ostream& out);
+
+// Allocations of this thread go to name until the end of scope, nests
+struct ScopedPhase {
+	explicit ScopedPhase(char const* name);
+	~ScopedPhase();
+
+	ScopedPhase(ScopedPhase const&) = delete;
+	ScopedPhase& operator=(ScopedPhase const&) = delete;
+
+	private:
+	size_t previous;
+};
+
+namespace detail {
+
+// for memory_hook, must not allocate
+void record_allocation(size_t bytes);
+void record_free(size_t bytes);
+void set_hooked(void);
+
+} // namespace detail
+
+} // namespace memory
+} // namespace aoc
+
+#endif // MEMORY_H
@@ -0,0 +1,111 @@
+#ifndef NUMBER_THEORY_H
+# define NUMBER_THEORY_H
+
+# include <cstdint>
+# include <limits>
+# include <stdexcept>
+# include <type_traits>
+# include <vector>
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                     GCD                                    */
+/* -------------------------------------------------------------------------- */
+
+namespace detail {
+
+template <typename T>
+typename std::make_unsigned<T>::type unsigned_abs(T n) {
+	typedef typename std::make_unsigned<T>::type unsigned_t;
+	return (n < 0) ? unsigned_t(0) - unsigned_t(n) : unsigned_t(n);
+}
+
+} // namespace detail
+
+// Euclid, O(log(min(a, b))) divisions. gcd(0, 0) is 0.
+template <typename T>
+T gcd(T a, T b) {
+	static_assert(std::is_integral<T>::value, "Type has to be integral");
+	auto x = detail::unsigned_abs(a);
+	auto y = detail::unsigned_abs(b);
+	while (y != 0) {
+		auto r = x % y;
+		x = y;
+		y = r;
+	}
+	return T(x);
+}
+
+// Stein's binary GCD, only shifts and subtractions
+inline uint64_t binary_gcd(uint64_t a, uint64_t b) {
+	if (a == 0) return b;
+	if (b == 0) return a;
+
+	int shift = __builtin_ctzll(a | b); // common factors of 2
+	a >>= __builtin_ctzll(a);
+	do {
+		b >>= __builtin_ctzll(b);
+		if (a > b) {
+			uint64_t t = a;
+			a = b;
+			b = t;
+		}
+		b -= a;
+	} while (b != 0);
+	return a << shift;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                     LCM                                    */
+/* -------------------------------------------------------------------------- */
+
+// lcm of a and b (always positive) into out, false if it doesn't fit in T
+template <typename T>
+bool checked_lcm(T a, T b, T& out) {
+	static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "Type has to be integral, at most 64 bits");
+	if (a == 0 || b == 0) {
+		out = 0;
+		return true;
+	}
+	auto x = detail::unsigned_abs(a);
+	auto y = detail::unsigned_abs(b);
+	unsigned __int128 l = static_cast<unsigned __int128>(x / gcd(x, y)) * y;
+	if (l > static_cast<unsigned __int128>(std::numeric_limits<T>::max())) {
+		return false;
+	}
+	out = T(l);
+	return true;
+}
+
+// lcm of a and b, throws std::overflow_error if it doesn't fit in T
+template <typename T>
+T lcm(T a, T b) {
+	T out;
+	if (!checked_lcm(a, b, out)) {
+		throw std::overflow_error("lcm does not fit");
+	}
+	return out;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Cycles                                   */
+/* -------------------------------------------------------------------------- */
+// Chinese remainder theorem for things that repeat: a cycle is every
+// offset + k * period (k >= 0), period 0 is just offset itself.
+// The periods don't have to be coprime and the offsets don't have to be 0.
+struct Cycle {
+	uint64_t offset;
+	uint64_t period;
+};
+
+// Every value that is in both a and b, as a cycle.
+// False if they never meet or if it doesn't fit in 64 bits.
+bool combine_cycles(Cycle const& a, Cycle const& b, Cycle& out);
+
+// Fold all cycles into one (out.offset is the first time all of them meet)
+bool combine_cycles(std::vector<Cycle> const& cycles, Cycle& out);
+
+} // namespace aoc
+
+#endif // NUMBER_THEORY_H
@@ -0,0 +1,97 @@
+#ifndef PARALLEL_H
+# define PARALLEL_H
+
+# include <cstddef>
+# include <functional>
+# include <iterator>
+# include <type_traits>
+# include <utility>
+# include <vector>
+
+# include "view.h"
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                 Map-Reduce                                 */
+/* -------------------------------------------------------------------------- */
+// For days where every line (or every parsed entry) is independent: split the
+// work into chunks, map every chunk on its own thread and fold the partial
+// results in chunk order. The result only depends on the chunks, not on which
+// thread finished first, so the answer is the same as the sequential one as
+// long as reduce is associative (sums, concatenating vectors...).
+//
+//     uint64_t total = parallel_lines(input,
+//         [](StringView lines) { return sum_of(lines); },
+//         [](uint64_t a, uint64_t b) { return a + b; });
+//
+// Small inputs aren't split at all, starting threads costs more than they save.
+
+// threads used when 0 is passed, the size of ThreadPool::global()
+size_t parallel_threads(void);
+
+// buffer split at line ends into at most max_chunks pieces of at least
+// min_bytes (but the last). Always at least one, even if buffer is empty.
+std::vector<StringView> split_lines(StringView buffer, size_t max_chunks, size_t min_bytes = 64 * 1024);
+
+// fn(0) ... fn(n - 1) as tasks of ThreadPool::global() (fn(0) on the calling
+// thread). The exception of the lowest i that threw is rethrown once all are done.
+void run_parallel(size_t n, std::function<void(size_t)> const& fn);
+
+namespace detail {
+
+template <typename R, typename Reduce>
+R fold(std::vector<R>& partial, Reduce& reduce) {
+	R result = std::move(partial[0]);
+	for (size_t i = 1; i < partial.size(); ++i) {
+		result = reduce(std::move(result), std::move(partial[i]));
+	}
+	return result;
+}
+
+} // namespace detail
+
+// b appended to a, the reduce for parsing chunks into vectors
+template <typename T>
+std::vector<T> concat(std::vector<T> a, std::vector<T> b) {
+	a.insert(a.end(), std::make_move_iterator(b.begin()), std::make_move_iterator(b.end()));
+	return a;
+}
+
+// map(StringView lines) -> R for chunks of whole lines, reduce(R, R) -> R
+template <typename Map, typename Reduce>
+typename std::decay<typename std::result_of<Map(StringView)>::type>::type
+parallel_lines(StringView buffer, Map map, Reduce reduce, size_t threads = 0) {
+	typedef typename std::decay<typename std::result_of<Map(StringView)>::type>::type result_t;
+
+	auto chunks = split_lines(buffer, threads ? threads : parallel_threads());
+	std::vector<result_t> partial(chunks.size());
+	run_parallel(chunks.size(), [&](size_t i) {
+		partial[i] = map(chunks[i]);
+	});
+	return detail::fold(partial, reduce);
+}
+
+// map(begin, end) -> R for ranges of [0, n) of at least grain indices,
+// reduce(R, R) -> R. n == 0 is one call to map(0, 0).
+template <typename Map, typename Reduce>
+typename std::decay<typename std::result_of<Map(size_t, size_t)>::type>::type
+parallel_reduce(size_t n, size_t grain, Map map, Reduce reduce, size_t threads = 0) {
+	typedef typename std::decay<typename std::result_of<Map(size_t, size_t)>::type>::type result_t;
+
+	size_t chunks = threads ? threads : parallel_threads();
+	if (grain == 0) {
+		grain = 1;
+	}
+	chunks = std::max<size_t>(1, std::min(chunks, n / grain));
+
+	std::vector<result_t> partial(chunks);
+	run_parallel(chunks, [&](size_t i) {
+		partial[i] = map(n * i / chunks, n * (i + 1) / chunks);
+	});
+	return detail::fold(partial, reduce);
+}
+
+} // namespace aoc
+
+#endif // PARALLEL_H
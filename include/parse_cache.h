@@ -0,0 +1,213 @@
+#ifndef PARSE_CACHE_H
+# define PARSE_CACHE_H
+
+# include <algorithm>
+# include <cstdint>
+# include <cstring>
+# include <stdexcept>
+# include <string>
+# include <type_traits>
+# include <vector>
+
+# include "grid.h"
+# include "interner.h"
+# include "solution.h"
+# include "view.h"
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                               Binary Writer                                */
+/* -------------------------------------------------------------------------- */
+// Flat little-endian dump of parsed data, in the order it's read back by a
+// BinaryReader. Only trivially copyable values are written as they are,
+// anything else is written field by field by the day that owns it.
+struct BinaryWriter {
+	template <typename T>
+	void write(T const& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "write() needs a trivially copyable type");
+		bytes.append(reinterpret_cast<char const*>(&value), sizeof(T));
+	}
+
+	// length and then the elements
+	template <typename T>
+	void write(std::vector<T> const& values) {
+		static_assert(std::is_trivially_copyable<T>::value, "write() needs a trivially copyable type");
+		write<uint64_t>(values.size());
+		bytes.append(reinterpret_cast<char const*>(values.data()), values.size() * sizeof(T));
+	}
+
+	void write(std::string const& str) {
+		write<uint64_t>(str.size());
+		bytes.append(str);
+	}
+
+	// the tables as they are, reading them back doesn't hash anything
+	void write(Interner const& names) {
+		write<uint64_t>(names.names.size());
+		for (auto const& name : names.names) {
+			write(name);
+		}
+		write(names.hashes);
+		write(names.slots);
+	}
+
+	// the whole buffer, border included
+	template <typename T>
+	void write(Grid<T> const& grid) {
+		static_assert(std::is_trivially_copyable<T>::value, "write() needs a trivially copyable type");
+		write<int64_t>(grid.width());
+		write<int64_t>(grid.height());
+		write<int64_t>(grid.border());
+		bytes.append(reinterpret_cast<char const*>(grid.data()), grid.size() * sizeof(T));
+	}
+
+	std::string bytes;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                               Binary Reader                                */
+/* -------------------------------------------------------------------------- */
+// Reads what a BinaryWriter wrote, straight out of a (mapped) buffer. Every
+// read is bounds checked, a truncated or corrupted buffer throws instead of
+// reading past the end.
+struct BinaryReader {
+	explicit BinaryReader(StringView bytes) : rest(bytes) {}
+
+	template <typename T>
+	T read(void) {
+		static_assert(std::is_trivially_copyable<T>::value, "read() needs a trivially copyable type");
+		T value;
+		std::memcpy(&value, take(sizeof(T)), sizeof(T));
+		return value;
+	}
+
+	template <typename T>
+	void read(std::vector<T>& values) {
+		static_assert(std::is_trivially_copyable<T>::value, "read() needs a trivially copyable type");
+		uint64_t n = read<uint64_t>();
+		if (n > rest.size() / std::max<size_t>(1, sizeof(T))) {
+			throw std::runtime_error("BinaryReader: truncated data");
+		}
+		values.resize(n);
+		std::memcpy(values.data(), take(n * sizeof(T)), n * sizeof(T));
+	}
+
+	void read(std::string& str) {
+		uint64_t n = read<uint64_t>();
+		char const* p = take(n);
+		str.assign(p, n);
+	}
+
+	void read(Interner& names) {
+		names.names.resize(read<uint64_t>());
+		for (auto& name : names.names) {
+			read(name);
+		}
+		read(names.hashes);
+		read(names.slots);
+
+		// a bad id would be indexed with later on
+		size_t n = names.names.size();
+		size_t slot_count = names.slots.size();
+		bool ok = (names.hashes.size() == n &&
+				   ((n == 0 && slot_count == 0) || (slot_count > n && (slot_count & (slot_count - 1)) == 0)));
+		for (size_t i = 0; ok && i < names.slots.size(); ++i) {
+			ok = (names.slots[i] == Interner::NONE || names.slots[i] < n);
+		}
+		if (!ok) {
+			throw std::runtime_error("BinaryReader: bad interner tables");
+		}
+	}
+
+	template <typename T>
+	void read(Grid<T>& grid) {
+		int64_t width = read<int64_t>();
+		int64_t height = read<int64_t>();
+		int64_t border = read<int64_t>();
+		if (width < 0 || height < 0 || border < 0 ||
+			uint64_t(width + 2 * border) * uint64_t(height + 2 * border) > rest.size() / sizeof(T)) {
+			throw std::runtime_error("BinaryReader: bad grid size");
+		}
+		grid = Grid<T>(width, height, T(), border, T());
+		std::memcpy(grid.data(), take(grid.size() * sizeof(T)), grid.size() * sizeof(T));
+	}
+
+	bool at_end(void) const { return rest.empty(); }
+
+	private:
+	char const* take(size_t n) {
+		if (n > rest.size()) {
+			throw std::runtime_error("BinaryReader: truncated data");
+		}
+		char const* p = rest.data();
+		rest = rest.substr(n);
+		return p;
+	}
+
+	StringView rest;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                 Parse Cache                                */
+/* -------------------------------------------------------------------------- */
+// Parsed inputs saved as DIR/dayNN-HASH.bin (HASH of the content of the input)
+// the first time a day parses an input, later runs with the same input map the
+// file and load it instead of parsing. A file is only used when its header
+// matches: format version, day, the cache_version of the day, input size and
+// hash. Anything else (a day changed its layout, a corrupted file) is parsed
+// again and overwritten.
+//
+// Only for days that opted in with with_parse_cache(), the rest always parse.
+struct ParseCache {
+	// an empty dir turns the cache off
+	explicit ParseCache(std::string dir = "") : dir(std::move(dir)) {}
+	// $AOC_CACHE_DIR, off if it isn't set
+	static ParseCache from_env(void);
+
+	bool enabled(void) const { return !dir.empty(); }
+
+	// parsed input of solution, loaded from the cache if possible, parsed (and
+	// saved for next time) if not. hit tells which one it was.
+	Solution::parsed_t parse(Solution const& solution, StringView input, bool* hit = nullptr) const;
+
+	std::string path_of(int day, uint64_t input_hash) const;
+
+	private:
+	std::string dir;
+};
+
+// hash_bytes() of input, what cache files are keyed by
+uint64_t content_hash(StringView input);
+
+// Adds saving and loading of the parsed data to s. Bump version whenever
+// the layout of Parsed (or of what save writes) changes.
+template <typename Parsed>
+Solution with_parse_cache(Solution s, uint32_t version,
+						  void (*save)(BinaryWriter&, Parsed const&), Parsed (*load)(BinaryReader&)) {
+	s.cache_version = version;
+	s.save = [save](void const* parsed, BinaryWriter& out) {
+		save(out, *static_cast<Parsed const*>(parsed));
+	};
+	s.load = [load](BinaryReader& in) -> Solution::parsed_t {
+		return std::make_shared<Parsed>(load(in));
+	};
+	return s;
+}
+
+// save and load of the days whose parsed data is a single grid
+template <typename T>
+void save_grid(BinaryWriter& out, Grid<T> const& grid) {
+	out.write(grid);
+}
+
+template <typename T>
+Grid<T> load_grid(BinaryReader& in) {
+	Grid<T> grid;
+	in.read(grid);
+	return grid;
+}
+
+} // namespace aoc
+
+#endif // PARSE_CACHE_H
@@ -2,7 +2,13 @@
 # define RANGE_H
 
 # include <algorithm>
+# include <cstdint>
+# include <memory>
+# include <stdexcept>
+# include <utility>
+# include <vector>
 
+// Half open [begin, end)
 struct Range {
 	uint64_t begin;
 	uint64_t end;
@@ -15,10 +21,18 @@ struct Range {
 		return end > begin;
 	}
 
-	bool operator<(Range const& rhs) {
+	bool operator<(Range const& rhs) const {
 		return begin < rhs.begin;
 	}
 
+	bool operator==(Range const& rhs) const {
+		return begin == rhs.begin && end == rhs.end;
+	}
+
+	uint64_t length(void) const {
+		return end > begin ? end - begin : 0;
+	}
+
 	bool includes(uint64_t value) const {
 		if (value >= begin && value < end) {
 			return true;
@@ -34,4 +48,272 @@ struct Range {
 	}
 };
 
+/* -------------------------------------------------------------------------- */
+/*                                Interval Set                                */
+/* -------------------------------------------------------------------------- */
+// Set of values kept as sorted, disjoint and non adjacent ranges (touching ones
+// are merged), so n values in k runs cost k ranges no matter how they were
+// split up on the way. Set operations walk both sets once, O(n + m).
+//
+// Allocator is for the ranges, day 19 copies its sets a lot and keeps them in
+// the scratch arena (aoc::ArenaAllocator<Range>).
+template <typename Allocator = std::allocator<Range>>
+struct BasicIntervalSet {
+	using allocator_type = Allocator;
+	using ranges_t = std::vector<Range, Allocator>;
+	using const_iterator = typename ranges_t::const_iterator;
+
+	explicit BasicIntervalSet(Allocator const& alloc = Allocator()) : ranges(alloc) {}
+
+	BasicIntervalSet(Range range, Allocator const& alloc = Allocator()) : ranges(alloc) {
+		if (range) {
+			ranges.push_back(range);
+		}
+	}
+
+	// any ranges, in any order, O(n log n)
+	template <typename It>
+	BasicIntervalSet(It first, It last, Allocator const& alloc = Allocator()) : ranges(first, last, alloc) {
+		normalize();
+	}
+
+	const_iterator begin(void) const { return ranges.begin(); }
+	const_iterator end(void) const { return ranges.end(); }
+	allocator_type get_allocator(void) const { return ranges.get_allocator(); }
+
+	bool empty(void) const { return ranges.empty(); }
+	// number of ranges
+	size_t count(void) const { return ranges.size(); }
+	// number of values
+	uint64_t size(void) const {
+		uint64_t n = 0;
+		for (auto const& r : ranges) {
+			n += r.length();
+		}
+		return n;
+	}
+	// lowest value, the set must not be empty
+	uint64_t min(void) const { return ranges.front().begin; }
+
+	bool contains(uint64_t value) const {
+		auto it = std::upper_bound(ranges.begin(), ranges.end(), value,
+			[](uint64_t v, Range const& r) { return v < r.end; });
+		return it != ranges.end() && it->includes(value);
+	}
+
+	void clear(void) { ranges.clear(); }
+
+	// O(n), use the iterator constructor to add many at once
+	void insert(Range range) {
+		if (!range) {
+			return ;
+		}
+		// first range that ends at or after range begins, and the first one
+		// after range (both merge with it when touching)
+		auto first = std::lower_bound(ranges.begin(), ranges.end(), range.begin,
+			[](Range const& r, uint64_t v) { return r.end < v; });
+		auto last = first;
+		while (last != ranges.end() && last->begin <= range.end) {
+			range = Range(std::min(range.begin, last->begin), std::max(range.end, last->end));
+			++last;
+		}
+		first = ranges.erase(first, last);
+		ranges.insert(first, range);
+	}
+
+	// every value moved by offset, which must not take any below 0 or past the max
+	void translate(int64_t offset) {
+		for (auto& r : ranges) {
+			r.begin += offset;
+			r.end += offset;
+		}
+	}
+
+	BasicIntervalSet unite(BasicIntervalSet const& other) const {
+		BasicIntervalSet result(get_allocator());
+		result.ranges.reserve(ranges.size() + other.ranges.size());
+		auto a = ranges.begin(), b = other.ranges.begin();
+		while (a != ranges.end() || b != other.ranges.end()) {
+			bool take_a = (b == other.ranges.end() || (a != ranges.end() && a->begin < b->begin));
+			result.append(take_a ? *a++ : *b++);
+		}
+		return result;
+	}
+
+	BasicIntervalSet intersect(BasicIntervalSet const& other) const {
+		BasicIntervalSet result(get_allocator());
+		auto a = ranges.begin(), b = other.ranges.begin();
+		while (a != ranges.end() && b != other.ranges.end()) {
+			Range overlap = a->intersect(*b);
+			if (overlap) {
+				result.ranges.push_back(overlap);
+			}
+			// the one that ends first can't overlap anything else
+			if (a->end < b->end) {
+				++a;
+			} else {
+				++b;
+			}
+		}
+		return result;
+	}
+
+	// the values of this set which aren't in other
+	BasicIntervalSet subtract(BasicIntervalSet const& other) const {
+		BasicIntervalSet result(get_allocator());
+		auto b = other.ranges.begin();
+		for (Range r : ranges) {
+			while (b != other.ranges.end() && b->end <= r.begin) {
+				++b;
+			}
+			// cut out every range of other overlapping r
+			for (auto it = b; it != other.ranges.end() && it->begin < r.end; ++it) {
+				if (it->begin > r.begin) {
+					result.ranges.push_back(Range(r.begin, it->begin));
+				}
+				r.begin = std::max(r.begin, it->end);
+			}
+			if (r) {
+				result.ranges.push_back(r);
+			}
+		}
+		return result;
+	}
+
+	// (values below at, values from at on)
+	std::pair<BasicIntervalSet, BasicIntervalSet> split(uint64_t at) const {
+		allocator_type alloc = get_allocator();
+		std::pair<BasicIntervalSet, BasicIntervalSet> halves(BasicIntervalSet{alloc}, BasicIntervalSet{alloc});
+		for (auto const& r : ranges) {
+			if (r.end <= at) {
+				halves.first.ranges.push_back(r);
+			} else if (r.begin >= at) {
+				halves.second.ranges.push_back(r);
+			} else {
+				halves.first.ranges.push_back(Range(r.begin, at));
+				halves.second.ranges.push_back(Range(at, r.end));
+			}
+		}
+		return halves;
+	}
+
+	bool operator==(BasicIntervalSet const& rhs) const {
+		return ranges.size() == rhs.ranges.size() && std::equal(ranges.begin(), ranges.end(), rhs.ranges.begin());
+	}
+
+	private:
+	template <typename> friend struct BasicIntervalSet;
+	friend struct PiecewiseMap;
+
+	// r must not begin before the last range
+	void append(Range r) {
+		if (!r) {
+			return ;
+		}
+		if (!ranges.empty() && r.begin <= ranges.back().end) {
+			ranges.back().end = std::max(ranges.back().end, r.end);
+		} else {
+			ranges.push_back(r);
+		}
+	}
+
+	void normalize(void) {
+		std::sort(ranges.begin(), ranges.end());
+		size_t n = 0;
+		for (size_t i = 0; i < ranges.size(); ++i) {
+			Range r = ranges[i];
+			if (!r) {
+				continue ;
+			}
+			if (n > 0 && r.begin <= ranges[n - 1].end) {
+				ranges[n - 1].end = std::max(ranges[n - 1].end, r.end);
+			} else {
+				ranges[n++] = r;
+			}
+		}
+		ranges.resize(n);
+	}
+
+	ranges_t ranges;
+};
+
+using IntervalSet = BasicIntervalSet<>;
+
+/* -------------------------------------------------------------------------- */
+/*                                Piecewise Map                               */
+/* -------------------------------------------------------------------------- */
+// Function on values that shifts every value of a piece by the offset of that
+// piece and leaves values outside of every piece as they are (the day 5 maps).
+// Pieces must not overlap.
+struct PiecewiseMap {
+	struct Piece {
+		Range from;
+		int64_t offset;
+
+		bool operator<(Piece const& rhs) const {
+			return from < rhs.from;
+		}
+	};
+
+	PiecewiseMap() {}
+
+	// throws if two pieces overlap
+	explicit PiecewiseMap(std::vector<Piece> pieces) : pieces(std::move(pieces)) {
+		std::sort(this->pieces.begin(), this->pieces.end());
+		for (size_t i = 1; i < this->pieces.size(); ++i) {
+			if (this->pieces[i].from.begin < this->pieces[i - 1].from.end) {
+				throw std::runtime_error("PiecewiseMap: overlapping pieces");
+			}
+		}
+	}
+
+	using const_iterator = std::vector<Piece>::const_iterator;
+
+	size_t size(void) const { return pieces.size(); }
+	// the pieces, sorted
+	const_iterator begin(void) const { return pieces.begin(); }
+	const_iterator end(void) const { return pieces.end(); }
+
+	// O(log n)
+	uint64_t operator()(uint64_t value) const {
+		auto it = std::upper_bound(pieces.begin(), pieces.end(), value,
+			[](uint64_t v, Piece const& p) { return v < p.from.end; });
+		if (it != pieces.end() && it->from.includes(value)) {
+			return value + it->offset;
+		}
+		return value;
+	}
+
+	// Image of every value of set. Both are sorted so one walk over the two
+	// finds the overlaps, O(n + m), sorting the shifted ranges back is the log.
+	template <typename Allocator>
+	BasicIntervalSet<Allocator> apply(BasicIntervalSet<Allocator> const& set) const {
+		BasicIntervalSet<Allocator> result(set.get_allocator());
+		result.ranges.reserve(set.count() + pieces.size());
+
+		auto piece = pieces.begin();
+		for (Range r : set) {
+			while (piece != pieces.end() && piece->from.end <= r.begin) {
+				++piece;
+			}
+			for (auto it = piece; r && it != pieces.end() && it->from.begin < r.end; ++it) {
+				if (it->from.begin > r.begin) {
+					result.ranges.push_back(Range(r.begin, it->from.begin));
+				}
+				Range overlap = r.intersect(it->from);
+				result.ranges.push_back(Range(overlap.begin + it->offset, overlap.end + it->offset));
+				r.begin = overlap.end;
+			}
+			if (r) {
+				result.ranges.push_back(r);
+			}
+		}
+		result.normalize();
+		return result;
+	}
+
+	private:
+	std::vector<Piece> pieces;
+};
+
 #endif // RANGE_H
@@ -0,0 +1,320 @@
+#ifndef SCANNER_H
+# define SCANNER_H
+
+# include "view.h"
+
+# include <cstdint>
+# include <cstring>
+# include <stdexcept>
+# include <string>
+# include <type_traits>
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                   Charset                                  */
+/* -------------------------------------------------------------------------- */
+// Set of characters as a 256 bit mask, for cheap "is c one of these" checks
+struct Charset {
+	Charset() : bits{0, 0, 0, 0} {}
+
+	Charset(char const* chars) : bits{0, 0, 0, 0} {
+		for (; *chars; ++chars) {
+			insert(*chars);
+		}
+	}
+
+	Charset& insert(char c) {
+		unsigned char u = c;
+		bits[u >> 6] |= uint64_t(1) << (u & 63);
+		return *this;
+	}
+
+	bool contains(char c) const {
+		unsigned char u = c;
+		return (bits[u >> 6] >> (u & 63)) & 1;
+	}
+
+	Charset operator~() const {
+		Charset inverse;
+		for (size_t i = 0; i < 4; ++i) {
+			inverse.bits[i] = ~bits[i];
+		}
+		return inverse;
+	}
+
+	static Charset digits(void) {
+		return Charset("0123456789");
+	}
+
+	static Charset whitespace(void) {
+		return Charset(" \t\n\v\f\r");
+	}
+
+	private:
+	uint64_t bits[4];
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                Digit Parsing                               */
+/* -------------------------------------------------------------------------- */
+
+namespace detail {
+
+inline bool is_digit(char c) {
+	return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline int hex_value(char c) {
+	if (is_digit(c)) return c - '0';
+	c |= 0x20; // lowercase
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+# if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#  define AOC_SWAR_DIGITS 1
+
+// SWAR: check 8 characters at once for all being '0'-'9'
+inline bool is_eight_digits(uint64_t v) {
+	return (((v & 0xF0F0F0F0F0F0F0F0) |
+		(((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333);
+}
+
+// SWAR: turn 8 ascii digits (first digit in the lowest byte) into their value
+inline uint32_t parse_eight_digits(uint64_t v) {
+	v -= 0x3030303030303030;
+	v = (v * 10) + (v >> 8); // pairs of digits
+	v = (((v & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+		(((v >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+	return static_cast<uint32_t>(v);
+}
+# endif
+
+} // namespace detail
+
+/* -------------------------------------------------------------------------- */
+/*                                   Scanner                                  */
+/* -------------------------------------------------------------------------- */
+// Cursor over a buffer, a much cheaper replacement for istream extraction.
+// It never allocates and never looks at a locale.
+// Reading past the end is never an error, it just yields nothing (0 or an empty view).
+struct Scanner {
+	Scanner(StringView input) : cur(input.begin()), last(input.end()) {}
+	Scanner(char const* begin, char const* end) : cur(begin), last(end) {}
+
+	bool done(void) const { return cur >= last; }
+	char const* position(void) const { return cur; }
+	StringView rest(void) const { return StringView(cur, last); }
+
+	// current character or '\0' when done
+	char peek(void) const {
+		return done() ? '\0' : *cur;
+	}
+
+	// current character or '\0' when done, and advance
+	char get(void) {
+		return done() ? '\0' : *cur++;
+	}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Skipping                                  */
+/* -------------------------------------------------------------------------- */
+
+	Scanner& skip(size_t n = 1) {
+		cur = (size_t(last - cur) < n) ? last : cur + n;
+		return *this;
+	}
+
+	// skip until a character in charset (exclusive)
+	Scanner& skip_until(Charset const& charset) {
+		while (cur < last && !charset.contains(*cur)) {
+			++cur;
+		}
+		return *this;
+	}
+
+	// skip while the characters are in charset
+	Scanner& skip_while(Charset const& charset) {
+		while (cur < last && charset.contains(*cur)) {
+			++cur;
+		}
+		return *this;
+	}
+
+	Scanner& skip_whitespace(void) {
+		while (cur < last && (*cur == ' ' || *cur == '\t' || *cur == '\r' || *cur == '\n')) {
+			++cur;
+		}
+		return *this;
+	}
+
+	// skip past the end of the current line
+	Scanner& skip_line(void) {
+		void const* nl = std::memchr(cur, '\n', last - cur);
+		cur = nl ? static_cast<char const*>(nl) + 1 : last;
+		return *this;
+	}
+
+	// consume literal if it is next, return whether it was
+	bool accept(StringView literal) {
+		if (rest().starts_with(literal)) {
+			cur += literal.length();
+			return true;
+		}
+		return false;
+	}
+
+	// consume literal or throw
+	Scanner& expect(StringView literal) {
+		if (!accept(literal)) {
+			throw std::runtime_error("Expected \"" + literal.str() + "\" but got \"" +
+				rest().substr(0, literal.length()).str() + '\"');
+		}
+		return *this;
+	}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Tokens                                   */
+/* -------------------------------------------------------------------------- */
+
+	// return the run of characters in charset at the cursor
+	StringView take_while(Charset const& charset) {
+		char const* begin = cur;
+		skip_while(charset);
+		return StringView(begin, cur);
+	}
+
+	// return everything up to a character in charset (exclusive)
+	StringView take_until(Charset const& charset) {
+		char const* begin = cur;
+		skip_until(charset);
+		return StringView(begin, cur);
+	}
+
+	// skip leading delimiters and return everything up to the next one
+	StringView next_token(Charset const& delimiters) {
+		skip_while(delimiters);
+		return take_until(delimiters);
+	}
+
+	// next whitespace separated word
+	StringView next_word(void) {
+		skip_whitespace();
+		char const* begin = cur;
+		while (cur < last && !(*cur == ' ' || *cur == '\t' || *cur == '\r' || *cur == '\n')) {
+			++cur;
+		}
+		return StringView(begin, cur);
+	}
+
+	StringView next_line(void) {
+		char const* begin = cur;
+		void const* nl = std::memchr(cur, '\n', last - cur);
+		cur = nl ? static_cast<char const*>(nl) : last;
+		StringView line(begin, cur);
+		skip();
+		return line;
+	}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Integers                                  */
+/* -------------------------------------------------------------------------- */
+
+	// Skip to the next number and parse it, like `in >> next_digit >> n`.
+	// For signed T a '-' directly in front of the digits is part of the number.
+	// Returns false (and sets out to 0) if there are no numbers left.
+	template <typename T>
+	bool next_int(T& out) {
+		static_assert(std::is_integral<T>::value, "Type has to be integral");
+		bool negative = false;
+		for (;; ++cur) {
+			if (cur >= last) {
+				out = 0;
+				return false;
+			}
+			if (detail::is_digit(*cur)) {
+				break ;
+			}
+			if (std::is_signed<T>::value && *cur == '-' && cur + 1 < last && detail::is_digit(cur[1])) {
+				negative = true;
+				++cur;
+				break ;
+			}
+		}
+		typedef typename std::make_unsigned<T>::type unsigned_t;
+		unsigned_t n = parse_digits<unsigned_t>();
+		out = negative ? T(unsigned_t(0) - n) : T(n);
+		return true;
+	}
+
+	template <typename T = int64_t>
+	T next_int(void) {
+		T n = 0;
+		next_int(n);
+		return n;
+	}
+
+	// Skip to the next hexadecimal number (no prefix) and parse it, false (and
+	// out set to 0) if there is none
+	template <typename T>
+	bool next_hex(T& out) {
+		static_assert(std::is_integral<T>::value, "Type has to be integral");
+		while (cur < last && detail::hex_value(*cur) < 0) {
+			++cur;
+		}
+		if (cur >= last) {
+			out = 0;
+			return false;
+		}
+		T n = 0;
+		for (int v; cur < last && (v = detail::hex_value(*cur)) >= 0; ++cur) {
+			n = (n << 4) | T(v);
+		}
+		out = n;
+		return true;
+	}
+
+	template <typename T = uint64_t>
+	T next_hex(void) {
+		T n = 0;
+		next_hex(n);
+		return n;
+	}
+
+	private:
+	// Parse the digits at the cursor (without overflow check).
+	// Eight at a time while possible, then an unrolled tail.
+	template <typename T>
+	T parse_digits(void) {
+		T n = 0;
+# ifdef AOC_SWAR_DIGITS
+		uint64_t chunk;
+		while (last - cur >= 8) {
+			std::memcpy(&chunk, cur, sizeof(chunk));
+			if (!detail::is_eight_digits(chunk)) {
+				break ;
+			}
+			n = n * T(100000000) + T(detail::parse_eight_digits(chunk));
+			cur += 8;
+		}
+# endif
+		while (last - cur >= 4 && detail::is_digit(cur[0]) && detail::is_digit(cur[1]) &&
+			   detail::is_digit(cur[2]) && detail::is_digit(cur[3])) {
+			n = n * T(10000) + T((cur[0] - '0') * 1000 + (cur[1] - '0') * 100 + (cur[2] - '0') * 10 + (cur[3] - '0'));
+			cur += 4;
+		}
+		while (cur < last && detail::is_digit(*cur)) {
+			n = n * T(10) + T(*cur - '0');
+			++cur;
+		}
+		return n;
+	}
+
+	char const* cur;
+	char const* last;
+};
+
+} // namespace aoc
+
+#endif // SCANNER_H
@@ -0,0 +1,407 @@
+#ifndef SEARCH_H
+# define SEARCH_H
+
+# include <algorithm>
+# include <cstddef>
+# include <cstdint>
+# include <functional>
+# include <initializer_list>
+# include <limits>
+# include <stdexcept>
+# include <string>
+# include <utility>
+# include <vector>
+
+# include "trace.h"
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                Graph search                                */
+/* -------------------------------------------------------------------------- */
+// BFS/DFS, Dijkstra and A* over states numbered 0 to state_count - 1. The day
+// encodes its states (position, direction, ...) into those numbers, the
+// searches keep everything per state in flat arrays indexed by them.
+//
+// The graph is a neighbour generator: neighbours(state, emit) calls
+// emit(next, cost) for every edge out of state. The same generator works with
+// every search (BFS and DFS ignore the cost), so a day can switch engines and
+// queues without touching its graph.
+//
+// Search objects keep their arrays and queues between runs, a day that
+// searches many times (from every start, ...) creates one and reuses it.
+
+// encodes the day's own state into a dense number, a mixed radix (the last
+// part varying fastest):
+//     DenseStates states({grid.size(), 4, 11}); // cell, direction, count
+//     uint32_t s = states.encode({cell, dir, count});
+// Throws if there are more states than a uint32_t can number.
+struct DenseStates {
+	explicit DenseStates(std::initializer_list<size_t> radices) : radices(radices) {
+		// checked as it's multiplied, the product itself could overflow size_t
+		size_t n = 1;
+		for (size_t r : radices) {
+			if (r != 0 && n > std::numeric_limits<uint32_t>::max() / r) {
+				throw std::runtime_error("DenseStates: more than " +
+										 std::to_string(std::numeric_limits<uint32_t>::max()) +
+										 " states don't fit in a uint32_t");
+			}
+			n *= r;
+		}
+	}
+
+	size_t count(void) const {
+		size_t n = 1;
+		for (size_t r : radices) {
+			n *= r;
+		}
+		return n;
+	}
+
+	uint32_t encode(std::initializer_list<size_t> parts) const {
+		size_t s = 0;
+		auto r = radices.begin();
+		for (size_t p : parts) {
+			s = s * *r++ + p;
+		}
+		return uint32_t(s);
+	}
+
+	// part i of state s
+	size_t decode(uint32_t s, size_t i) const {
+		for (size_t j = radices.size(); j-- > i + 1; ) {
+			s /= uint32_t(radices[j]);
+		}
+		return s % radices[i];
+	}
+
+	private:
+	std::vector<size_t> radices;
+};
+
+namespace detail {
+
+// A mark per state that's cleared for every run by bumping the epoch instead
+// of writing the whole array, only on wrap around it's actually cleared
+struct StateMarks {
+	void reset(size_t state_count) {
+		if (stamps.size() < state_count) {
+			stamps.resize(state_count, 0);
+		}
+		if (++epoch == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0);
+			epoch = 1;
+		}
+	}
+
+	bool marked(uint32_t s) const { return stamps[s] == epoch; }
+	void mark(uint32_t s) { stamps[s] = epoch; }
+
+	private:
+	std::vector<uint32_t> stamps;
+	uint32_t epoch = 0;
+};
+
+} // namespace detail
+
+/* -------------------------------------------------------------------------- */
+/*                                  Traversal                                 */
+/* -------------------------------------------------------------------------- */
+// Every state reachable from the sources, each visited once
+struct Traversal {
+	// in order of distance (in edges), visit(state, depth)
+	template <typename Sources, typename Neighbours, typename Visit>
+	size_t breadth_first(size_t state_count, Sources const& sources, Neighbours const& neighbours, Visit const& visit) {
+		start(state_count, sources);
+		size_t head = 0;
+		for (size_t depth = 0; head < pending.size(); ++depth) {
+			size_t level_end = pending.size();
+			for (; head < level_end; ++head) {
+				uint32_t s = pending[head];
+				visit(s, depth);
+				expand(s, neighbours);
+			}
+		}
+		return pending.size();
+	}
+
+	// deepest first (a stack), visit(state)
+	template <typename Sources, typename Neighbours, typename Visit>
+	size_t depth_first(size_t state_count, Sources const& sources, Neighbours const& neighbours, Visit const& visit) {
+		start(state_count, sources);
+		size_t visited = 0;
+		while (!pending.empty()) {
+			uint32_t s = pending.back();
+			pending.pop_back();
+			++visited;
+			visit(s);
+			expand(s, neighbours);
+		}
+		return visited;
+	}
+
+	// whether the last run reached s
+	bool visited(uint32_t s) const { return seen.marked(s); }
+
+	private:
+	template <typename Sources>
+	void start(size_t state_count, Sources const& sources) {
+		seen.reset(state_count);
+		pending.clear();
+		for (uint32_t s : sources) {
+			if (!seen.marked(s)) {
+				seen.mark(s);
+				pending.push_back(s);
+			}
+		}
+	}
+
+	template <typename Neighbours>
+	void expand(uint32_t s, Neighbours const& neighbours) {
+		neighbours(s, [this](uint32_t next, uint64_t) {
+			if (!seen.marked(next)) {
+				seen.mark(next);
+				pending.push_back(next);
+			}
+		});
+	}
+
+	detail::StateMarks seen;
+	std::vector<uint32_t> pending; // queue (BFS) or stack (DFS)
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                   Queues                                   */
+/* -------------------------------------------------------------------------- */
+// Min priority queues of states for ShortestPaths. The radix heap and the
+// bucket queue are monotone: nothing may be pushed with a lower priority than
+// the last one popped, which Dijkstra (and A* with a consistent heuristic)
+// never does. The bucket queue also bounds how far above it a push may be.
+
+// Any priorities, O(log n) push and pop
+struct BinaryHeapQueue {
+	bool empty(void) const { return heap.empty(); }
+	void clear(void) { heap.clear(); }
+
+	void push(uint64_t priority, uint32_t state) {
+		heap.push_back({priority, state});
+		std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+	}
+
+	std::pair<uint64_t, uint32_t> pop(void) {
+		std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+		Entry top = heap.back();
+		heap.pop_back();
+		return top;
+	}
+
+	private:
+	typedef std::pair<uint64_t, uint32_t> Entry;
+
+	std::vector<Entry> heap;
+};
+
+// Monotone, buckets by the highest bit in which a priority differs from the
+// last pop. Every entry moves down at most 64 times, O(1) push.
+struct RadixHeapQueue {
+	bool empty(void) const { return count == 0; }
+
+	void clear(void) {
+		for (auto& b : buckets) {
+			b.clear();
+		}
+		last = 0;
+		count = 0;
+	}
+
+	void push(uint64_t priority, uint32_t state) {
+		buckets[bucket_of(priority)].push_back({priority, state});
+		++count;
+	}
+
+	std::pair<uint64_t, uint32_t> pop(void) {
+		if (buckets[0].empty()) {
+			size_t i = 1;
+			while (buckets[i].empty()) {
+				++i;
+			}
+			// the lowest of bucket i is the new last, the rest of it spreads
+			// over the buckets below i
+			last = std::min_element(buckets[i].begin(), buckets[i].end())->first;
+			for (auto const& e : buckets[i]) {
+				buckets[bucket_of(e.first)].push_back(e);
+			}
+			buckets[i].clear();
+		}
+		--count;
+		Entry top = buckets[0].back();
+		buckets[0].pop_back();
+		return top;
+	}
+
+	private:
+	typedef std::pair<uint64_t, uint32_t> Entry;
+
+	size_t bucket_of(uint64_t priority) const {
+		return priority == last ? 0 : 64 - __builtin_clzll(priority ^ last);
+	}
+
+	std::vector<Entry> buckets[65];
+	uint64_t last = 0;
+	size_t count = 0;
+};
+
+// Monotone, Dial's ring of buckets: every priority in the queue is at most
+// max_step above the last pop, so a ring of max_step + 1 buckets holds them
+// all. O(1) push, pop walks the ring.
+//
+// For Dijkstra max_step is the highest edge cost. For A* a push is at
+// d + cost + heuristic(next) after a pop at d + heuristic(s), so max_step has
+// to be the highest edge cost plus the most the heuristic can rise over an
+// edge. A push outside of the ring would land in a wrong bucket, it throws.
+struct BucketQueue {
+	explicit BucketQueue(uint64_t max_step = 9) : buckets(max_step + 1) {}
+
+	bool empty(void) const { return count == 0; }
+
+	void clear(void) {
+		for (auto& b : buckets) {
+			b.clear();
+		}
+		cursor = 0;
+		count = 0;
+	}
+
+	void push(uint64_t priority, uint32_t state) {
+		if (priority < cursor || priority - cursor >= buckets.size()) {
+			out_of_ring(priority);
+		}
+		buckets[priority % buckets.size()].push_back(state);
+		++count;
+	}
+
+	std::pair<uint64_t, uint32_t> pop(void) {
+		while (buckets[cursor % buckets.size()].empty()) {
+			++cursor;
+		}
+		auto& bucket = buckets[cursor % buckets.size()];
+		uint32_t state = bucket.back();
+		bucket.pop_back();
+		--count;
+		return {cursor, state};
+	}
+
+	private:
+	// out of line, keeps push small enough to inline
+	__attribute__((noinline, cold)) void out_of_ring(uint64_t priority) const {
+		throw std::runtime_error("BucketQueue: priority " + std::to_string(priority) +
+								 " is outside of the ring (last pop " + std::to_string(cursor) +
+								 ", max_step " + std::to_string(buckets.size() - 1) + ")");
+	}
+
+	std::vector<std::vector<uint32_t>> buckets;
+	uint64_t cursor = 0;
+	size_t count = 0;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                               Shortest paths                               */
+/* -------------------------------------------------------------------------- */
+// Dijkstra and A* with lazy deletion: a state is pushed again whenever its
+// distance improves and stale entries are skipped when they're popped.
+template <typename Queue = BinaryHeapQueue>
+struct ShortestPaths {
+	static uint32_t const NONE = std::numeric_limits<uint32_t>::max();
+
+	explicit ShortestPaths(Queue queue = Queue()) : queue(std::move(queue)) {}
+
+	// Counts every pop into pops and the stale ones also into stale_pops,
+	// for the trace (without AOC_TRACE they count nothing, and cost nothing)
+	void count_pops(Counter& pops, Counter& stale_pops) {
+		pop_counter = &pops;
+		stale_pop_counter = &stale_pops;
+	}
+
+	// From the sources (at distance 0) until a state for which is_goal(state)
+	// holds is settled, that one is returned. NONE if none can be reached.
+	template <typename Sources, typename Neighbours, typename Goal>
+	uint32_t dijkstra(size_t state_count, Sources const& sources, Neighbours const& neighbours, Goal const& is_goal) {
+		return a_star(state_count, sources, neighbours, is_goal, [](uint32_t) { return uint64_t(0); });
+	}
+
+	// Same, in order of distance + heuristic(state). The heuristic must never
+	// overestimate the distance left and be consistent (never drop by more than
+	// the cost of an edge), otherwise the first goal settled isn't the closest.
+	template <typename Sources, typename Neighbours, typename Goal, typename Heuristic>
+	uint32_t a_star(size_t state_count, Sources const& sources, Neighbours const& neighbours, Goal const& is_goal,
+					Heuristic const& heuristic) {
+		start(state_count);
+		for (uint32_t s : sources) {
+			relax(s, 0, heuristic);
+		}
+
+		while (!queue.empty()) {
+			uint32_t s = queue.pop().second;
+			if (pop_counter) {
+				++*pop_counter;
+			}
+			if (done.marked(s)) {
+				if (stale_pop_counter) {
+					++*stale_pop_counter;
+				}
+				continue ; // stale, settled with a lower distance already
+			}
+			done.mark(s);
+			if (is_goal(s)) {
+				return s;
+			}
+			uint64_t d = dist[s];
+			neighbours(s, [this, d, &heuristic](uint32_t next, uint64_t cost) {
+				if (!done.marked(next)) {
+					relax(next, d + cost, heuristic);
+				}
+			});
+		}
+		return NONE;
+	}
+
+	// whether the last run found any path to s (the shortest one if settled)
+	bool reached(uint32_t s) const { return seen.marked(s); }
+	bool settled(uint32_t s) const { return done.marked(s); }
+	// length of the best path found to s, only if reached(s)
+	uint64_t distance(uint32_t s) const { return dist[s]; }
+
+	private:
+	void start(size_t state_count) {
+		if (dist.size() < state_count) {
+			dist.resize(state_count);
+		}
+		seen.reset(state_count);
+		done.reset(state_count);
+		queue.clear();
+	}
+
+	template <typename Heuristic>
+	void relax(uint32_t s, uint64_t d, Heuristic const& heuristic) {
+		if (seen.marked(s) && dist[s] <= d) {
+			return ;
+		}
+		seen.mark(s);
+		dist[s] = d;
+		queue.push(d + heuristic(s), s);
+	}
+
+	std::vector<uint64_t> dist;
+	detail::StateMarks seen; // dist is set
+	detail::StateMarks done; // dist is final
+	Queue queue;
+	Counter* pop_counter = nullptr;
+	Counter* stale_pop_counter = nullptr;
+};
+
+template <typename Queue>
+uint32_t const ShortestPaths<Queue>::NONE;
+
+} // namespace aoc
+
+#endif // SEARCH_H
@@ -0,0 +1,80 @@
+#ifndef SOLUTION_H
+# define SOLUTION_H
+
+# include "view.h"
+
+# include <cstdint>
+# include <functional>
+# include <memory>
+# include <string>
+
+namespace aoc {
+
+struct BinaryWriter;
+struct BinaryReader;
+
+/* -------------------------------------------------------------------------- */
+/*                                  Solution                                  */
+/* -------------------------------------------------------------------------- */
+// A day's solver split up into its phases: parse the input once, then solve
+// both parts from the parsed data. The parsed data is type-erased, so every
+// day fits in the same registry (see registry/ and bench/).
+// Parsed data may point into the input, so the input has to outlive it.
+//
+// Days can also save their parsed data in binary and load it back, to skip
+// parsing unchanged inputs (see with_parse_cache() in parse_cache.h).
+struct Solution {
+	using parsed_t = std::shared_ptr<void const>;
+	using part_t = std::function<std::string(void const*)>;
+
+	int day;
+	std::string name;
+	std::function<parsed_t(StringView)> parse;
+	part_t part1;
+	part_t part2; // empty if the day only has one answer
+
+	// 0 if the parsed data can't be cached, bumped whenever its layout changes
+	uint32_t cache_version = 0;
+	std::function<void(void const*, BinaryWriter&)> save;
+	std::function<parsed_t(BinaryReader&)> load;
+};
+
+namespace detail {
+
+template <typename T>
+std::string to_answer(T const& value) {
+	return std::to_string(value);
+}
+
+template <typename Parsed, typename R>
+Solution::part_t make_part(R (*part)(Parsed const&)) {
+	return [part](void const* parsed) {
+		return to_answer(part(*static_cast<Parsed const*>(parsed)));
+	};
+}
+
+} // namespace detail
+
+template <typename Parsed, typename R1>
+Solution make_solution(int day, std::string name, Parsed (*parse)(StringView), R1 (*part1)(Parsed const&)) {
+	Solution s;
+	s.day = day;
+	s.name = std::move(name);
+	s.parse = [parse](StringView input) -> Solution::parsed_t {
+		return std::make_shared<Parsed>(parse(input));
+	};
+	s.part1 = detail::make_part(part1);
+	return s;
+}
+
+template <typename Parsed, typename R1, typename R2>
+Solution make_solution(int day, std::string name, Parsed (*parse)(StringView),
+	R1 (*part1)(Parsed const&), R2 (*part2)(Parsed const&)) {
+	Solution s = make_solution(day, std::move(name), parse, part1);
+	s.part2 = detail::make_part(part2);
+	return s;
+}
+
+} // namespace aoc
+
+#endif // SOLUTION_H
@@ -0,0 +1,157 @@
+#ifndef THREAD_POOL_H
+# define THREAD_POOL_H
+
+# include <algorithm>
+# include <atomic>
+# include <condition_variable>
+# include <cstddef>
+# include <deque>
+# include <exception>
+# include <functional>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <vector>
+
+namespace aoc {
+
+struct TaskGroup;
+
+/* -------------------------------------------------------------------------- */
+/*                                 Thread Pool                                */
+/* -------------------------------------------------------------------------- */
+// Work stealing pool: every worker has its own deque, it takes its newest task
+// first (still warm in cache) and when it runs out it steals the oldest task of
+// another worker (the biggest piece of work, for split up ranges).
+// Tasks submitted by a worker go to its own deque, the ones submitted from
+// outside are spread round robin.
+//
+// Tasks must not throw, catch inside of the task and store the error instead
+// (or use a TaskGroup, which does that).
+struct ThreadPool {
+	explicit ThreadPool(size_t threads = default_thread_count());
+	// waits for every submitted task before joining the workers
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	// group is the TaskGroup the task belongs to, if any
+	void submit(std::function<void()> task, TaskGroup const* group = nullptr);
+	// block until every submitted task has finished, not from inside a task
+	void wait(void);
+	// run one queued task (of group only, if given) on the calling thread,
+	// false if there was none
+	bool run_pending_task(TaskGroup const* group = nullptr);
+
+	size_t size(void) const { return workers.size(); }
+
+	// $AOC_THREADS if set, otherwise std::thread::hardware_concurrency()
+	// (or 1 if that is unknown)
+	static size_t default_thread_count(void);
+
+	// Pool shared by everything in the process (the runner and the parallel
+	// parts of the days), created on first use with default_thread_count().
+	static ThreadPool& global(void);
+	// replace the global pool, not while it is in use
+	static void set_global_threads(size_t threads);
+
+	private:
+	struct Task {
+		std::function<void()> fn;
+		TaskGroup const* group;
+	};
+
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void work(size_t index);
+	bool pop(std::function<void()>& task, TaskGroup const* group);
+	void run(std::function<void()>& task);
+
+	std::vector<std::unique_ptr<Queue>> queues; // one per worker
+	std::vector<std::thread> workers;
+	std::mutex mutex; // for sleeping and waking up, guards pending
+	std::condition_variable task_added;
+	std::condition_variable tasks_done;
+	std::atomic<size_t> queued; // in one of the queues
+	std::atomic<size_t> next_queue; // round robin for tasks from outside
+	size_t pending; // queued + running
+	bool stopping;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                 Task Group                                 */
+/* -------------------------------------------------------------------------- */
+// Tasks that belong together, for recursive task trees: a task can spawn more
+// tasks into its group and wait() on a group from inside a task is fine, the
+// waiting thread runs queued tasks of the group until they're all done. Only
+// its own, so a day waiting on its parallel part doesn't run (and get timed
+// with) another day. While the rest of them run on other threads it sleeps.
+//
+//     TaskGroup group;
+//     group.spawn([&]() { left = count(tree.left); });
+//     right = count(tree.right);
+//     group.wait();
+struct TaskGroup {
+	explicit TaskGroup(ThreadPool& pool = ThreadPool::global()) : pool(pool), pending(0), spawned(0) {}
+	// waits, but drops the exception (wait() before to get it)
+	~TaskGroup();
+
+	TaskGroup(TaskGroup const&) = delete;
+	TaskGroup& operator=(TaskGroup const&) = delete;
+
+	void spawn(std::function<void()> task);
+	// until every spawned task is done, rethrows the first exception of one
+	void wait(void);
+
+	private:
+	void help_until_done(void);
+
+	ThreadPool& pool;
+	size_t pending; // spawned and not done yet
+	size_t spawned; // ever, a change wakes the waiter to help with it
+	std::mutex mutex; // guards the above and error
+	std::condition_variable changed; // spawned, or the last task is done
+	std::exception_ptr error;
+};
+
+namespace detail {
+
+template <typename F>
+void split_range(TaskGroup& group, size_t begin, size_t end, size_t grain, F const& fn) {
+	// hand off the upper half until the rest is small enough, thieves take
+	// the oldest (so the biggest) halves first
+	while (end - begin > grain) {
+		size_t mid = begin + (end - begin) / 2;
+		group.spawn([&group, mid, end, grain, &fn]() {
+			split_range(group, mid, end, grain, fn);
+		});
+		end = mid;
+	}
+	fn(begin, end);
+}
+
+} // namespace detail
+
+// fn(range_begin, range_end) for pieces of [begin, end) of at most grain
+// indices. grain 0 picks one so every thread gets about 8 pieces, which leaves
+// enough to steal when some indices take longer than others.
+template <typename F>
+void parallel_for(size_t begin, size_t end, F const& fn, size_t grain = 0, ThreadPool& pool = ThreadPool::global()) {
+	if (begin >= end) {
+		return ;
+	}
+	if (grain == 0) {
+		grain = std::max<size_t>(1, (end - begin) / (8 * pool.size()));
+	}
+	TaskGroup group(pool);
+	detail::split_range(group, begin, end, grain, fn);
+	group.wait();
+}
+
+} // namespace aoc
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,107 @@
+#ifndef TRACE_H
+# define TRACE_H
+
+# include <cstdint>
+
+# ifdef AOC_MEMORY
+#  include "memory.h"
+# endif
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                   Tracing                                  */
+/* -------------------------------------------------------------------------- */
+// Instrumentation for hot paths, only when built with AOC_TRACE (cmake
+// -DAOC_TRACE=ON). Without it ScopedTimer and Counter are empty and every
+// use of them compiles to nothing.
+//
+// With it every thread records into its own buffer (no locking after the
+// first event of a thread). At exit all of it is written as Chrome trace_event
+// JSON to $AOC_TRACE_FILE (default aoc_trace.json), open it in
+// chrome://tracing or https://ui.perfetto.dev.
+//
+//     ScopedTimer timer("day17 part1"); // one slice from here to end of scope
+//     Counter pops("day17 pops");       // ++pops, the total is recorded at end of scope
+//
+// Names are not copied, they have to outlive the program (string literals).
+//
+// With AOC_MEMORY (cmake -DAOC_MEMORY=ON) a ScopedTimer is also the memory
+// phase its allocations are counted under (include/memory.h), traced or not.
+
+# ifdef AOC_MEMORY
+using ScopedPhase = memory::ScopedPhase;
+# else
+struct ScopedPhase {
+	explicit ScopedPhase(char const*) {}
+};
+# endif
+
+# ifdef AOC_TRACE
+
+namespace trace {
+
+// nanoseconds since the first use of tracing
+uint64_t now(void);
+void record_slice(char const* name, uint64_t begin_ns, uint64_t end_ns);
+void record_counter(char const* name, int64_t value);
+
+} // namespace trace
+
+struct ScopedTimer {
+	explicit ScopedTimer(char const* name) : phase(name), name(name), begin(trace::now()) {}
+
+	~ScopedTimer() {
+		trace::record_slice(name, begin, trace::now());
+	}
+
+	ScopedTimer(ScopedTimer const&) = delete;
+	ScopedTimer& operator=(ScopedTimer const&) = delete;
+
+	private:
+	ScopedPhase phase;
+	char const* name;
+	uint64_t begin;
+};
+
+struct Counter {
+	explicit Counter(char const* name) : name(name), count(0) {}
+
+	~Counter() {
+		trace::record_counter(name, count);
+	}
+
+	Counter(Counter const&) = delete;
+	Counter& operator=(Counter const&) = delete;
+
+	Counter& operator++() { ++count; return *this; }
+	Counter& operator+=(int64_t n) { count += n; return *this; }
+	int64_t value(void) const { return count; }
+
+	private:
+	char const* name;
+	int64_t count;
+};
+
+# else
+
+struct ScopedTimer {
+	explicit ScopedTimer(char const* name) : phase(name) {}
+
+	private:
+	ScopedPhase phase;
+};
+
+struct Counter {
+	explicit Counter(char const*) {}
+
+	Counter& operator++() { return *this; }
+	Counter& operator+=(int64_t) { return *this; }
+	int64_t value(void) const { return 0; }
+};
+
+# endif // AOC_TRACE
+
+} // namespace aoc
+
+#endif // TRACE_H
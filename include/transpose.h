@@ -0,0 +1,163 @@
+#ifndef TRANSPOSE_H
+# define TRANSPOSE_H
+
+# include "grid.h"
+
+# include <algorithm>
+# include <cstdint>
+# include <cstring>
+# include <type_traits>
+
+# ifdef __SSE2__
+#  include <emmintrin.h>
+# endif
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                  Transpose                                 */
+/* -------------------------------------------------------------------------- */
+// Walking a column of a row-major grid touches a new cache line on every step.
+// For algorithms that scan whole columns it's cheaper to transpose the grid
+// once and scan the rows of the copy, as long as the grid is big enough to
+// not fit in L1 anyway (bench/grid_bench.cpp shows where that starts).
+//
+// The transpose goes tile by tile so both sides of a tile stay in cache, and
+// byte cells (the char grids of the days) move 16x16 at a time with SSE2.
+
+namespace detail {
+
+// cells per side of a tile, a tile of each side fits in L1 together
+static int64_t const TRANSPOSE_TILE = 64;
+
+template <typename T>
+void transpose_tile(T const* src, int64_t src_stride, T* dst, int64_t dst_stride, int64_t width, int64_t height) {
+	for (int64_t y = 0; y < height; ++y) {
+		for (int64_t x = 0; x < width; ++x) {
+			dst[x * dst_stride + y] = src[y * src_stride + x];
+		}
+	}
+}
+
+# ifdef __SSE2__
+
+// 16 rows of 16 bytes, four rounds of interleaving: bytes, pairs, quads and
+// then halves of the registers
+inline void transpose_16x16(unsigned char const* src, int64_t src_stride, unsigned char* dst, int64_t dst_stride) {
+	__m128i r[16], a[16], b[16];
+	for (int i = 0; i < 16; ++i) {
+		r[i] = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i * src_stride));
+	}
+	// a[i]: rows 2i and 2i + 1, columns 0-7 (a[i + 8]: 8-15) as byte pairs
+	for (int i = 0; i < 8; ++i) {
+		a[i] = _mm_unpacklo_epi8(r[2 * i], r[2 * i + 1]);
+		a[i + 8] = _mm_unpackhi_epi8(r[2 * i], r[2 * i + 1]);
+	}
+	// b[4g + i]: rows 4i to 4i + 3 of columns 4g to 4g + 3
+	for (int i = 0; i < 4; ++i) {
+		b[i] = _mm_unpacklo_epi16(a[2 * i], a[2 * i + 1]);
+		b[4 + i] = _mm_unpackhi_epi16(a[2 * i], a[2 * i + 1]);
+		b[8 + i] = _mm_unpacklo_epi16(a[8 + 2 * i], a[8 + 2 * i + 1]);
+		b[12 + i] = _mm_unpackhi_epi16(a[8 + 2 * i], a[8 + 2 * i + 1]);
+	}
+	for (int g = 0; g < 4; ++g) {
+		// rows 0-7 (and 8-15) of columns 4g, 4g + 1 (lo) and 4g + 2, 4g + 3 (hi)
+		__m128i lo_top = _mm_unpacklo_epi32(b[4 * g], b[4 * g + 1]);
+		__m128i hi_top = _mm_unpackhi_epi32(b[4 * g], b[4 * g + 1]);
+		__m128i lo_bottom = _mm_unpacklo_epi32(b[4 * g + 2], b[4 * g + 3]);
+		__m128i hi_bottom = _mm_unpackhi_epi32(b[4 * g + 2], b[4 * g + 3]);
+		unsigned char* column = dst + 4 * g * dst_stride;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(column), _mm_unpacklo_epi64(lo_top, lo_bottom));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(column + dst_stride), _mm_unpackhi_epi64(lo_top, lo_bottom));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(column + 2 * dst_stride), _mm_unpacklo_epi64(hi_top, hi_bottom));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(column + 3 * dst_stride), _mm_unpackhi_epi64(hi_top, hi_bottom));
+	}
+}
+
+inline void transpose_tile(unsigned char const* src, int64_t src_stride, unsigned char* dst, int64_t dst_stride,
+						   int64_t width, int64_t height) {
+	int64_t full_width = width - width % 16;
+	int64_t full_height = height - height % 16;
+	for (int64_t y = 0; y < full_height; y += 16) {
+		for (int64_t x = 0; x < full_width; x += 16) {
+			transpose_16x16(src + y * src_stride + x, src_stride, dst + x * dst_stride + y, dst_stride);
+		}
+	}
+	// the strips along the right and bottom edges that don't fill 16x16
+	transpose_tile<unsigned char>(src + full_width, src_stride, dst + full_width * dst_stride, dst_stride,
+								  width - full_width, height);
+	transpose_tile<unsigned char>(src + full_height * src_stride, src_stride, dst + full_height, dst_stride,
+								  full_width, height - full_height);
+}
+
+# endif // __SSE2__
+
+template <typename T>
+void transpose(T const* src, int64_t src_stride, T* dst, int64_t dst_stride, int64_t width, int64_t height) {
+	for (int64_t y = 0; y < height; y += TRANSPOSE_TILE) {
+		for (int64_t x = 0; x < width; x += TRANSPOSE_TILE) {
+			transpose_tile(src + y * src_stride + x, src_stride, dst + x * dst_stride + y, dst_stride,
+						   std::min(TRANSPOSE_TILE, width - x), std::min(TRANSPOSE_TILE, height - y));
+		}
+	}
+}
+
+} // namespace detail
+
+// dst[x * dst_stride + y] = src[y * src_stride + x] for every cell of a
+// width x height block, dst must not overlap src
+template <typename T>
+void transpose(T const* src, int64_t src_stride, T* dst, int64_t dst_stride, int64_t width, int64_t height) {
+	// byte cells (char grids) go through the SIMD tiles
+	typedef typename std::conditional<sizeof(T) == 1 && std::is_trivially_copyable<T>::value,
+		unsigned char, T>::type cell_t;
+	detail::transpose(reinterpret_cast<cell_t const*>(src), src_stride, reinterpret_cast<cell_t*>(dst), dst_stride,
+					  width, height);
+}
+
+// grid with x and y swapped (border included) into out, reusing its buffer
+// when it already has the right shape
+template <typename T>
+void transpose(Grid<T> const& grid, Grid<T>& out) {
+	if (out.width() != grid.height() || out.height() != grid.width() || out.border() != grid.border()) {
+		out = Grid<T>(grid.height(), grid.width(), T(), grid.border(), T());
+	}
+	int64_t b = grid.border();
+	transpose(grid.data(), grid.stride(), out.data(), out.stride(), grid.width() + 2 * b, grid.height() + 2 * b);
+}
+
+template <typename T>
+Grid<T> transpose(Grid<T> const& grid) {
+	Grid<T> out;
+	transpose(grid, out);
+	return out;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Columns                                  */
+/* -------------------------------------------------------------------------- */
+// The columns of a grid as contiguous spans, out of a transposed copy made
+// once up front. Same interface as the rows of a Grid: column(x)[y].
+template <typename T>
+struct Columns {
+	using column_t = typename Grid<T>::const_row_t;
+
+	explicit Columns(Grid<T> const& grid) : transposed(transpose(grid)) {}
+
+	int64_t count(void) const { return transposed.height(); }
+	// length of every column
+	int64_t length(void) const { return transposed.width(); }
+
+	column_t column(int64_t x) const { return transposed.row(x); }
+	column_t operator[](int64_t x) const { return transposed.row(x); }
+
+	// with the columns as rows
+	Grid<T> const& grid(void) const { return transposed; }
+
+	private:
+	Grid<T> transposed;
+};
+
+} // namespace aoc
+
+#endif // TRANSPOSE_H
@@ -2,8 +2,11 @@
 # define VEC2_H
 
 #include <cmath>
+#include <cstdint>
 #include <string>
 
+#include "hash.h"
+
 template <typename T>
 struct Vector2D {
 	using value_t = T;
@@ -114,6 +117,17 @@ struct Vector2D {
 		return ("(" + std::to_string(x) + ',' + std::to_string(y) + ')');
 	}
 
+	// Both coordinates in one 64 bit key (y in the high half), for hashing and
+	// for keys of flat tables. Exact as long as they fit in 32 bits, which
+	// every grid does, unpack(pack()) gives back the same vector.
+	uint64_t pack(void) const {
+		return (uint64_t(uint32_t(y)) << 32) | uint32_t(x);
+	}
+
+	static Vector2D unpack(uint64_t key) {
+		return {value_t(int32_t(uint32_t(key))), value_t(int32_t(uint32_t(key >> 32)))};
+	}
+
 	static Vector2D right(void) {
 		return {1, 0};
 	}
@@ -137,8 +151,7 @@ using Vec2 = Vector2D<int64_t>;
 template <>
 struct std::hash<Vec2> {
 	size_t operator()(Vec2 const& v) const {
-		size_t seed = std::hash<int64_t>()(v.x);
-		return std::hash<int64_t>()(v.y) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		return size_t(aoc::mix64(v.pack()));
 	}
 };
 
@@ -0,0 +1,164 @@
+#ifndef VIEW_H
+# define VIEW_H
+
+# include <algorithm>
+# include <cstring>
+# include <string>
+# include <ostream>
+# include <functional>
+
+namespace aoc {
+
+/* -------------------------------------------------------------------------- */
+/*                                 String View                                */
+/* -------------------------------------------------------------------------- */
+// Non-owning view into a character buffer (pointer plus length).
+// Basically a stripped down std::string_view, which we don't have in C++11.
+struct StringView {
+	using size_type = size_t;
+	using const_iterator = char const*;
+	using iterator = const_iterator;
+
+	static size_type const npos = size_type(-1);
+
+	StringView() : ptr(nullptr), len(0) {}
+	StringView(char const* ptr, size_type len) : ptr(ptr), len(len) {}
+	StringView(char const* begin, char const* end) : ptr(begin), len(end - begin) {}
+	StringView(char const* cstr) : ptr(cstr), len(std::strlen(cstr)) {}
+	StringView(std::string const& str) : ptr(str.data()), len(str.length()) {}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Accessors                                 */
+/* -------------------------------------------------------------------------- */
+
+	char const* data(void) const { return ptr; }
+	size_type size(void) const { return len; }
+	size_type length(void) const { return len; }
+	bool empty(void) const { return len == 0; }
+
+	const_iterator begin(void) const { return ptr; }
+	const_iterator end(void) const { return ptr + len; }
+
+	char operator[](size_type i) const { return ptr[i]; }
+	char front(void) const { return ptr[0]; }
+	char back(void) const { return ptr[len - 1]; }
+
+	std::string str(void) const {
+		return std::string(ptr, len);
+	}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Modifiers                                 */
+/* -------------------------------------------------------------------------- */
+
+	void remove_prefix(size_type n) {
+		ptr += n;
+		len -= n;
+	}
+
+	void remove_suffix(size_type n) {
+		len -= n;
+	}
+
+	StringView substr(size_type pos, size_type n = npos) const {
+		pos = std::min(pos, len);
+		return StringView(ptr + pos, std::min(n, len - pos));
+	}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Searching                                 */
+/* -------------------------------------------------------------------------- */
+
+	size_type find(char c, size_type pos = 0) const {
+		if (pos >= len) {
+			return npos;
+		}
+		void const* found = std::memchr(ptr + pos, c, len - pos);
+		return found ? static_cast<char const*>(found) - ptr : npos;
+	}
+
+	size_type find(StringView needle, size_type pos = 0) const {
+		if (needle.len > len) {
+			return npos;
+		}
+		for (size_type i = pos; i + needle.len <= len; ++i) {
+			if (std::memcmp(ptr + i, needle.ptr, needle.len) == 0) {
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	size_type rfind(char c) const {
+		for (size_type i = len; i > 0; --i) {
+			if (ptr[i - 1] == c) {
+				return i - 1;
+			}
+		}
+		return npos;
+	}
+
+	size_type rfind(StringView needle) const {
+		if (needle.len > len) {
+			return npos;
+		}
+		for (size_type i = len - needle.len + 1; i > 0; --i) {
+			if (std::memcmp(ptr + i - 1, needle.ptr, needle.len) == 0) {
+				return i - 1;
+			}
+		}
+		return npos;
+	}
+
+	bool starts_with(StringView prefix) const {
+		return (len >= prefix.len && std::memcmp(ptr, prefix.ptr, prefix.len) == 0);
+	}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Comparison                                 */
+/* -------------------------------------------------------------------------- */
+
+	int compare(StringView const& rhs) const {
+		int c = std::memcmp(ptr, rhs.ptr, std::min(len, rhs.len));
+		if (c != 0) {
+			return c;
+		}
+		return (len < rhs.len) ? -1 : (len > rhs.len);
+	}
+
+	bool operator==(StringView const& rhs) const {
+		return (len == rhs.len && std::memcmp(ptr, rhs.ptr, len) == 0);
+	}
+
+	bool operator!=(StringView const& rhs) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<(StringView const& rhs) const {
+		return compare(rhs) < 0;
+	}
+
+	private:
+	char const* ptr;
+	size_type len;
+};
+
+inline std::ostream& operator<<(std::ostream& out, StringView const& view) {
+	return out.write(view.data(), view.size());
+}
+
+} // namespace aoc
+
+// FNV-1a, so views can be used as keys in unordered containers
+template <>
+struct std::hash<aoc::StringView> {
+	size_t operator()(aoc::StringView const& view) const {
+		uint64_t h = 0xcbf29ce484222325;
+		for (char c : view) {
+			h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+		}
+		return h;
+	}
+};
+
+#endif // VIEW_H
@@ -0,0 +1,105 @@
+#include "registry.h"
+#include "scanner.h"
+
+#include <chrono>
+#include <sstream>
+
+// Each day exposes its solution in its own namespace (see add_day in the root CMakeLists.txt)
+namespace day01 { aoc::Solution solution(); }
+namespace day02 { aoc::Solution solution(); }
+namespace day03 { aoc::Solution solution(); }
+namespace day04 { aoc::Solution solution(); }
+namespace day05 { aoc::Solution solution(); }
+namespace day06 { aoc::Solution solution(); }
+namespace day07 { aoc::Solution solution(); }
+namespace day08 { aoc::Solution solution(); }
+namespace day09 { aoc::Solution solution(); }
+namespace day10 { aoc::Solution solution(); }
+namespace day11 { aoc::Solution solution(); }
+namespace day12 { aoc::Solution solution(); }
+namespace day13 { aoc::Solution solution(); }
+namespace day14 { aoc::Solution solution(); }
+namespace day15 { aoc::Solution solution(); }
+namespace day16 { aoc::Solution solution(); }
+namespace day17 { aoc::Solution solution(); }
+namespace day18 { aoc::Solution solution(); }
+namespace day19 { aoc::Solution solution(); }
+namespace day20 { aoc::Solution solution(); }
+
+namespace aoc {
+
+std::vector<Solution> const& solutions(void) {
+	static std::vector<Solution> const SOLUTIONS {
+		day01::solution(),
+		day02::solution(),
+		day03::solution(),
+		day04::solution(),
+		day05::solution(),
+		day06::solution(),
+		day07::solution(),
+		day08::solution(),
+		day09::solution(),
+		day10::solution(),
+		day11::solution(),
+		day12::solution(),
+		day13::solution(),
+		day14::solution(),
+		day15::solution(),
+		day16::solution(),
+		day17::solution(),
+		day18::solution(),
+		day19::solution(),
+		day20::solution(),
+	};
+	return SOLUTIONS;
+}
+
+Solution const* find_solution(int day) {
+	for (auto const& s : solutions()) {
+		if (s.day == day) {
+			return &s;
+		}
+	}
+	return nullptr;
+}
+
+Run run_solution(Solution const& solution, StringView input, ParseCache const& cache) {
+	using clock = std::chrono::steady_clock;
+	auto elapsed_ns = [](clock::time_point start, clock::time_point end) {
+		return std::chrono::duration<double, std::nano>(end - start).count();
+	};
+
+	Run run;
+	auto start = clock::now();
+	Solution::parsed_t parsed = cache.parse(solution, input, &run.cached);
+	auto parsed_at = clock::now();
+	run.part1 = solution.part1(parsed.get());
+	auto part1_at = clock::now();
+	if (solution.part2) {
+		run.part2 = solution.part2(parsed.get());
+	}
+	auto part2_at = clock::now();
+
+	run.parse_ns = elapsed_ns(start, parsed_at);
+	run.part1_ns = elapsed_ns(parsed_at, part1_at);
+	run.part2_ns = elapsed_ns(part1_at, part2_at);
+	return run;
+}
+
+std::set<int> parse_day_list(StringView list) {
+	std::set<int> days;
+	Scanner sc(list);
+	int day;
+	while (sc.next_int(day)) {
+		days.insert(day);
+	}
+	return days;
+}
+
+std::string input_path(std::string const& dir, int day) {
+	std::ostringstream ss;
+	ss << dir << "/day" << (day < 10 ? "0" : "") << day << ".txt";
+	return ss.str();
+}
+
+} // namespace aoc
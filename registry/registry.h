@@ -0,0 +1,42 @@
+#ifndef REGISTRY_H
+# define REGISTRY_H
+
+# include "solution.h"
+# include "parse_cache.h"
+
+# include <set>
+# include <string>
+# include <vector>
+
+namespace aoc {
+
+// Every day's solution, ordered by day
+std::vector<Solution> const& solutions(void);
+
+// Solution of a specific day or nullptr if there is none
+Solution const* find_solution(int day);
+
+// Answers of one full run of a solution with the time of each phase
+struct Run {
+	std::string part1;
+	std::string part2; // empty if the day only has one answer
+	double parse_ns; // or the time it took to load it from the cache
+	bool cached;     // whether the parsed input came out of the cache
+	double part1_ns;
+	double part2_ns;
+};
+
+// Parse input and solve both parts. Solutions keep no global state, so this
+// is safe to call for different days (or the same day) on multiple threads.
+// The parsed input comes out of cache if it has it (and goes in if not).
+Run run_solution(Solution const& solution, StringView input, ParseCache const& cache = ParseCache());
+
+// "1,5,17" -> {1, 5, 17}
+std::set<int> parse_day_list(StringView list);
+
+// where the input of day is expected: dir/dayNN.txt
+std::string input_path(std::string const& dir, int day);
+
+} // namespace aoc
+
+#endif // REGISTRY_H
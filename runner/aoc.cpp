@@ -0,0 +1,174 @@
+#include "common.h"
+#include "registry.h"
+#include "memory.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <iomanip>
+#include <set>
+#include <vector>
+
+using namespace aoc;
+
+static char const* const USAGE =
+	"usage: aoc [options] INPUT_DIR\n"
+	"       aoc [options] INPUT_DIR... | --manifest FILE\n"
+	"  Solves every day on INPUT_DIR/dayNN.txt, the days run concurrently\n"
+	"  With more than one INPUT_DIR, or a manifest of \"DAY PATH\" lines, solves\n"
+	"  them all and prints a line per input: DAY PATH PART1 PART2 MS\n"
+	"options:\n"
+	"  --threads N    number of worker threads, for the days and the parallel parts\n"
+	"                 of them (default: $AOC_THREADS or the number of cores)\n"
+	"  --days LIST    only these days, e.g. 1,5,17\n"
+	"  --cache DIR    keep parsed inputs in DIR and load them from there when the\n"
+	"                 input didn't change (default: $AOC_CACHE_DIR, off if unset)\n";
+
+struct Arguments {
+	size_t threads = ThreadPool::default_thread_count();
+	std::set<int> days;
+	ParseCache cache = ParseCache::from_env();
+	std::vector<std::string> input_dirs;
+	std::string manifest;
+};
+
+static Arguments parse_arguments(int argc, char** argv) {
+	Arguments args;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (arg == "--threads" && has_value) {
+			args.threads = std::max(1ul, std::stoul(argv[++i]));
+		} else if (arg == "--days" && has_value) {
+			args.days = parse_day_list(argv[++i]);
+		} else if (arg == "--cache" && has_value) {
+			args.cache = ParseCache(argv[++i]);
+		} else if (arg == "--manifest" && has_value) {
+			args.manifest = argv[++i];
+		} else if (arg[0] != '-') {
+			args.input_dirs.push_back(arg);
+		} else {
+			throw std::runtime_error(std::string("bad argument \"") + arg + "\"\n" + USAGE);
+		}
+	}
+	if (args.input_dirs.empty() == args.manifest.empty()) {
+		throw std::runtime_error(USAGE);
+	}
+	return args;
+}
+
+// Outcome of one day, filled in by whichever worker ran it
+struct DayResult {
+	Solution const* solution;
+	Run run;
+	std::string error; // empty on success
+};
+
+static void print_ms(std::ostream& out, double ns) {
+	out << std::fixed << std::setprecision(3) << std::setw(10) << ns * 1e-6 << " ms";
+}
+
+// Every input of the manifest, or of every INPUT_DIR, one line each
+static int batch(Arguments const& args) {
+	std::vector<BatchItem> items;
+	if (!args.manifest.empty()) {
+		items = read_manifest(args.manifest);
+	}
+	for (auto const& dir : args.input_dirs) {
+		for (auto const& solution : solutions()) {
+			std::string path = input_path(dir, solution.day);
+			// days without an input are skipped
+			if ((args.days.empty() || args.days.count(solution.day) != 0) && std::ifstream(path).good()) {
+				items.push_back({solution.day, path});
+			}
+		}
+	}
+
+	ThreadPool::set_global_threads(args.threads);
+	std::vector<BatchResult> results = run_batch(items, find_solution, args.cache);
+	print_batch(std::cout, items, results, true);
+
+	for (auto const& r : results) {
+		if (!r.error.empty()) {
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv) {
+	using clock = std::chrono::steady_clock;
+
+	Arguments args;
+	try {
+		args = parse_arguments(argc, argv);
+	} catch (std::exception const& e) {
+		std::cerr << e.what();
+		return EXIT_FAILURE;
+	}
+	if (!args.manifest.empty() || args.input_dirs.size() > 1) {
+		return batch(args);
+	}
+
+	// Every day gets its own slot, so the workers never share anything
+	std::vector<DayResult> results;
+	for (auto const& solution : solutions()) {
+		if (args.days.empty() || args.days.count(solution.day) != 0) {
+			results.push_back({&solution, Run(), ""});
+		}
+	}
+
+	// The days share the pool with their own parallel parts
+	ThreadPool::set_global_threads(args.threads);
+	ThreadPool& pool = ThreadPool::global();
+
+	auto start = clock::now();
+	for (auto& result : results) {
+		DayResult* r = &result;
+		std::string path = input_path(args.input_dirs[0], r->solution->day);
+		ParseCache const* cache = &args.cache;
+		pool.submit([r, path, cache]() {
+			try {
+				Input input = Input::from_file(path);
+				r->run = run_solution(*r->solution, input.view(), *cache);
+			} catch (std::exception const& e) {
+				r->error = e.what();
+			}
+		});
+	}
+	pool.wait();
+	double wall_ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+	// Print in day order, no matter in which order they finished
+	bool failed = false;
+	double sum_ns = 0;
+	std::cout << std::left << std::setw(6) << "day" << std::setw(14) << "name"
+		<< std::setw(20) << "part1" << std::setw(20) << "part2" << std::right << std::setw(13) << "time" << '\n';
+	for (auto const& r : results) {
+		std::cout << std::left << std::setw(6) << r.solution->day << std::setw(14) << r.solution->name;
+		if (!r.error.empty()) {
+			failed = true;
+			std::cout << "error: " << r.error << '\n';
+			continue;
+		}
+		double day_ns = r.run.parse_ns + r.run.part1_ns + r.run.part2_ns;
+		sum_ns += day_ns;
+		std::cout << std::setw(20) << r.run.part1 << std::setw(20) << r.run.part2 << std::right;
+		print_ms(std::cout, day_ns);
+		if (r.run.cached) {
+			std::cout << "  (parsed input from the cache)";
+		}
+		std::cout << '\n';
+	}
+
+	std::cout << "\nwall time ";
+	print_ms(std::cout, wall_ns);
+	std::cout << " (sum of days ";
+	print_ms(std::cout, sum_ns);
+	std::cout << ", " << args.threads << " thread(s))\n";
+	// the days run at the same time, only the process as a whole has a peak
+	if (memory::hooked()) {
+		std::cout << "peak rss of the process " << memory::peak_rss_kb() << " kB\n";
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,455 @@
+#include "common.h"
+#include "registry.h"
+#include "parse_cache.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace aoc;
+
+static char const* const USAGE =
+	"usage: aocd [options]\n"
+	"  Solves days on request, one process for many inputs. Requests come from\n"
+	"  stdin (answers go to stdout) or from the clients of a Unix domain socket.\n"
+	"options:\n"
+	"  --socket PATH  listen on PATH instead of stdin\n"
+	"  --threads N    worker threads for the parallel parts of the days\n"
+	"                 (default: $AOC_THREADS or the number of cores)\n"
+	"  --memo N       parsed inputs kept for requests with the same input (default 64)\n"
+	"protocol (one request after the other on a connection):\n"
+	"  SOLVE DAY SIZE\\n then SIZE bytes of input\n"
+	"        -> OK DAY PART1 PART2 PARSE_NS PART1_NS PART2_NS LATENCY_NS [memo]\\n\n"
+	"        (PART2 is - for days without one)\n"
+	"  STATS\\n -> STATS requests=N errors=N p50_us=.. p99_us=.. max_us=.. per_sec=..\\n\n"
+	"  QUIT\\n  -> closes the connection (stops the daemon in stdin mode)\n"
+	"  SHUTDOWN\\n -> stops the daemon\n"
+	"  anything that fails -> ERR message\\n\n";
+
+struct Arguments {
+	std::string socket_path;
+	size_t threads = ThreadPool::default_thread_count();
+	size_t memo_size = 64;
+};
+
+static Arguments parse_arguments(int argc, char** argv) {
+	Arguments args;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (arg == "--socket" && has_value) {
+			args.socket_path = argv[++i];
+		} else if (arg == "--threads" && has_value) {
+			args.threads = std::max(1ul, std::stoul(argv[++i]));
+		} else if (arg == "--memo" && has_value) {
+			args.memo_size = std::stoul(argv[++i]);
+		} else {
+			throw std::runtime_error(std::string("bad argument \"") + arg + "\"\n" + USAGE);
+		}
+	}
+	return args;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Warm state                                 */
+/* -------------------------------------------------------------------------- */
+// Everything that outlives a request: the registry (built once, with all the
+// static tables of the days), the thread pool and the scratch arenas of its
+// threads, and the parsed inputs of the last requests. Tooling tends to send
+// the same input again, those skip parsing.
+
+struct Memo {
+	explicit Memo(size_t capacity) : capacity(capacity) {}
+
+	struct Entry {
+		std::shared_ptr<std::string> input; // parsed data may point into it
+		Solution::parsed_t parsed;
+	};
+
+	// nullptr parsed if it isn't there
+	Entry find(int day, std::string const& input, uint64_t hash) {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = entries.find(Key(day, hash));
+		if (it != entries.end() && *it->second.input == input) {
+			return it->second;
+		}
+		return Entry();
+	}
+
+	void insert(int day, uint64_t hash, Entry entry) {
+		if (capacity == 0) {
+			return ;
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		Key key(day, hash);
+		if (entries.count(key) == 0) {
+			order.push_back(key);
+		}
+		entries[key] = std::move(entry);
+		// oldest first
+		while (order.size() > capacity) {
+			entries.erase(order.front());
+			order.pop_front();
+		}
+	}
+
+	private:
+	typedef std::pair<int, uint64_t> Key;
+
+	size_t capacity;
+	std::mutex mutex;
+	std::map<Key, Entry> entries;
+	std::deque<Key> order;
+};
+
+struct Stats {
+	Stats() : start(std::chrono::steady_clock::now()) {}
+
+	void record(double latency_ns, bool failed) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (failed) {
+			++errors;
+		} else {
+			latencies_ns.push_back(latency_ns);
+		}
+	}
+
+	std::string summary(void) {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<double> sorted(latencies_ns);
+		std::sort(sorted.begin(), sorted.end());
+		auto percentile = [&](double p) {
+			return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, size_t(p * sorted.size()))];
+		};
+		double uptime_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::ostringstream ss;
+		ss << std::fixed << std::setprecision(1)
+			<< "requests=" << sorted.size() + errors << " errors=" << errors
+			<< " p50_us=" << percentile(0.50) * 1e-3
+			<< " p99_us=" << percentile(0.99) * 1e-3
+			<< " max_us=" << (sorted.empty() ? 0 : sorted.back() * 1e-3)
+			<< " per_sec=" << (uptime_s > 0 ? sorted.size() / uptime_s : 0);
+		return ss.str();
+	}
+
+	private:
+	std::chrono::steady_clock::time_point start;
+	std::mutex mutex;
+	std::vector<double> latencies_ns;
+	size_t errors = 0;
+};
+
+struct Daemon {
+	explicit Daemon(Arguments const& args) : memo(args.memo_size), stopping(false) {}
+
+	Memo memo;
+	Stats stats;
+	std::atomic<bool> stopping;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  Requests                                  */
+/* -------------------------------------------------------------------------- */
+
+// Buffered reads off a file descriptor, for the request lines and bodies
+struct FdReader {
+	explicit FdReader(int fd) : fd(fd), begin(0), end(0) {}
+
+	// false at the end of the stream
+	bool read_line(std::string& line) {
+		line.clear();
+		for (;;) {
+			char const* nl = static_cast<char const*>(std::memchr(buffer + begin, '\n', end - begin));
+			if (nl != nullptr) {
+				line.append(buffer + begin, nl - (buffer + begin));
+				begin = nl - buffer + 1;
+				return true;
+			}
+			line.append(buffer + begin, end - begin);
+			if (!fill()) {
+				return !line.empty();
+			}
+		}
+	}
+
+	bool read_exact(std::string& out, size_t n) {
+		out.clear();
+		out.reserve(n);
+		while (out.size() < n) {
+			if (begin == end && !fill()) {
+				return false;
+			}
+			size_t take = std::min(n - out.size(), end - begin);
+			out.append(buffer + begin, take);
+			begin += take;
+		}
+		return true;
+	}
+
+	private:
+	bool fill(void) {
+		begin = end = 0;
+		for (;;) {
+			ssize_t n = ::read(fd, buffer, sizeof(buffer));
+			if (n < 0 && errno == EINTR) {
+				continue ;
+			}
+			if (n <= 0) {
+				return false;
+			}
+			end = size_t(n);
+			return true;
+		}
+	}
+
+	int fd;
+	char buffer[64 * 1024];
+	size_t begin;
+	size_t end;
+};
+
+static bool write_all(int fd, std::string const& str) {
+	size_t done = 0;
+	while (done < str.size()) {
+		ssize_t n = ::write(fd, str.data() + done, str.size() - done);
+		if (n < 0 && errno == EINTR) {
+			continue ;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		done += size_t(n);
+	}
+	return true;
+}
+
+// One SOLVE request, the answer line (without '\n')
+static std::string solve(Daemon& daemon, int day, std::shared_ptr<std::string> input) {
+	using clock = std::chrono::steady_clock;
+	auto elapsed_ns = [](clock::time_point start, clock::time_point end) {
+		return std::chrono::duration<double, std::nano>(end - start).count();
+	};
+
+	auto start = clock::now();
+	Solution const* solution = find_solution(day);
+	if (solution == nullptr) {
+		throw std::runtime_error("no solution for day " + std::to_string(day));
+	}
+
+	uint64_t hash = content_hash(*input);
+	Memo::Entry entry = daemon.memo.find(day, *input, hash);
+	bool from_memo = (entry.parsed != nullptr);
+	if (!from_memo) {
+		entry.input = input;
+		entry.parsed = solution->parse(StringView(input->data(), input->size()));
+	}
+	auto parsed_at = clock::now();
+	std::string part1 = solution->part1(entry.parsed.get());
+	auto part1_at = clock::now();
+	std::string part2 = solution->part2 ? solution->part2(entry.parsed.get()) : "-";
+	auto part2_at = clock::now();
+
+	if (!from_memo) {
+		daemon.memo.insert(day, hash, entry);
+	}
+
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(0)
+		<< "OK " << day << ' ' << part1 << ' ' << part2
+		<< ' ' << elapsed_ns(start, parsed_at)
+		<< ' ' << elapsed_ns(parsed_at, part1_at)
+		<< ' ' << elapsed_ns(part1_at, part2_at)
+		<< ' ' << elapsed_ns(start, part2_at)
+		<< (from_memo ? " memo" : "");
+	daemon.stats.record(elapsed_ns(start, part2_at), false);
+	return ss.str();
+}
+
+// Requests of one client until it quits or goes away. false if it asked the
+// whole daemon to stop.
+static bool serve(Daemon& daemon, int in_fd, int out_fd) {
+	FdReader reader(in_fd);
+	std::string line;
+	while (!daemon.stopping && reader.read_line(line)) {
+		std::istringstream request(line);
+		std::string command;
+		request >> command;
+
+		std::string reply;
+		if (command == "SOLVE") {
+			int day = 0;
+			size_t size = 0;
+			if (!(request >> day >> size)) {
+				reply = "ERR usage: SOLVE DAY SIZE";
+			} else {
+				auto input = std::make_shared<std::string>();
+				if (!reader.read_exact(*input, size)) {
+					return true; // went away in the middle of the input
+				}
+				try {
+					reply = solve(daemon, day, input);
+				} catch (std::exception const& e) {
+					daemon.stats.record(0, true);
+					reply = std::string("ERR ") + e.what();
+					std::replace(reply.begin(), reply.end(), '\n', ' ');
+				}
+			}
+		} else if (command == "STATS") {
+			reply = "STATS " + daemon.stats.summary();
+		} else if (command == "QUIT") {
+			return true;
+		} else if (command == "SHUTDOWN") {
+			daemon.stopping = true;
+			write_all(out_fd, "BYE\n");
+			return false;
+		} else if (!command.empty()) {
+			reply = "ERR unknown command \"" + command + '"';
+		} else {
+			continue ;
+		}
+		if (!write_all(out_fd, reply + '\n')) {
+			return true;
+		}
+	}
+	return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   Socket                                   */
+/* -------------------------------------------------------------------------- */
+
+static int listen_on(std::string const& path) {
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path)) {
+		throw std::runtime_error("socket path too long: " + path);
+	}
+	std::strcpy(addr.sun_path, path.c_str());
+
+	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		throw std::runtime_error("can't create socket: " + std::string(std::strerror(errno)));
+	}
+	::unlink(path.c_str()); // left behind by a daemon that didn't stop cleanly
+	if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 64) != 0) {
+		std::string error = std::strerror(errno);
+		::close(fd);
+		throw std::runtime_error("can't listen on \"" + path + "\": " + error);
+	}
+	return fd;
+}
+
+// Connections currently served, to wake their threads up on SHUTDOWN
+struct Clients {
+	void add(int fd) {
+		std::lock_guard<std::mutex> lock(mutex);
+		fds.insert(fd);
+	}
+
+	void remove(int fd) {
+		std::lock_guard<std::mutex> lock(mutex);
+		fds.erase(fd);
+		::close(fd);
+		done.notify_all();
+	}
+
+	// the clients get to finish the request they're on, not to send another one
+	void stop(void) {
+		std::lock_guard<std::mutex> lock(mutex);
+		for (int fd : fds) {
+			::shutdown(fd, SHUT_RD);
+		}
+	}
+
+	void wait(void) {
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this]() { return fds.empty(); });
+	}
+
+	private:
+	std::mutex mutex;
+	std::condition_variable done;
+	std::set<int> fds;
+};
+
+// A thread per client, they spend most of their time waiting on it
+static void serve_socket(Daemon& daemon, std::string const& path) {
+	int listen_fd = listen_on(path);
+	std::cerr << "aocd: listening on " << path << '\n';
+
+	Clients clients;
+	while (!daemon.stopping) {
+		int fd = ::accept(listen_fd, nullptr, nullptr);
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue ;
+			}
+			break ;
+		}
+		clients.add(fd);
+		std::thread([&daemon, &clients, fd, listen_fd]() {
+			if (!serve(daemon, fd, fd)) {
+				// wakes up the accept() above and every other client
+				::shutdown(listen_fd, SHUT_RDWR);
+				clients.stop();
+			}
+			clients.remove(fd);
+		}).detach();
+	}
+	clients.stop();
+	clients.wait();
+	::close(listen_fd);
+	::unlink(path.c_str());
+}
+
+int main(int argc, char** argv) {
+	Arguments args;
+	try {
+		args = parse_arguments(argc, argv);
+	} catch (std::exception const& e) {
+		std::cerr << e.what();
+		return EXIT_FAILURE;
+	}
+
+	// a client going away mid answer is its problem, not a reason to exit
+	std::signal(SIGPIPE, SIG_IGN);
+
+	// warm up everything requests share before the first one comes in
+	ThreadPool::set_global_threads(args.threads);
+	solutions();
+
+	Daemon daemon(args);
+	try {
+		if (args.socket_path.empty()) {
+			serve(daemon, STDIN_FILENO, STDOUT_FILENO);
+		} else {
+			serve_socket(daemon, args.socket_path);
+		}
+	} catch (std::exception const& e) {
+		std::cerr << "aocd: " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+	std::cerr << "aocd: " << daemon.stats.summary() << '\n';
+	return EXIT_SUCCESS;
+}